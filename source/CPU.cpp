@@ -98,6 +98,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "SynchronousEventManager.h"
 #include "NTSC.h"
 #include "Log.h"
+#include "Debugger/Debugger_Traps.h"
+#include "Debugger/Debugger_Trace.h"
+#include "Debugger/Debugger_History.h"
+#include "Debugger/Debugger_CallProfile.h"
+#include "Debugger/Debugger_Coverage.h"
+#include "Debugger/Debugger_IOStats.h"
+#include "Debugger/Debugger_CycleAudit.h"
 
 #include "z80emu.h"
 #include "Z80VICE/z80.h"
@@ -406,6 +413,20 @@ static __forceinline void CheckSynchronousInterruptSources(UINT cycles, ULONG uE
 	g_SynchronousEventMgr.Update(cycles, uExecutedCycles);
 }
 
+// Run the Z80 (SoftCard) in one burst, up to the next synchronous event (eg. 6522 timer) or the end of this time slice.
+// The burst ends early if the Z80 hands back to the 6502.
+// NB. Always executes at least one Z80 opcode
+static __forceinline UINT Z80ExecuteBurst(ULONG uTotalCycles, ULONG uExecutedCycles)
+{
+	ULONG uBurstEnd = uTotalCycles;
+
+	const SyncEvent* pSyncEvent = g_SynchronousEventMgr.GetHead();
+	if (pSyncEvent && uExecutedCycles + pSyncEvent->m_cyclesRemaining < uBurstEnd)
+		uBurstEnd = uExecutedCycles + pSyncEvent->m_cyclesRemaining;
+
+	return z80_mainloop(uBurstEnd, uExecutedCycles);
+}
+
 // NB. No need to save to save-state, as IRQ() follows CheckSynchronousInterruptSources(), and IRQ() always sets it to false.
 bool g_irqOnLastOpcodeCycle = false;
 
@@ -455,6 +476,9 @@ static __forceinline void IRQ(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn,
 #define READ _READ_WITH_IO_F8xx
 #define WRITE(value) _WRITE_WITH_IO_F8xx(value)
 #define HEATMAP_X(address)
+#define BREAKPOINT_TRAP_X(address)
+#define TRACE_X(address)
+#define CYCLE_AUDIT_X(cycles)
 
 #include "CPU/cpu6502.h"  // MOS 6502
 
@@ -471,6 +495,9 @@ static __forceinline void IRQ(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn,
 #undef READ
 #undef WRITE
 #undef HEATMAP_X
+#undef BREAKPOINT_TRAP_X
+#undef TRACE_X
+#undef CYCLE_AUDIT_X
 
 //-----------------
 
@@ -478,6 +505,16 @@ static __forceinline void IRQ(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn,
 #define WRITE(value) Heatmap_WriteByte_With_IO_F8xx(addr, value, uExecutedCycles);
 
 #define HEATMAP_X(address) Heatmap_X(address)
+#define BREAKPOINT_TRAP_X(address) if (uExecutedCycles && BreakpointTrap_X(address)) break;	// NB. Always execute the 1st opcode
+#define TRACE_X(address) if (g_DebugTrace.bEnabled || g_DebugHistory.bEnabled || g_DebugCallProfile.bEnabled || g_DebugCoverage.bEnabled || g_DebugCycleAudit.bEnabled) {	\
+			EF_TO_AF																\
+			if (g_DebugTrace.bEnabled)   Trace_X(address, uExecutedCycles);			\
+			if (g_DebugHistory.bEnabled) History_X(address);						\
+			if (g_DebugCallProfile.bEnabled) CallProfile_X(address, uExecutedCycles);	\
+			if (g_DebugCoverage.bEnabled) Coverage_X(address);						\
+			if (g_DebugCycleAudit.bEnabled) CycleAudit_X(address);					\
+		}
+#define CYCLE_AUDIT_X(cycles) if (g_DebugCycleAudit.bPending) CycleAudit_Charged(cycles);
 
 #include "CPU/cpu_heatmap.inl"
 
@@ -500,6 +537,9 @@ static __forceinline void IRQ(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn,
 #undef READ
 #undef WRITE
 #undef HEATMAP_X
+#undef BREAKPOINT_TRAP_X
+#undef TRACE_X
+#undef CYCLE_AUDIT_X
 
 //===========================================================================
 
@@ -608,6 +648,200 @@ ULONG CpuGetCyclesThisVideoFrame(const ULONG nExecutedCycles)
 
 //===========================================================================
 
+// Reverse look-up the cycles of the opcode that is accessing I/O register 'reg' (ie. $C0nX, where X=reg)
+// . an I/O handler runs mid-opcode, but the opcode's cycles are only added (and synchronous events updated) once it completes
+// . so a card inserting a synchronous event from an I/O handler adds these cycles, to count from the start of the opcode
+// . returns 0 if the opcode isn't recognised
+
+// TODO: RMW opcodes: dec,inc,asl,lsr,rol,ror (abs16 & abs16,x) + 65C02 trb,tsb (abs16)
+UINT GetOpcodeCyclesForRead(BYTE reg)
+{
+	UINT opcodeCycles = 0;
+	BYTE opcode = 0;
+	bool abs16 = false;
+	bool abs16x = false;
+	bool abs16y = false;
+	bool indx = false;
+	bool indy = false;
+
+	const BYTE opcodeMinus3 = mem[(regs.pc-3)&0xffff];
+	const BYTE opcodeMinus2 = mem[(regs.pc-2)&0xffff];
+
+	if ( ((opcodeMinus2 & 0x0f) == 0x01) && ((opcodeMinus2 & 0x10) == 0x00) )	// ora (zp,x), and (zp,x), ..., sbc (zp,x)
+	{
+		// NB. this is for read, so don't need to exclude 0x81 / sta (zp,x)
+		opcodeCycles = 6;
+		opcode = opcodeMinus2;
+		indx = true;
+	}
+	else if ( ((opcodeMinus2 & 0x0f) == 0x01) && ((opcodeMinus2 & 0x10) == 0x10) )	// ora (zp),y, and (zp),y, ..., sbc (zp),y
+	{
+		// NB. this is for read, so don't need to exclude 0x91 / sta (zp),y
+		opcodeCycles = 5;
+		opcode = opcodeMinus2;
+		indy = true;
+	}
+	else if ( ((opcodeMinus2 & 0x0f) == 0x02) && ((opcodeMinus2 & 0x10) == 0x10) && GetMainCpu() == CPU_65C02 )	// ora (zp), and (zp), ..., sbc (zp) : 65C02-only
+	{
+		// NB. this is for read, so don't need to exclude 0x92 / sta (zp)
+		opcodeCycles = 5;
+		opcode = opcodeMinus2;
+	}
+	else
+	{
+		if ( (((opcodeMinus3 & 0x0f) == 0x0D) && ((opcodeMinus3 & 0x10) == 0x00)) ||	// ora abs16, and abs16, ..., sbc abs16
+				(opcodeMinus3 == 0x2C) ||			// bit abs16
+				(opcodeMinus3 == 0xAC) ||			// ldy abs16
+				(opcodeMinus3 == 0xAE) ||			// ldx abs16
+				(opcodeMinus3 == 0xCC) ||			// cpy abs16
+				(opcodeMinus3 == 0xEC) )			// cpx abs16
+		{
+		}
+		else if ( (opcodeMinus3 == 0xBC) ||			// ldy abs16,x
+					((opcodeMinus3 == 0x3C) && GetMainCpu() == CPU_65C02) )		// bit abs16,x : 65C02-only
+		{
+			abs16x = true;
+		}
+		else if ( (opcodeMinus3 == 0xBE) )			// ldx abs16,y
+		{
+			abs16y = true;
+		}
+		else if ((opcodeMinus3 & 0x10) == 0x10)
+		{
+			if ((opcodeMinus3 & 0x0f) == 0x0D)		// ora abs16,x, and abs16,x, ..., sbc abs16,x
+				abs16x = true;
+			else if ((opcodeMinus3 & 0x0f) == 0x09) // ora abs16,y, and abs16,y, ..., sbc abs16,y
+				abs16y = true;
+		}
+		else
+		{
+			_ASSERT(0);
+			opcodeCycles = 0;
+			return 0;
+		}
+
+		opcodeCycles = 4;
+		opcode = opcodeMinus3;
+		abs16 = true;
+	}
+
+	//
+
+	WORD addr16 = 0;
+
+	if (!abs16)
+	{
+		BYTE zp = mem[(regs.pc-1)&0xffff];
+		if (indx) zp += regs.x;
+		addr16 = (mem[zp] | (mem[(zp+1)&0xff]<<8));
+		if (indy) addr16 += regs.y;
+	}
+	else
+	{
+		addr16 = mem[(regs.pc-2)&0xffff] | (mem[(regs.pc-1)&0xffff]<<8);
+		if (abs16y) addr16 += regs.y;
+		if (abs16x) addr16 += regs.x;
+	}
+
+	// Check we've reverse looked-up the 6502 opcode correctly
+	if ((addr16 & 0xF80F) != (0xC000+reg))
+	{
+		_ASSERT(0);
+		return 0;
+	}
+
+	return opcodeCycles;
+}
+
+// TODO: RMW opcodes: dec,inc,asl,lsr,rol,ror (abs16 & abs16,x) + 65C02 trb,tsb (abs16)
+UINT GetOpcodeCyclesForWrite(BYTE reg)
+{
+	UINT opcodeCycles = 0;
+	BYTE opcode = 0;
+	bool abs16 = false;
+
+	const BYTE opcodeMinus3 = mem[(regs.pc-3)&0xffff];
+	const BYTE opcodeMinus2 = mem[(regs.pc-2)&0xffff];
+
+	if ( (opcodeMinus3 == 0x8C) ||		// sty abs16
+		 (opcodeMinus3 == 0x8D) ||		// sta abs16
+		 (opcodeMinus3 == 0x8E) )		// stx abs16
+	{	// Eg. FT demos: CHIP, MADEF, MAD2
+		opcodeCycles = 4;
+		opcode = opcodeMinus3;
+		abs16 = true;
+	}
+	else if ( (opcodeMinus3 == 0x99) ||	// sta abs16,y
+			  (opcodeMinus3 == 0x9D) )	// sta abs16,x
+	{	// Eg. Paleotronic microTracker demo
+		opcodeCycles = 5;
+		opcode = opcodeMinus3;
+		abs16 = true;
+	}
+	else if (opcodeMinus2 == 0x81)		// sta (zp,x)
+	{
+		opcodeCycles = 6;
+		opcode = opcodeMinus2;
+	}
+	else if (opcodeMinus2 == 0x91)		// sta (zp),y
+	{	// Eg. FT demos: OMT, PLS
+		opcodeCycles = 6;
+		opcode = opcodeMinus2;
+	}
+	else if (opcodeMinus2 == 0x92 && GetMainCpu() == CPU_65C02)		// sta (zp) : 65C02-only
+	{
+		opcodeCycles = 5;
+		opcode = opcodeMinus2;
+	}
+	else if (opcodeMinus3 == 0x9C && GetMainCpu() == CPU_65C02)		// stz abs16 : 65C02-only
+	{
+		opcodeCycles = 4;
+		opcode = opcodeMinus3;
+		abs16 = true;
+	}
+	else if (opcodeMinus3 == 0x9E && GetMainCpu() == CPU_65C02)		// stz abs16,x : 65C02-only
+	{
+		opcodeCycles = 5;
+		opcode = opcodeMinus3;
+		abs16 = true;
+	}
+	else
+	{
+		_ASSERT(0);
+		opcodeCycles = 0;
+		return 0;
+	}
+
+	//
+
+	WORD addr16 = 0;
+
+	if (!abs16)
+	{
+		BYTE zp = mem[(regs.pc-1)&0xffff];
+		if (opcode == 0x81) zp += regs.x;
+		addr16 = (mem[zp] | (mem[(zp+1)&0xff]<<8));
+		if (opcode == 0x91) addr16 += regs.y;
+	}
+	else
+	{
+		addr16 = mem[(regs.pc-2)&0xffff] | (mem[(regs.pc-1)&0xffff]<<8);
+		if (opcode == 0x99) addr16 += regs.y;
+		if (opcode == 0x9D || opcode == 0x9E) addr16 += regs.x;
+	}
+
+	// Check we've reverse looked-up the 6502 opcode correctly
+	if ((addr16 & 0xF80F) != (0xC000+reg))
+	{
+		_ASSERT(0);
+		return 0;
+	}
+
+	return opcodeCycles;
+}
+
+//===========================================================================
+
 DWORD CpuExecute(const DWORD uCycles, const bool bVideoUpdate)
 {
 #ifdef LOG_PERF_TIMINGS
@@ -649,6 +883,7 @@ void CpuInitialize ()
 	g_bCritSectionValid = true;
 	CpuIrqReset();
 	CpuNmiReset();
+	CpuInitDecimalTables();
 
 	z80mem_initialize();
 	z80_reset();
@@ -20,6 +20,8 @@ void    CpuDestroy ();
 void    CpuCalcCycles(ULONG nExecutedCycles);
 DWORD   CpuExecute(const DWORD uCycles, const bool bVideoUpdate);
 ULONG   CpuGetCyclesThisVideoFrame(ULONG nExecutedCycles);
+UINT    GetOpcodeCyclesForRead(BYTE reg);
+UINT    GetOpcodeCyclesForWrite(BYTE reg);
 void    CpuInitialize ();
 void    CpuSetupBenchmark ();
 void	CpuIrqReset();
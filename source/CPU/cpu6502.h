@@ -48,10 +48,12 @@ static DWORD Cpu6502(DWORD uTotalCycles, const bool bVideoUpdate)
 
 		if (GetActiveCpu() == CPU_Z80)
 		{
-			const UINT uZ80Cycles = z80_mainloop(uTotalCycles, uExecutedCycles); CYC(uZ80Cycles)
+			const UINT uZ80Cycles = Z80ExecuteBurst(uTotalCycles, uExecutedCycles); CYC(uZ80Cycles)
 		}
 		else
 		{
+			BREAKPOINT_TRAP_X( regs.pc );
+			TRACE_X( regs.pc );
 			HEATMAP_X( regs.pc );
 			Fetch(iOpcode, uExecutedCycles);
 
@@ -315,6 +317,8 @@ static DWORD Cpu6502(DWORD uTotalCycles, const bool bVideoUpdate)
 			case 0xFE: ABSX_CONST INC  CYC(7)  break;
 			case 0xFF: ABSX_CONST INS  CYC(7)  break;	// invalid
 			}
+
+			CYCLE_AUDIT_X( uExecutedCycles - uPreviousCycles );
 		}
 
 		CheckSynchronousInterruptSources(uExecutedCycles - uPreviousCycles, uExecutedCycles);
@@ -35,38 +35,235 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 inline void Heatmap_R(uint16_t address)
 {
 	// todo
+
+	if (g_BreakpointTraps.aMem[address >> 8] & BP_TRAP_MEM_READ)
+		BreakpointTrapMem(address, BP_TRAP_MEM_READ);
 }
 
 inline void Heatmap_W(uint16_t address)
 {
 	// todo
+
+	if (g_BreakpointTraps.aMem[address >> 8] & BP_TRAP_MEM_WRITE)
+		BreakpointTrapMem(address, BP_TRAP_MEM_WRITE);
 }
 
 inline void Heatmap_X(uint16_t address)
 {
 	// todo
+
+	if (g_DebugIoStats.bEnabled)
+		g_DebugIoStats.nOpcodePC = address;
+}
+
+// Returns true if the debugger needs to check the opcode at address before it's executed
+// See: DebugContinueStepping(), CheckBreakOpcode()
+inline bool BreakpointTrap_X(uint16_t address)
+{
+	if (!g_BreakpointTraps.bArmed)
+		return false;
+
+	if (g_BreakpointTraps.bHit)	// Memory breakpoint hit by the last opcode
+		return true;
+
+	if (g_BreakpointTraps.aPC[address >> 3] & (1 << (address & 7)))
+		return true;
+
+	if ((address & 0xF000) == 0xC000 && !MemIsAddrCodeMemory(address))	// Floating bus or I/O
+		return true;
+
+	if (g_BreakpointTraps.bOpcode && g_BreakpointTraps.aOpcode[ *(mem+address) ])
+		return true;
+
+	return false;
+}
+
+// Record the registers and opcode at address, before it's executed. Pre: regs.ps is up-to-date
+// See: CmdTraceBuffer(), CmdTraceFileBinary()
+inline void Trace_X(uint16_t address, ULONG uExecutedCycles)
+{
+	const unsigned __int64 nCycles = g_nCumulativeCycles + (uExecutedCycles - g_nCyclesExecuted);
+	const unsigned __int64 nDelta = nCycles - g_DebugTrace.nCycleLast;
+	g_DebugTrace.nCycleLast = nCycles;
+
+	TraceRecord_t& record = g_DebugTrace.pRecords[g_DebugTrace.nHead];
+	record.nCycles    = (nDelta > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)nDelta;
+	record.nPC        = address;
+	record.aOpcode[0] = *(mem + address);
+	record.aOpcode[1] = *(mem + ((address + 1) & 0xFFFF));
+	record.aOpcode[2] = *(mem + ((address + 2) & 0xFFFF));
+	record.nA         = regs.a;
+	record.nX         = regs.x;
+	record.nY         = regs.y;
+	record.nP         = regs.ps;
+	record.nSP        = (BYTE)regs.sp;
+	record.nVideo     = g_DebugTrace.bVideo ? ((g_nVideoClockVert << 7) | g_nVideoClockHorz) : 0;
+
+	if (++g_DebugTrace.nHead == TRACE_RING_SIZE)
+		DebugTraceWrap();
+}
+
+// Record the registers before the opcode at address is executed. Pre: regs.ps is up-to-date
+// See: HistoryUndoStep()
+inline void History_X(uint16_t address)
+{
+	HistoryStep_t& step = g_DebugHistory.pSteps[g_DebugHistory.nSteps++ & (HISTORY_NUM_STEPS - 1)];
+	if (g_DebugHistory.nValid < HISTORY_NUM_STEPS)
+		g_DebugHistory.nValid++;
+
+	step.nPC      = address;
+	step.nSP      = regs.sp;
+	step.nA       = regs.a;
+	step.nX       = regs.x;
+	step.nY       = regs.y;
+	step.nP       = regs.ps;
+	step.nMemMode = GetMemMode();
+	step.iAccess  = g_DebugHistory.nAccesses;
+
+	for (int iByte = 0; iByte < HISTORY_STACK_BYTES; iByte++)
+		step.aStack[iByte] = *(mem + (0x100 | ((regs.sp - iByte) & 0xFF)));
+}
+
+// Pre: regs.sp is up-to-date
+// See: CallProfileStep()
+inline void CallProfile_X(uint16_t address, ULONG uExecutedCycles)
+{
+	const unsigned __int64 nCycles = g_nCumulativeCycles + (uExecutedCycles - g_nCyclesExecuted);
+	CallProfileStep(address, (BYTE)regs.sp, nCycles);
+}
+
+// Pre: regs.ps is up-to-date
+// See: CmdCoverage()
+inline void Coverage_X(uint16_t address)
+{
+	const DWORD nMemMode = GetMemMode();
+	if (nMemMode != g_DebugCoverage.nMemMode)
+		CoverageUpdatePaging(nMemMode);
+
+	const BYTE iPage = address >> 8;
+	const UINT nPhys = (g_DebugCoverage.aPagePhys[iPage] << 8) | (address & 0xFF);
+	const BYTE nBit  = 1 << (nPhys & 7);
+	CoverageBank_t& bank = g_DebugCoverage.pBanks[g_DebugCoverage.aPageBank[iPage]];
+
+	bank.aExecuted[nPhys >> 3] |= nBit;
+
+	const CoverageBranch_t& branch = g_DebugCoverage.aBranches[*(mem + address)];
+	if (branch.bBranch)
+	{
+		if ((regs.ps & branch.nMask) == branch.nValue)
+			bank.aTaken[nPhys >> 3] |= nBit;
+		else
+			bank.aNotTaken[nPhys >> 3] |= nBit;
+	}
+}
+
+// Pre: regs.ps is up-to-date
+// See: CmdCycleAudit()
+inline void CycleAudit_X(uint16_t address)
+{
+	CycleAuditStep(address);
+}
+
+// Cycles charged by the opcode that CycleAudit_X() was called for. (Excludes any IRQ/NMI taken after it)
+inline void CycleAudit_Charged(UINT cycles)
+{
+	g_DebugCycleAudit.bPending = false;
+
+	CycleAuditEntry_t& entry = g_DebugCycleAudit.pEntries[g_DebugCycleAudit.iEntry];
+	entry.nCount++;
+	if (cycles != g_DebugCycleAudit.nExpected)
+	{
+		entry.nMismatches++;
+		entry.nLastCharged = (BYTE)cycles;
+		entry.nLastPC      = g_DebugCycleAudit.nPC;
+	}
+}
+
+inline void History_Access(LPBYTE pMem, uint16_t address, BYTE value, BYTE eAccess)
+{
+	HistoryAccess_t& access = g_DebugHistory.pAccesses[g_DebugHistory.nAccesses++ & (HISTORY_NUM_ACCESSES - 1)];
+	access.pMem     = pMem;
+	access.nAddress = address;
+	access.nValue   = value;
+	access.eAccess  = eAccess;
+}
+
+inline void History_R(uint16_t address, BYTE value)
+{
+	if ((address & 0xFF00) == 0xC000)
+		History_Access(NULL, address, value, HISTORY_IO_READ);
+}
+
+// Pre: before the write, so the old value can be saved
+inline void History_W(uint16_t address, BYTE value, bool bIO)
+{
+	LPBYTE page = bIO ? NULL : memwrite[address >> 8];
+	if (page)
+		History_Access(page + (address & 0xFF), address, *(page + (address & 0xFF)), HISTORY_MEM_WRITE);
+	else if (bIO || (address & 0xF000) == 0xC000)
+		History_Access(NULL, address, value, HISTORY_IO_WRITE);
+}
+
+// Pre: address is $C000..$CFFF and went to the IORead/IOWrite handler
+// See: CmdIoStats()
+inline void IoStats_Access(uint16_t address, BYTE value, bool bWrite, ULONG uExecutedCycles)
+{
+	IoStatsCount_t& count = g_DebugIoStats.pCounts[address & (IOSTATS_NUM_ADDRESSES - 1)];
+	if (bWrite)
+		count.nWrites++;
+	else
+		count.nReads++;
+
+	if (--g_DebugIoStats.nSampleCountdown)
+		return;
+	g_DebugIoStats.nSampleCountdown = g_DebugIoStats.nSampleRate;
+
+	IoStatsSample_t& sample = g_DebugIoStats.pSamples[g_DebugIoStats.nSamples++ & (IOSTATS_RING_SIZE - 1)];
+	sample.nCycles  = g_nCumulativeCycles + (uExecutedCycles - g_nCyclesExecuted);
+	sample.nPC      = g_DebugIoStats.nOpcodePC;
+	sample.nAddress = address;
+	sample.nValue   = value;
+	sample.bWrite   = bWrite;
 }
 
 inline uint8_t Heatmap_ReadByte(uint16_t addr, int uExecutedCycles)
 {
 	Heatmap_R(addr);
-	return _READ;
+	const uint8_t value = _READ;
+	if (g_DebugHistory.bEnabled)
+		History_R(addr, value);
+	if (g_DebugIoStats.bEnabled && (addr & 0xF000) == 0xC000)
+		IoStats_Access(addr, value, false, uExecutedCycles);
+	return value;
 }
 
 inline uint8_t Heatmap_ReadByte_With_IO_F8xx(uint16_t addr, int uExecutedCycles)
 {
 	Heatmap_R(addr);
-	return _READ_WITH_IO_F8xx;
+	const uint8_t value = _READ_WITH_IO_F8xx;
+	if (g_DebugHistory.bEnabled)
+		History_R(addr, value);
+	if (g_DebugIoStats.bEnabled && (addr & 0xF000) == 0xC000)
+		IoStats_Access(addr, value, false, uExecutedCycles);
+	return value;
 }
 
 inline void Heatmap_WriteByte(uint16_t addr, uint16_t value, int uExecutedCycles)
 {
 	Heatmap_W(addr);
+	if (g_DebugHistory.bEnabled)
+		History_W(addr, (BYTE)value, false);
+	if (g_DebugIoStats.bEnabled && (addr & 0xF000) == 0xC000 && !memwrite[addr >> 8])
+		IoStats_Access(addr, (BYTE)value, true, uExecutedCycles);
 	_WRITE(value);
 }
 
 inline void Heatmap_WriteByte_With_IO_F8xx(uint16_t addr, uint16_t value, int uExecutedCycles)
 {
 	Heatmap_W(addr);
+	if (g_DebugHistory.bEnabled)
+		History_W(addr, (BYTE)value, addr >= 0xF800);
+	if (g_DebugIoStats.bEnabled && (addr & 0xF000) == 0xC000 && !memwrite[addr >> 8])
+		IoStats_Access(addr, (BYTE)value, true, uExecutedCycles);
 	_WRITE_WITH_IO_F8xx(value);
 }
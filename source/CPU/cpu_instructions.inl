@@ -135,6 +135,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 // ==========
 
+#undef DECIMAL_OP
+
+// ==========
+
 #undef ADCn
 #undef ASLn
 #undef LSRn
@@ -167,23 +171,146 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 // ==========
 
+// Decimal mode ADC/SBC tables
+// . index = (C << 16) | (A << 8) | operand
+// . entry = result in b7..0, N V Z C (as AF_ bits) in b15..8
+// Built once from the original BCD code (see CpuInitDecimalTables()), so the opcode only needs a lookup
+
+#define DECIMAL_TABLE_SIZE 0x20000
+
+static WORD g_aDecimalAdcNMOS[DECIMAL_TABLE_SIZE];
+static WORD g_aDecimalSbcNMOS[DECIMAL_TABLE_SIZE];
+static WORD g_aDecimalAdcCMOS[DECIMAL_TABLE_SIZE];
+static WORD g_aDecimalSbcCMOS[DECIMAL_TABLE_SIZE];
+
+static WORD DecimalEntry(const WORD val, const BOOL flagc, const BOOL flagn, const BOOL flagv, const BOOL flagz)
+{
+	return (val & 0xFF)
+		| ((flagc ? AF_CARRY    : 0) << 8)
+		| ((flagz ? AF_ZERO     : 0) << 8)
+		| ((flagv ? AF_OVERFLOW : 0) << 8)
+		| ((flagn ? AF_SIGN     : 0) << 8);
+}
+
+static WORD DecimalAdcNMOS(const BYTE a, const WORD temp, BOOL flagc)
+{
+	WORD val = (a & 0x0F) + (temp & 0x0F) + flagc;
+	if (val > 0x09)
+		val += 0x06;
+	if (val <= 0x0F)
+		val = (val & 0x0F) + (a & 0xF0) + (temp & 0xF0);
+	else
+		val = (val & 0x0F) + (a & 0xF0) + (temp & 0xF0) + 0x10;
+	const BOOL flagz = !((a + temp + flagc) & 0xFF);
+	const BOOL flagn = (val & 0x80);
+	const BOOL flagv = ((a ^ val) & 0x80) && !((a ^ temp) & 0x80);
+	if ((val & 0x1F0) > 0x90)
+		val += 0x60;
+	flagc = ((val & 0xFF0) > 0xF0);
+	return DecimalEntry(val, flagc, flagn, flagv, flagz);
+}
+
+static WORD DecimalSbcNMOS(const BYTE a, const WORD temp, BOOL flagc)
+{
+	const WORD temp2 = a - temp - !flagc;
+	WORD val = (a & 0x0F) - (temp & 0x0F) - !flagc;
+	if (val & 0x10)
+		val = ((val - 0x06) & 0x0F) | ((a & 0xF0) - (temp & 0xF0) - 0x10);
+	else
+		val = (val & 0x0F) | ((a & 0xF0) - (temp & 0xF0));
+	if (val & 0x100)
+		val -= 0x60;
+	flagc = (temp2 < 0x100);
+	const BOOL flagn = (temp2 & 0x80);
+	const BOOL flagz = !(temp2 & 0xFF);
+	const BOOL flagv = ((a ^ temp2) & 0x80) && ((a ^ temp) & 0x80);
+	return DecimalEntry(val, flagc, flagn, flagv, flagz);
+}
+
+static WORD DecimalAdcCMOS(const BYTE a, const WORD temp, BOOL flagc)
+{
+	BOOL flagv = !((a ^ temp) & 0x80);
+	WORD val = (a & 0x0f) + (temp & 0x0f) + flagc;
+	if (val >= 0x0A)
+		val = 0x10 | ((val + 6) & 0x0f);
+	val += (a & 0xf0) + (temp & 0xf0);
+	if (val >= 0xA0) {
+		flagc = 1;
+		if (val >= 0x180)
+			flagv = 0;
+		val += 0x60;
+	}
+	else {
+		flagc = 0;
+		if (val < 0x80)
+			flagv = 0;
+	}
+	return DecimalEntry(val, flagc, val & 0x80, flagv, !(val & 0xFF));
+}
+
+static WORD DecimalSbcCMOS(const BYTE a, const WORD temp, BOOL flagc)
+{
+	BOOL flagv = ((a ^ temp) & 0x80);
+	WORD temp2 = 0x0F + (a & 0x0F) - (temp & 0x0F) + flagc;
+	WORD val;
+	if (temp2 < 0x10) {
+		val = 0;
+		temp2 -= 0x06;
+	}
+	else {
+		val = 0x10;
+		temp2 -= 0x10;
+	}
+	val += 0xF0 + (a & 0xF0) - (temp & 0xF0);
+	if (val < 0x100) {
+		flagc = 0;
+		if (val < 0x80)
+			flagv = 0;
+		val -= 0x60;
+	}
+	else {
+		flagc = 1;
+		if (val >= 0x180)
+			flagv = 0;
+	}
+	val += temp2;
+	return DecimalEntry(val, flagc, val & 0x80, flagv, !(val & 0xFF));
+}
+
+static void CpuInitDecimalTables(void)
+{
+	static bool bInitialized = false;
+	if (bInitialized)
+		return;
+
+	for (UINT i = 0; i < DECIMAL_TABLE_SIZE; i++)
+	{
+		const BOOL flagc = (i >> 16) & 1;
+		const BYTE a = (i >> 8) & 0xFF;
+		const WORD temp = i & 0xFF;
+		g_aDecimalAdcNMOS[i] = DecimalAdcNMOS(a, temp, flagc);
+		g_aDecimalSbcNMOS[i] = DecimalSbcNMOS(a, temp, flagc);
+		g_aDecimalAdcCMOS[i] = DecimalAdcCMOS(a, temp, flagc);
+		g_aDecimalSbcCMOS[i] = DecimalSbcCMOS(a, temp, flagc);
+	}
+
+	bInitialized = true;
+}
+
+// Sets A and N V Z C from a decimal table (temp = operand)
+#define DECIMAL_OP(table) val	  = table[(flagc ? 0x10000 : 0) | (regs.a << 8) | temp];\
+		   regs.a = val & 0xFF;					    \
+		   flagc  = (val >> 8) & AF_CARRY;			    \
+		   flagz  = (val >> 8) & AF_ZERO;			    \
+		   flagv  = (val >> 8) & AF_OVERFLOW;			    \
+		   flagn  = (val >> 8) & AF_SIGN;
+
+// ==========
+
 #define ADC_NMOS /*bSlowerOnPagecross = 1;*/						    \
 		 temp = READ;						    \
 		 if (regs.ps & AF_DECIMAL) {				    \
-		   val	  = (regs.a & 0x0F) + (temp & 0x0F) + flagc;	    \
-		   if (val > 0x09)					    \
-		     val += 0x06;					    \
-		   if (val <= 0x0F)					    \
-		     val = (val & 0x0F) + (regs.a & 0xF0) + (temp & 0xF0);  \
-		   else							    \
-		     val = (val & 0x0F) + (regs.a & 0xF0) + (temp & 0xF0) + 0x10;\
-		   flagz = !((regs.a + temp + flagc) & 0xFF);		    \
-		   flagn = (val & 0x80);				    \
-		   flagv = ((regs.a ^ val) & 0x80) && !((regs.a ^ temp) & 0x80);\
-		   if ((val & 0x1F0) > 0x90)				    \
-		     val += 0x60;					    \
-		   flagc = ((val & 0xFF0) > 0xF0);			    \
-		   regs.a = val & 0xFF;                                     \
+		   DECIMAL_OP(g_aDecimalAdcNMOS)			    \
 		  }							    \
 		 else {							    \
 		   val	  = regs.a + temp + flagc;			    \
@@ -195,26 +322,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		 }
 #define ADC_CMOS /*bSlowerOnPagecross = 1*/;						    \
                  temp = READ;						    \
-                 flagv = !((regs.a ^ temp) & 0x80);			    \
 		 if (regs.ps & AF_DECIMAL) {				    \
 		    uExtraCycles++;					    \
-		    val = (regs.a & 0x0f) + (temp & 0x0f) + flagc;          \
-		    if (val >= 0x0A)					    \
-		       val = 0x10 | ((val + 6) & 0x0f);			    \
-		    val += (regs.a & 0xf0) + (temp & 0xf0);		    \
-		    if (val >= 0xA0) {					    \
-		       flagc = 1;					    \
-		       if (val >= 0x180)				    \
-			  flagv = 0;					    \
-		       val += 0x60;					    \
-		    }							    \
-		    else {						    \
-		       flagc = 0;					    \
-		       if (val < 0x80)					    \
-		          flagv = 0;					    \
-		    }							    \
+		    DECIMAL_OP(g_aDecimalAdcCMOS)			    \
 		 }							    \
 		 else {							    \
+		    flagv = !((regs.a ^ temp) & 0x80);			    \
 		    val = regs.a + temp + flagc;                            \
 		    if (val >= 0x100) {					    \
 		       flagc = 1;					    \
@@ -224,9 +337,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		       flagc = 0;					    \
 		       if (val < 0x80) flagv = 0;			    \
 		    }							    \
-		 }							    \
-		 regs.a = val & 0xFF;					    \
-		 SETNZ(regs.a)
+		    regs.a = val & 0xFF;				    \
+		    SETNZ(regs.a)					    \
+		 }
 #define ALR	 regs.a &= READ;					    \
 		 flagc = (regs.a & 1);					    \
 		 flagn = 0;						    \
@@ -246,9 +359,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		   flagn = (flagc ? 0x80 : 0);					    \
 		   SETZ(val)						    \
 		   flagv = ((val ^ temp) & 0x40);			    \
-		   if (((val & 0x0F) + (val & 0x01)) > 0x05)                \
+		   if (((temp & 0x0F) + (temp & 0x01)) > 0x05)              \
 		     val = (val & 0xF0) | ((val + 0x06) & 0x0F);	    \
-		   if (((val & 0xF0) + (val & 0x10)) > 0x50) {		    \
+		   if (((temp & 0xF0) + (temp & 0x10)) > 0x50) {	    \
 		     val = (val & 0x0F) | ((val + 0x60) & 0xF0);	    \
 		     flagc = 1;						    \
 		   }							    \
@@ -330,7 +443,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		 val   = regs.y-val;					    \
 		 SETNZ(val)
 #define DCM	 /*bSlowerOnPagecross = 0;*/						    \
-		 val = READ-1;						    \
+		 val = (READ-1) & 0xFF;					    \
 		 WRITE(val)						    \
 		 flagc = (regs.a >= val);				    \
 		 val   = regs.a-val;					    \
@@ -359,20 +472,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #define INS	 /*bSlowerOnPagecross = 0;*/						    \
 		 val = READ+1;						    \
 		 WRITE(val)						    \
-		 temp = val;                                                \
+		 temp = val & 0xFF;                                         \
 		 temp2 = regs.a - temp - !flagc;			    \
 		 if (regs.ps & AF_DECIMAL) {				    \
-		   val  = (regs.a & 0x0F) - (temp & 0x0F) - !flagc;	    \
-		   if (val & 0x10)					    \
-		     val = ((val - 0x06) & 0x0F) | ((regs.a & 0xF0) - (temp & 0xF0) - 0x10);\
-		   else							    \
-		     val = (val & 0x0F) | ((regs.a & 0xF0) - (temp & 0xF0));\
-		   if (val & 0x100)					    \
-		     val -= 0x60;					    \
-		   flagc  = (temp2 < 0x100);				    \
-		   SETNZ(temp2 & 0xFF);					    \
-		   flagv = ((regs.a ^ temp2) & 0x80) && ((regs.a ^ temp) & 0x80);\
-		   regs.a = val & 0xFF;					    \
+		   DECIMAL_OP(g_aDecimalSbcNMOS)			    \
 		 }							    \
 		 else {							    \
 		   val	  = temp2;					    \
@@ -499,20 +602,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		 WRITE(val)						    \
 		 temp = val;						    \
 		 if (regs.ps & AF_DECIMAL) {				    \
-		   val	  = (regs.a & 0x0F) + (temp & 0x0F) + flagc;	    \
-		   if (val > 0x09)					    \
-		     val += 0x06;					    \
-		   if (val <= 0x0F)					    \
-		     val = (val & 0x0F) + (regs.a & 0xF0) + (temp & 0xF0);  \
-		   else							    \
-		     val = (val & 0x0F) + (regs.a & 0xF0) + (temp & 0xF0) + 0x10;\
-		   flagz = !((regs.a + temp + flagc) & 0xFF);		    \
-		   flagn = (val & 0x80);				    \
-		   flagv = ((regs.a ^ val) & 0x80) && !((regs.a ^ temp) & 0x80);\
-		   if ((val & 0x1F0) > 0x90)				    \
-		     val += 0x60;					    \
-		   flagc = ((val & 0xFF0) > 0xF0);			    \
-		   regs.a = val & 0xFF;                                     \
+		   DECIMAL_OP(g_aDecimalAdcNMOS)			    \
 		 }							    \
 		 else {							    \
 		   val	  = regs.a + temp + flagc;			    \
@@ -542,17 +632,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		 temp = READ;						    \
 		 temp2 = regs.a - temp - !flagc;			    \
 		 if (regs.ps & AF_DECIMAL) {				    \
-		   val  = (regs.a & 0x0F) - (temp & 0x0F) - !flagc;	    \
-		   if (val & 0x10)					    \
-		     val = ((val - 0x06) & 0x0F) | ((regs.a & 0xF0) - (temp & 0xF0) - 0x10);\
-		   else							    \
-		     val = (val & 0x0F) | ((regs.a & 0xF0) - (temp & 0xF0));\
-		   if (val & 0x100)					    \
-		     val -= 0x60;					    \
-		   flagc  = (temp2 < 0x100);				    \
-		   SETNZ(temp2 & 0xFF);					    \
-		   flagv = ((regs.a ^ temp2) & 0x80) && ((regs.a ^ temp) & 0x80);\
-		   regs.a = val & 0xFF;					    \
+		   DECIMAL_OP(g_aDecimalSbcNMOS)			    \
 		 }							    \
 		 else {							    \
 		   val	  = temp2;					    \
@@ -564,33 +644,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		 }
 #define SBC_CMOS /*bSlowerOnPagecross = 1;*/						    \
 	         temp = READ;						    \
-		 flagv = ((regs.a ^ temp) & 0x80);			    \
 		 if (regs.ps & AF_DECIMAL) {				    \
 		    uExtraCycles++;					    \
-                    temp2 = 0x0F + (regs.a & 0x0F) - (temp & 0x0F) + flagc; \
-		    if (temp2 < 0x10) {					    \
-		       val = 0;						    \
-		       temp2 -= 0x06;					    \
-		    }							    \
-		    else {						    \
-		       val = 0x10;					    \
-		       temp2 -= 0x10;					    \
-		    }							    \
-		    val += 0xF0 + (regs.a & 0xF0) - (temp & 0xF0);	    \
-		    if (val < 0x100) {					    \
-		       flagc = 0;					    \
-		       if (val < 0x80)					    \
-			  flagv = 0;					    \
-		       val -= 0x60;					    \
-		    }							    \
-		    else {						    \
-		       flagc = 1;					    \
-		       if (val >= 0x180)				    \
-			  flagv = 0;					    \
-		    }							    \
-		    val += temp2;					    \
+		    DECIMAL_OP(g_aDecimalSbcCMOS)			    \
 		 }							    \
 		 else {							    \
+		    flagv = ((regs.a ^ temp) & 0x80);			    \
 		    val = 0xff + regs.a - temp + flagc;                     \
 		    if (val < 0x100) {					    \
 		       flagc = 0;					    \
@@ -602,9 +661,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		       if (val >= 0x180)				    \
 		          flagv = 0;					    \
 		    }							    \
-		 }							    \
-		 regs.a = val & 0xFF;					    \
-                 SETNZ(regs.a)
+		    regs.a = val & 0xFF;				    \
+		    SETNZ(regs.a)					    \
+		 }
 #define SEC	 flagc = 1;
 #define SED	 regs.ps |= AF_DECIMAL;
 #define SEI	 regs.ps |= AF_INTERRUPT;
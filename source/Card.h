@@ -21,6 +21,7 @@ enum SS_CARDTYPE
 	CT_LanguageCard,	// Apple][ or ][+ in slot-0
 	CT_LanguageCardIIe,	// Apple//e LC instance (not a card)
 	CT_Saturn128K,		// Saturn 128K (but may be populated with less RAM, in multiples of 16K)
+	CT_Uthernet2,		// Uthernet II (WIZnet W5100)
 };
 
 enum SLOTS { SLOT0=0, SLOT1, SLOT2, SLOT3, SLOT4, SLOT5, SLOT6, SLOT7, NUM_SLOTS };
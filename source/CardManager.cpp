@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Disk.h"
 #include "MouseInterface.h"
 #include "SerialComms.h"
+#include "Uthernet2.h"
 
 void CardManager::Insert(UINT slot, SS_CARDTYPE type)
 {
@@ -85,6 +86,9 @@ void CardManager::Insert(UINT slot, SS_CARDTYPE type)
 	case CT_Uthernet:
 		m_slot[slot] = new DummyCard(type);
 		break;
+	case CT_Uthernet2:
+		m_slot[slot] = new Uthernet2(slot);
+		break;
 
 	case CT_LanguageCard:
 	case CT_Saturn128K:
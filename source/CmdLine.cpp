@@ -166,6 +166,8 @@ bool ProcessCmdLine(LPSTR lpCmdLine)
 					g_cmdLine.bSlotEmpty[slot] = true;
 				if (strcmp(lpCmdLine, "diskii") == 0)
 					g_cmdLine.slotInsert[slot] = CT_Disk2;
+				if (strcmp(lpCmdLine, "uthernet2") == 0)
+					g_cmdLine.slotInsert[slot] = CT_Uthernet2;
 			}
 			else if (lpCmdLine[3] == 'd' && (lpCmdLine[4] == '1' || lpCmdLine[4] == '2'))	// -s[1..7]d[1|2] <dsk-image>
 			{
@@ -396,6 +398,11 @@ bool ProcessCmdLine(LPSTR lpCmdLine)
 			if (GetCardMgr().IsSSCInstalled())
 				GetCardMgr().GetSSC()->SupportDCD(true);
 		}
+		else if (strcmp(lpCmdLine, "-tcp-serial-turbo") == 0)
+		{
+			if (GetCardMgr().IsSSCInstalled())
+				GetCardMgr().GetSSC()->SetTcpSerialTurbo(true);
+		}
 		else if (strcmp(lpCmdLine, "-alt-enter=toggle-full-screen") == 0)	// GH#556
 		{
 			GetFrame().SetAltEnterToggleFullScreen(true);
@@ -433,6 +440,18 @@ bool ProcessCmdLine(LPSTR lpCmdLine)
 			g_cmdLine.szScreenshotFilename = GetCurrArg(lpNextArg);
 			lpNextArg = GetNextArg(lpNextArg);
 		}
+		else if (strcmp(lpCmdLine, "-debugger-server") == 0)
+		{
+			lpCmdLine = GetCurrArg(lpNextArg);
+			lpNextArg = GetNextArg(lpNextArg);
+			g_cmdLine.uDebuggerServerPort = atoi(lpCmdLine);
+		}
+		else if (strcmp(lpCmdLine, "-gdb-server") == 0)
+		{
+			lpCmdLine = GetCurrArg(lpNextArg);
+			lpNextArg = GetNextArg(lpNextArg);
+			g_cmdLine.uGdbStubPort = atoi(lpCmdLine);
+		}
 		else if (strcmp(lpCmdLine, "-clock-multiplier") == 0)
 		{
 			lpCmdLine = GetCurrArg(lpNextArg);
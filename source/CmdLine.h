@@ -33,6 +33,8 @@ struct CmdLine
 		rgbCard = RGB_Videocard_e::Apple;
 		rgbCardForegroundColor = 15;
 		rgbCardBackgroundColor = 0;
+		uDebuggerServerPort = 0;
+		uGdbStubPort = 0;
 
 		for (UINT i = 0; i < NUM_SLOTS; i++)
 		{
@@ -70,6 +72,8 @@ struct CmdLine
 	RGB_Videocard_e rgbCard;
 	int rgbCardForegroundColor;
 	int rgbCardBackgroundColor;
+	UINT uDebuggerServerPort;	// 0 = no debugger server
+	UINT uGdbStubPort;			// 0 = no GDB remote stub
 	std::string strCurrentDir;
 };
 
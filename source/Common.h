@@ -136,10 +136,11 @@ enum AppMode_e
 #define WM_USER_LOADSTATE	WM_USER+3
 #define VK_SNAPSHOT_560		WM_USER+4 // PrintScreen
 #define VK_SNAPSHOT_280		WM_USER+5 // PrintScreen+Shift
-#define WM_USER_TCP_SERIAL	WM_USER+6
 #define WM_USER_BOOT		WM_USER+7
 #define WM_USER_FULLSCREEN	WM_USER+8
 #define VK_SNAPSHOT_TEXT	WM_USER+9 // PrintScreen+Ctrl
+#define WM_USER_DEBUGGER_SERVER	WM_USER+10
+#define WM_USER_GDB_STUB	WM_USER+11
 
 #ifdef _MSC_VER
 #define PATH_SEPARATOR '\\'
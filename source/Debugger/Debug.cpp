@@ -42,6 +42,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "../CPU.h"
 #include "../Disk.h"
 #include "../Keyboard.h"
+#include "../LanguageCard.h"
 #include "../Memory.h"
 #include "../NTSC.h"
 #include "../SoundCore.h"	// SoundCore_SetFade()
@@ -51,7 +52,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #define ALLOW_INPUT_LOWERCASE 1
 
 	// See /docs/Debugger_Changelog.txt for full details
-	const int DEBUGGER_VERSION = MAKE_VERSION(2,9,1,0);
+	const int DEBUGGER_VERSION = MAKE_VERSION(2,9,1,15);
 
 
 // Public _________________________________________________________________________________________
@@ -118,6 +119,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	};
 
 	static WORD g_uBreakMemoryAddress = 0;
+	// Memory breakpoints accessed by the opcode(s) being executed: their conditions are checked after the opcode, see CheckBreakpointsMem()
+	static bool g_bBreakpointMemAccessed = false;
+	static int  g_aBreakpointMemAccess       [ MAX_BREAKPOINTS ]; // BP_HIT_MEM, BP_HIT_MEMR or BP_HIT_MEMW
+	static WORD g_aBreakpointMemAccessAddress[ MAX_BREAKPOINTS ];
+
+	BreakpointTraps_t g_BreakpointTraps;
+	static bool g_bBreakpointTrapsDirty = true; // Rebuild traps before next use
+	static bool g_bBreakpointTrapsValid = false; // All enabled breakpoints could be compiled into traps
 
 // Commands _______________________________________________________________________________________
 
@@ -332,6 +341,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	bool _CmdBreakpointAddReg ( Breakpoint_t *pBP, BreakpointSource_t iSrc, BreakpointOperator_t iCmp, WORD nAddress, int nLen, bool bIsTempBreakpoint );
 	int  _CmdBreakpointAddCommonArg ( int iArg, int nArg, BreakpointSource_t iSrc, BreakpointOperator_t iCmp, bool bIsTempBreakpoint=false );
 	void _BWZ_Clear( Breakpoint_t * aBreakWatchZero, int iSlot );
+	void _BWZ_RemoveOne( Breakpoint_t *aBreakWatchZero, const int iSlot, int & nTotal );
 
 // Config - Save
 	bool ConfigSave_BufferToDisk ( const char *pFileName, ConfigSave_t eConfigSave );
@@ -750,15 +760,19 @@ Update_t CmdBenchmarkStop (int nArgs)
 //===========================================================================
 Update_t CmdProfile (int nArgs)
 {
+	int iParam;
+
 	if (! nArgs)
 	{
 		sprintf( g_aArgs[ 1 ].sArg, "%s", g_aParameters[ PARAM_RESET ].m_sName );
 		nArgs = 1;
 	}
 
+	if (FindParam( g_aArgs[ 1 ].sArg, MATCH_EXACT, iParam, _PARAM_GENERAL_BEGIN, _PARAM_GENERAL_END ) && (iParam == PARAM_CALLS))
+		return CmdProfileCalls( nArgs );
+
 	if (nArgs == 1)
 	{
-		int iParam;
 		int nFound = FindParam( g_aArgs[ 1 ].sArg, MATCH_EXACT, iParam, _PARAM_GENERAL_BEGIN, _PARAM_GENERAL_END );
 
 		if (! nFound)
@@ -847,6 +861,7 @@ static void SetDebugBreakOnInvalid( int iOpcodeType, int nValue )
 	{
 		g_nDebugBreakOnInvalid &= ~ (          1  << iOpcodeType);
 		g_nDebugBreakOnInvalid |=   ((nValue & 1) << iOpcodeType);
+		g_bBreakpointTrapsDirty = true;
 	}
 }
 
@@ -960,6 +975,7 @@ Update_t CmdBreakOpcode (int nArgs) // Breakpoint IFF Full-speed!
 	{
 		int iOpcode = g_aArgs[ 1] .nValue;
 		g_iDebugBreakOnOpcode = iOpcode & 0xFF;
+		g_bBreakpointTrapsDirty = true;
 
 		_tcscpy( sAction, TEXT("Setting") );
 
@@ -1074,9 +1090,34 @@ bool _CheckBreakpointValue( Breakpoint_t *pBP, int nVal )
 	return bStatus;
 }
 
+// Counts the hit, then evaluates the breakpoint's condition, if any, see BPIF
+//===========================================================================
+static bool _CheckBreakpointCondition ( int iBreakpoint )
+{
+	Breakpoint_t *pBP = &g_aBreakpoints[ iBreakpoint ];
+
+	pBP->nHits++;
+	return ConditionEvaluate( g_aBreakpointConditions[ iBreakpoint ], pBP->nHits );
+}
+
 
+// NB. Don't check the breakpoint's condition yet: in the CPU core the flags and cycles aren't up-to-date until after the opcode
 //===========================================================================
-int CheckBreakpointsIO ()
+static void _SetBreakpointMemAccess ( int iBreakpoint, int bBreakpointHit, WORD nAddress )
+{
+	g_bBreakpointMemAccessed = true;
+
+	if (g_aBreakpointMemAccess[ iBreakpoint ] != BP_HIT_NONE)	// Report the opcode's 1st access
+		return;
+
+	g_aBreakpointMemAccess       [ iBreakpoint ] = bBreakpointHit;
+	g_aBreakpointMemAccessAddress[ iBreakpoint ] = nAddress;
+}
+
+// Records the memory breakpoints (if any) that the opcode at PC will access, see CheckBreakpointsMem()
+// NB. Call before the opcode is executed, as the targets depend on the registers and memory
+//===========================================================================
+void CheckBreakpointsIO ()
 {
 	const int NUM_TARGETS = 3;
 
@@ -1087,7 +1128,6 @@ int CheckBreakpointsIO ()
 		NO_6502_TARGET
 	};
 	int  nBytes;
-	bool bBreakpointHit = 0;
 
 	int  iTarget;
 	int  nAddress;
@@ -1113,27 +1153,30 @@ int CheckBreakpointsIO ()
 						{
 							if (_CheckBreakpointValue( pBP, nAddress ))
 							{
-								g_uBreakMemoryAddress = (WORD) nAddress;
 								BYTE opcode = mem[regs.pc];
+								int bHit = BP_HIT_NONE;
 
 								if (pBP->eSource == BP_SRC_MEM_RW)
 								{
-									return BP_HIT_MEM;
+									bHit = BP_HIT_MEM;
 								}
 								else if (pBP->eSource == BP_SRC_MEM_READ_ONLY)
 								{
 									if (g_aOpcodes[opcode].nMemoryAccess & (MEM_RI|MEM_R))
-										return BP_HIT_MEMR;
+										bHit = BP_HIT_MEMR;
 								}
 								else if (pBP->eSource == BP_SRC_MEM_WRITE_ONLY)
 								{
 									if (g_aOpcodes[opcode].nMemoryAccess & (MEM_WI|MEM_W))
-										return BP_HIT_MEMW;
+										bHit = BP_HIT_MEMW;
 								}
 								else
 								{
 									_ASSERT(0);
 								}
+
+								if (bHit)
+									_SetBreakpointMemAccess( iBreakpoint, bHit, (WORD) nAddress );
 							}
 						}
 					}
@@ -1141,6 +1184,33 @@ int CheckBreakpointsIO ()
 			}
 		}
 	}
+}
+
+// Returns the memory breakpoint hit by the opcode(s) just executed
+// . Memory breakpoints stop after the opcode that accessed memory, whether the CPU core trapped the access or CheckBreakpointsIO() found it
+//===========================================================================
+int CheckBreakpointsMem ()
+{
+	int bBreakpointHit = BP_HIT_NONE;
+
+	if (! g_bBreakpointMemAccessed)
+		return bBreakpointHit;
+
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		if (g_aBreakpointMemAccess[ iBreakpoint ] == BP_HIT_NONE)
+			continue;
+
+		if (! bBreakpointHit && _CheckBreakpointCondition( iBreakpoint ))
+		{
+			bBreakpointHit = g_aBreakpointMemAccess[ iBreakpoint ];
+			g_uBreakMemoryAddress = g_aBreakpointMemAccessAddress[ iBreakpoint ];
+		}
+
+		g_aBreakpointMemAccess[ iBreakpoint ] = BP_HIT_NONE;
+	}
+
+	g_bBreakpointMemAccessed = false;
 	return bBreakpointHit;
 }
 
@@ -1181,6 +1251,9 @@ int CheckBreakpointsReg ()
 				break;
 		}
 
+		if (bBreakpointHit && ! _CheckBreakpointCondition( iBreakpoint ))
+			bBreakpointHit = 0;
+
 		if (bBreakpointHit)
 		{
 			bBreakpointHit = BP_HIT_REG;
@@ -1208,6 +1281,191 @@ void ClearTempBreakpoints ()
 	}
 }
 
+// Breakpoint Traps _______________________________________________________________________________
+
+//===========================================================================
+static void _BreakpointTrapSetPC ( int nAddress )
+{
+	g_BreakpointTraps.aPC[ (nAddress & _6502_MEM_END) >> 3 ] |= (1 << (nAddress & 7));
+}
+
+// Returns false if a breakpoint can't be compiled into a trap, ie. a register breakpoint other than PC
+//===========================================================================
+static bool BreakpointTrapsBuild ()
+{
+	memset( g_BreakpointTraps.aPC    , 0, sizeof( g_BreakpointTraps.aPC     ) );
+	memset( g_BreakpointTraps.aOpcode, 0, sizeof( g_BreakpointTraps.aOpcode ) );
+	memset( g_BreakpointTraps.aMem   , 0, sizeof( g_BreakpointTraps.aMem    ) );
+
+	bool bValid = true;
+	bool bMem   = false;
+
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		Breakpoint_t *pBP = &g_aBreakpoints[iBreakpoint];
+
+		if (! _BreakpointValid( pBP ))
+			continue;
+
+		const UINT nEnd = pBP->nAddress + pBP->nLength; // [nAddress,nEnd)
+
+		switch (pBP->eSource)
+		{
+			case BP_SRC_REG_PC:
+				if (pBP->eOperator == BP_OP_EQUAL)
+				{
+					for (UINT nAddress = pBP->nAddress; nAddress < nEnd && nAddress <= _6502_MEM_END; nAddress++)
+						_BreakpointTrapSetPC( nAddress );
+				}
+				else
+				{
+					for (UINT nAddress = _6502_MEM_BEGIN; nAddress <= _6502_MEM_END; nAddress++)
+						if (_CheckBreakpointValue( pBP, nAddress ))
+							_BreakpointTrapSetPC( nAddress );
+				}
+				break;
+
+			case BP_SRC_MEM_RW:
+			case BP_SRC_MEM_READ_ONLY:
+			case BP_SRC_MEM_WRITE_ONLY:
+			{
+				const BYTE nAccess = (pBP->eSource == BP_SRC_MEM_READ_ONLY ) ? BP_TRAP_MEM_READ
+								   : (pBP->eSource == BP_SRC_MEM_WRITE_ONLY) ? BP_TRAP_MEM_WRITE
+								   : (BP_TRAP_MEM_READ | BP_TRAP_MEM_WRITE);
+
+				UINT nPageBegin = 0x00;
+				UINT nPageEnd   = 0xFF;
+				if (pBP->eOperator == BP_OP_EQUAL)
+				{
+					nPageBegin = pBP->nAddress >> 8;
+					nPageEnd   = (nEnd > _6502_MEM_END) ? 0xFF : ((nEnd - 1) >> 8);
+				}
+
+				// Zero page pointers and the stack are accessed directly by the CPU core (not via READ/WRITE), so can't be trapped
+				// . NB. IRQ & NMI pushes aren't checked by CheckBreakpointsIO() either
+				if (nPageBegin <= (_6502_STACK_BEGIN >> 8))
+					bValid = false;
+
+				for (UINT iPage = nPageBegin; iPage <= nPageEnd; iPage++)
+					g_BreakpointTraps.aMem[ iPage ] |= nAccess;
+
+				bMem = true;
+				break;
+			}
+
+			default:
+				bValid = false; // A, X, Y, P, S: value can change on any opcode
+				break;
+		}
+	}
+
+	if (g_nDebugStepUntil >= 0)
+		_BreakpointTrapSetPC( g_nDebugStepUntil );
+
+	// See: CheckBreakOpcode()
+	for (int iOpcode = 0; iOpcode < NUM_OPCODES; iOpcode++)
+	{
+		if (iOpcode == 0x00)
+			g_BreakpointTraps.aOpcode[ iOpcode ] |= (g_nDebugBreakOnInvalid >> AM_IMPLIED) & 1;
+
+		if (g_aOpcodes[iOpcode].sMnemonic[0] >= 'a')
+			g_BreakpointTraps.aOpcode[ iOpcode ] |= (g_nDebugBreakOnInvalid >> AM_1) & 1;
+	}
+
+	if (g_iDebugBreakOnOpcode)
+		g_BreakpointTraps.aOpcode[ g_iDebugBreakOnOpcode ] = 1;
+
+	// JMP (abs) & JMP (abs,X) read their pointer directly (not via READ), so stop before them and let CheckBreakpointsIO() check it
+	if (bMem)
+	{
+		g_BreakpointTraps.aOpcode[ OPCODE_JMP_NA  ] = 1;
+		g_BreakpointTraps.aOpcode[ OPCODE_JMP_IAX ] = 1;
+	}
+
+	g_BreakpointTraps.bOpcode = false;
+	for (int iOpcode = 0; iOpcode < NUM_OPCODES; iOpcode++)
+		if (g_BreakpointTraps.aOpcode[ iOpcode ])
+			g_BreakpointTraps.bOpcode = true;
+
+	return bValid;
+}
+
+// Can "G" run a whole execution period between debugger checks?
+//===========================================================================
+static bool BreakpointTrapsCanRun ()
+{
+	if (g_nDebugSteps >= 0)		// T #, P, etc.: UI & 'Stop reason' per step
+		return false;
+
+	if (g_nDebugSkipLen > 0)	// G addr Skip,Len: Stop when PC leaves the skip range
+		return false;
+
+	if (g_hTraceFile || g_bProfiling)	// Need every opcode
+		return false;
+
+	if (g_bBreakpointTrapsDirty)
+	{
+		g_bBreakpointTrapsValid = BreakpointTrapsBuild();
+		g_bBreakpointTrapsDirty = false;
+	}
+
+	return g_bBreakpointTrapsValid;
+}
+
+// Exact check of a memory access against the memory breakpoints
+// NB. Unlike CheckBreakpointsIO(), this checks the actual access, so it's called by the CPU core during the opcode
+// Returns true if any breakpoint was accessed (its condition is checked after the opcode)
+//===========================================================================
+static bool _CheckBreakpointsMemAccess ( WORD nAddress, BYTE nAccess )
+{
+	bool bAccessed = false;
+
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		Breakpoint_t *pBP = &g_aBreakpoints[iBreakpoint];
+
+		if (! _BreakpointValid( pBP ))
+			continue;
+
+		if (! _CheckBreakpointValue( pBP, nAddress ))
+			continue;
+
+		int bBreakpointHit = BP_HIT_NONE;
+
+		if (pBP->eSource == BP_SRC_MEM_RW)
+			bBreakpointHit = BP_HIT_MEM;
+		else if (pBP->eSource == BP_SRC_MEM_READ_ONLY && (nAccess & BP_TRAP_MEM_READ))
+			bBreakpointHit = BP_HIT_MEMR;
+		else if (pBP->eSource == BP_SRC_MEM_WRITE_ONLY && (nAccess & BP_TRAP_MEM_WRITE))
+			bBreakpointHit = BP_HIT_MEMW;
+
+		if (bBreakpointHit)
+		{
+			_SetBreakpointMemAccess( iBreakpoint, bBreakpointHit, nAddress );
+			bAccessed = true;
+		}
+	}
+
+	return bAccessed;
+}
+
+// Called by the debug CPU core on a memory access to a trapped page
+//===========================================================================
+void BreakpointTrapMem ( WORD nAddress, BYTE nAccess )
+{
+	if (! g_BreakpointTraps.bArmed)
+		return;
+
+	if (_CheckBreakpointsMemAccess( nAddress, nAccess ))
+		g_BreakpointTraps.bHit = true;	// Stop after this opcode, then check the condition
+}
+
+//===========================================================================
+bool IsDebugBreakpointTrapsArmed (void)
+{
+	return g_BreakpointTraps.bArmed;
+}
+
 //===========================================================================
 Update_t CmdBreakpoint (int nArgs)
 {
@@ -1332,7 +1590,11 @@ bool _CmdBreakpointAddReg( Breakpoint_t *pBP, BreakpointSource_t iSrc, Breakpoin
 		pBP->bSet      = true;
 		pBP->bEnabled  = true;
 		pBP->bTemp     = bIsTempBreakpoint;
+		pBP->bExternal = false;
+		pBP->nHits     = 0;
 		bStatus = true;
+
+		g_bBreakpointTrapsDirty = true;
 	}
 
 	return bStatus;
@@ -1395,6 +1657,43 @@ int _CmdBreakpointAddCommonArg ( int iArg, int nArg, BreakpointSource_t iSrc, Br
 }
 
 
+// Same as BPX/BPM with an exact address, without console args (eg. for the GDB stub)
+// @return Breakpoint slot, or -1 if all slots are in use
+//===========================================================================
+int BreakpointAdd ( BreakpointSource_t iSrc, WORD nAddress, int nLen )
+{
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		if (g_aBreakpoints[ iBreakpoint ].bSet)
+			continue;
+
+		_CmdBreakpointAddReg( &g_aBreakpoints[ iBreakpoint ], iSrc, BP_OP_EQUAL, nAddress, nLen, false );
+		g_aBreakpoints[ iBreakpoint ].bExternal = true;
+		g_nBreakpoints++;
+		return iBreakpoint;
+	}
+
+	return -1;
+}
+
+// Removes the first breakpoint that BreakpointAdd() set with the same args (not one set by the user with the same args)
+//===========================================================================
+bool BreakpointRemove ( BreakpointSource_t iSrc, WORD nAddress, int nLen )
+{
+	for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+	{
+		const Breakpoint_t & bp = g_aBreakpoints[ iBreakpoint ];
+		if (bp.bSet && bp.bExternal && (bp.eSource == iSrc) && (bp.eOperator == BP_OP_EQUAL) && (bp.nAddress == nAddress) && (bp.nLength == nLen))
+		{
+			_BWZ_RemoveOne( g_aBreakpoints, iBreakpoint, g_nBreakpoints );
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
 //===========================================================================
 Update_t CmdBreakpointAddPC (int nArgs)
 {
@@ -1508,6 +1807,14 @@ void _BWZ_Clear( Breakpoint_t * aBreakWatchZero, int iSlot )
 	aBreakWatchZero[ iSlot ].bSet     = false;
 	aBreakWatchZero[ iSlot ].bEnabled = false;
 	aBreakWatchZero[ iSlot ].nLength  = 0;
+
+	if (aBreakWatchZero == g_aBreakpoints)
+	{
+		g_aBreakpointConditions[ iSlot ].nOps     = 0;
+		g_aBreakpointConditions[ iSlot ].sText[0] = 0;
+	}
+
+	g_bBreakpointTrapsDirty = true;
 }
 
 void _BWZ_RemoveOne( Breakpoint_t *aBreakWatchZero, const int iSlot, int & nTotal )
@@ -1559,6 +1866,8 @@ void _BWZ_EnableDisableViaArgs( int nArgs, Breakpoint_t * aBreakWatchZero, const
 {
 	int iSlot = 0;
 
+	g_bBreakpointTrapsDirty = true;
+
 	// Enable each breakpoint in the list
 	while (nArgs)
 	{
@@ -1661,6 +1970,14 @@ void _BWZ_List( const Breakpoint_t * aBreakWatchZero, const int iBWZ ) //, bool
 		cBPM,
 		pSymbol
 	);
+
+	if ((aBreakWatchZero == g_aBreakpoints) && g_aBreakpointConditions[ iBWZ ].nOps)
+	{
+		ConsoleBufferPushFormat( sText, "         IF %s  (Hits: %u)",
+			g_aBreakpointConditions[ iBWZ ].sText,
+			aBreakWatchZero[ iBWZ ].nHits
+		);
+	}
 }
 
 void _BWZ_ListAll( const Breakpoint_t * aBreakWatchZero, const int nMax )
@@ -1676,6 +1993,45 @@ void _BWZ_ListAll( const Breakpoint_t * aBreakWatchZero, const int nMax )
 	}
 }
 
+// BPIF # [expression]
+// No expression removes the condition
+//===========================================================================
+Update_t CmdBreakpointIf (int nArgs)
+{
+	if (! nArgs)
+		return Help_Arg_1( CMD_BREAKPOINT_IF );
+
+	// Args aren't cooked, see ExecuteCommand()
+	const char *pSrc = SkipWhiteSpace( g_pConsoleFirstArg );
+	if (*pSrc == '#')
+		pSrc++;
+
+	char *pEnd = NULL;
+	const int iBreakpoint = (int) strtoul( pSrc, &pEnd, 16 );
+
+	if ((pEnd == pSrc) || (iBreakpoint >= MAX_BREAKPOINTS))
+		return Help_Arg_1( CMD_BREAKPOINT_IF );
+
+	if (! g_aBreakpoints[ iBreakpoint ].bSet)
+		return ConsoleDisplayError( "Breakpoint not set." );
+
+	BreakpointCondition_t condition;
+	const char *pError = NULL;
+	if (! ConditionCompile( pEnd, condition, pError ))
+	{
+		char sText[ CONSOLE_WIDTH ];
+		sprintf( sText, "Condition: %s", pError );
+		return ConsoleDisplayError( sText );
+	}
+
+	g_aBreakpointConditions[ iBreakpoint ] = condition;
+	g_aBreakpoints[ iBreakpoint ].nHits = 0;
+
+	_BWZ_List( g_aBreakpoints, iBreakpoint );
+
+	return UPDATE_BREAKPOINTS | ConsoleUpdate();
+}
+
 //===========================================================================
 Update_t CmdBreakpointList (int nArgs)
 {
@@ -1733,6 +2089,15 @@ Update_t CmdBreakpointSave (int nArgs)
 			);
 			g_ConfigState.PushLine( sText );
 		}
+		if (g_aBreakpoints[ iBreakpoint ].bSet && g_aBreakpointConditions[ iBreakpoint ].nOps)
+		{
+			sprintf( sText, "%s %x %s\n"
+				, g_aCommands[ CMD_BREAKPOINT_IF ].m_sName
+				, iBreakpoint
+				, g_aBreakpointConditions[ iBreakpoint ].sText
+			);
+			g_ConfigState.PushLine( sText );
+		}
 		if (! g_aBreakpoints[ iBreakpoint ].bEnabled)
 		{
 			sprintf( sText, "%s %x\n"
@@ -1942,6 +2307,8 @@ static Update_t CmdGo (int nArgs, const bool bFullSpeed)
 
 	g_bDebuggerEatKey = true;
 
+	g_bBreakpointTrapsDirty = true;	// g_nDebugStepUntil
+
 	g_bDebugFullSpeed = bFullSpeed;
 	g_bLastGoCmdWasFullSpeed = bFullSpeed;
 	g_bGoCmd_ReinitFlag = true;
@@ -2083,6 +2450,115 @@ Update_t CmdTraceLine (int nArgs)
 }
 
 
+// Execution History ______________________________________________________________________________
+
+//===========================================================================
+Update_t CmdHistory (int nArgs)
+{
+	// HISTORY [ON | OFF]
+	if (nArgs > 1)
+		return Help_Arg_1( CMD_HISTORY );
+
+	if (nArgs == 1)
+	{
+		int iParam;
+		int nFound = FindParam( g_aArgs[ 1 ].sArg, MATCH_EXACT, iParam, _PARAM_GENERAL_BEGIN, _PARAM_GENERAL_END );
+
+		if (!nFound || ((iParam != PARAM_ON) && (iParam != PARAM_OFF)))
+			return Help_Arg_1( CMD_HISTORY );
+
+		if (iParam == PARAM_OFF)
+			HistoryStop();
+		else
+		if (!g_DebugHistory.bEnabled)
+			HistoryStart();
+	}
+
+	TCHAR sText[ CONSOLE_WIDTH ];
+	ConsoleBufferPushFormat( sText, "Execution history: %s, %u instructions"
+		, g_aParameters[ g_DebugHistory.bEnabled ? PARAM_ON : PARAM_OFF ].m_sName
+		, g_DebugHistory.nValid
+	);
+
+	return ConsoleUpdate();
+}
+
+//===========================================================================
+static Update_t _HistoryReversed ( const int nSteps, const char *pStopReason )
+{
+	TCHAR sText[ CONSOLE_WIDTH ];
+
+	if (!g_DebugHistory.bEnabled)
+		ConsoleBufferPush( "Execution history is OFF. See: HISTORY" );
+	else
+		ConsoleBufferPushFormat( sText, "Reversed %d instructions. Stop reason: %s", nSteps, pStopReason );
+
+	ConsoleBufferToDisplay();
+
+	g_nDisasmCurAddress = regs.pc;
+	DisasmCalcTopBotAddress();
+
+	return UPDATE_ALL;
+}
+
+//===========================================================================
+Update_t CmdTraceReverse (int nArgs)
+{
+	const int nSteps = nArgs ? g_aArgs[1].nValue : 1;
+
+	UINT iAccessBegin;
+	UINT iAccessEnd;
+
+	int nReversed = 0;
+	while ((nReversed < nSteps) && HistoryUndoStep( iAccessBegin, iAccessEnd ))
+		nReversed++;
+
+	if (nReversed < nSteps)
+		return _HistoryReversed( nReversed, "Start of execution history" );
+
+	g_nDisasmCurAddress = regs.pc;
+	DisasmCalcTopBotAddress();
+
+	return UPDATE_ALL;
+}
+
+// Find what got us here, eg. BPMW addr, GR: stops before the opcode that wrote to addr
+//===========================================================================
+Update_t CmdGoReverse (int nArgs)
+{
+	UINT iAccessBegin;
+	UINT iAccessEnd;
+
+	int nReversed = 0;
+	while (HistoryUndoStep( iAccessBegin, iAccessEnd ))
+	{
+		nReversed++;
+
+		// The registers and memory are now as they were before the opcode, so check its targets like single-stepping does
+		// . NB. the history only logs I/O reads and non-stack writes, so its accesses can't be used for RAM reads or the stack
+		CheckBreakpointsIO();
+		const int bBreakpointHit = CheckBreakpointsMem();
+		if (bBreakpointHit)
+		{
+			char sStopReason[ CONSOLE_WIDTH ];
+			sprintf_s( sStopReason, sizeof(sStopReason), "%s access at $%04X"
+				, (bBreakpointHit == BP_HIT_MEMR) ? "Read" : (bBreakpointHit == BP_HIT_MEMW) ? "Write" : "Memory"
+				, g_uBreakMemoryAddress );
+			return _HistoryReversed( nReversed, sStopReason );
+		}
+
+		for (int iBreakpoint = 0; iBreakpoint < MAX_BREAKPOINTS; iBreakpoint++)
+		{
+			Breakpoint_t *pBP = &g_aBreakpoints[iBreakpoint];
+
+			if (_BreakpointValid( pBP ) && (pBP->eSource == BP_SRC_REG_PC) && _CheckBreakpointValue( pBP, regs.pc ) && _CheckBreakpointCondition( iBreakpoint ))
+				return _HistoryReversed( nReversed, "Register matches value" );
+		}
+	}
+
+	return _HistoryReversed( nReversed, "Start of execution history" );
+}
+
 
 
 // Unassemble
@@ -5194,92 +5670,114 @@ int CmdTextSave (int nArgs)
 	return ConsoleUpdate();
 }
 
+// The search values are compiled to a (mask,value) per byte, ? and ?? are mask 0.
+// Candidates are found with memchr() on the 1st exact byte (the CRT's memchr is vectorised),
+// and only then is the whole pattern compared.
 //===========================================================================
-int _SearchMemoryFind(
-	MemorySearchValues_t vMemorySearchValues,
-	WORD nAddressStart,
-	WORD nAddressEnd )
+struct MemorySearchPattern_t
 {
-	int   nFound = 0;
-	g_vMemorySearchResults.erase( g_vMemorySearchResults.begin(), g_vMemorySearchResults.end() );
-	g_vMemorySearchResults.push_back( NO_6502_TARGET );
+	std::vector<BYTE> vMask ;
+	std::vector<BYTE> vValue;
+	int               iAnchor; // 1st byte with mask 0xFF, or -1
+};
 
-	WORD nAddress;
-	for( nAddress = nAddressStart; nAddress < nAddressEnd; nAddress++ )
+//===========================================================================
+static void _SearchMemoryCompile( const MemorySearchValues_t & vMemorySearchValues, MemorySearchPattern_t & pattern_ )
+{
+	pattern_.vMask .clear();
+	pattern_.vValue.clear();
+	pattern_.iAnchor = -1;
+
+	int nMemBlocks = vMemorySearchValues.size();
+	for (int iBlock = 0; iBlock < nMemBlocks; iBlock++ )
 	{
-		bool bMatchAll = true;
+		const MemorySearch_t & ms = vMemorySearchValues.at( iBlock );
+
+		BYTE nMask = 0x00;
+		switch (ms.m_iType)
+		{
+			case MEM_SEARCH_BYTE_EXACT    : nMask = 0xFF; break;
+			case MEM_SEARCH_NIB_LOW_EXACT : nMask = 0x0F; break;
+			case MEM_SEARCH_NIB_HIGH_EXACT: nMask = 0xF0; break;
+			default:                                      break; // ? ?? match any byte
+		}
+
+		if ((nMask == 0xFF) && (pattern_.iAnchor < 0))
+			pattern_.iAnchor = iBlock;
+
+		pattern_.vMask .push_back( nMask );
+		pattern_.vValue.push_back( ms.m_nValue & nMask );
+	}
+}
+
+// pMemBase: nMemSize bytes for addresses [nMemBase,nMemBase+nMemSize)
+// bWrap   : pattern can wrap from $FFFF to $0000, only for a full 64K
+//===========================================================================
+static int _SearchMemoryBlock(
+	const MemorySearchPattern_t & pattern,
+	const BYTE *pMemBase, UINT nMemBase, UINT nMemSize, bool bWrap,
+	UINT nAddressStart, UINT nAddressEnd, int nBank )
+{
+	const UINT nLen  = pattern.vMask.size();
+	const UINT nLast = nMemBase + nMemSize; // exclusive
 
-		WORD nAddress2 = nAddress;
+	if (!nLen || (nLen > nMemSize))
+		return 0;
 
-		int nMemBlocks = vMemorySearchValues.size();
-		for (int iBlock = 0; iBlock < nMemBlocks; iBlock++, nAddress2++ )
+	if (nAddressStart < nMemBase)
+		nAddressStart = nMemBase;
+
+	if (!bWrap && (nAddressEnd > nLast - nLen + 1))
+		nAddressEnd = nLast - nLen + 1;
+
+	if (nAddressEnd > nLast)
+		nAddressEnd = nLast;
+
+	if (nAddressStart >= nAddressEnd)
+		return 0;
+
+	const BYTE *pMask  = &pattern.vMask [0];
+	const BYTE *pValue = &pattern.vValue[0];
+	int nFound = 0;
+
+	UINT nAddress = nAddressStart;
+	while (nAddress < nAddressEnd)
+	{
+		if (pattern.iAnchor >= 0)
 		{
-			MemorySearch_t ms = vMemorySearchValues.at( iBlock );
-			ms.m_bFound = false;
-		
-			if ((ms.m_iType == MEM_SEARCH_BYTE_EXACT    ) || 
-				(ms.m_iType == MEM_SEARCH_NIB_HIGH_EXACT) ||
-				(ms.m_iType == MEM_SEARCH_NIB_LOW_EXACT ))
-			{
-				BYTE nTarget = *(mem + nAddress2);
-	
-				if (ms.m_iType == MEM_SEARCH_NIB_LOW_EXACT)
-					nTarget &= 0x0F;
+			// Find next candidate for the anchor byte, in linear addresses [nAnchor,nAnchorEnd) which only exceed nLast if bWrap
+			const UINT nAnchor    = nAddress    + pattern.iAnchor;
+			const UINT nAnchorEnd = nAddressEnd + pattern.iAnchor;
+			const UINT nScanEnd   = (nAnchor < nLast) ? MIN( nAnchorEnd, nLast ) : nAnchorEnd;
+			const BYTE *pScan     = pMemBase + ((nAnchor < nLast) ? nAnchor : nAnchor - nMemSize) - nMemBase;
 
-				if (ms.m_iType == MEM_SEARCH_NIB_HIGH_EXACT)
-					nTarget &= 0xF0;
-				
-				if (ms.m_nValue == nTarget)
-				{ // ms.m_nAddress = nAddress2;
-					ms.m_bFound = true;
-					continue;
-				}
-				else
-				{
-					bMatchAll = false;
-					break;
-				}
-			}
-			else
-			if (ms.m_iType == MEM_SEARCH_BYTE_1_WILD)
+			const BYTE *pFound = (const BYTE*) memchr( pScan, pValue[ pattern.iAnchor ], nScanEnd - nAnchor );
+			if (!pFound)
 			{
-				// match by definition
+				if (nScanEnd == nAnchorEnd)
+					break;
+
+				nAddress = nScanEnd - pattern.iAnchor; // continue from $0000
+				continue;
 			}
-			else
-			{
-				// start 2ndary search
-				// if next block matches, then this block matches (since we are wild)
-				if ((iBlock + 1) == nMemBlocks) // there is no next block, hence we match
-					continue;
 
-				WORD nAddress3 = nAddress2;
-				for (nAddress3 = nAddress2; nAddress3 < nAddressEnd; nAddress3++ )
-				{
-					if ((ms.m_iType == MEM_SEARCH_BYTE_EXACT    ) || 
-						(ms.m_iType == MEM_SEARCH_NIB_HIGH_EXACT) ||
-						(ms.m_iType == MEM_SEARCH_NIB_LOW_EXACT ))
-					{
-						BYTE nTarget = *(mem + nAddress3);
-			
-						if (ms.m_iType == MEM_SEARCH_NIB_LOW_EXACT)
-							nTarget &= 0x0F;
+			nAddress += (pFound - pScan);
 
-						if (ms.m_iType == MEM_SEARCH_NIB_HIGH_EXACT)
-							nTarget &= 0xF0;
-						
-						if (ms.m_nValue == nTarget)
-						{
-							nAddress2 = nAddress3;
-							continue;
-						}
-						else
-						{
-							bMatchAll = false;
-							break;
-						}
-					}
+			if (nAddress >= nAddressEnd)
+				break;
+		}
 
-				}
+		bool bMatchAll = true;
+		for (UINT iByte = 0; iByte < nLen; iByte++)
+		{
+			UINT nAddress2 = nAddress + iByte;
+			if (nAddress2 >= nLast)
+				nAddress2 -= nMemSize; // bWrap
+
+			if ((pMemBase[ nAddress2 - nMemBase ] & pMask[ iByte ]) != pValue[ iByte ])
+			{
+				bMatchAll = false;
+				break;
 			}
 		}
 
@@ -5288,7 +5786,45 @@ int _SearchMemoryFind(
 			nFound++;
 
 			// Save the search result
-			g_vMemorySearchResults.push_back( nAddress );
+			g_vMemorySearchResults.push_back( (nBank << MEM_SEARCH_BANK_SHIFT) | nAddress );
+		}
+
+		nAddress++;
+	}
+
+	return nFound;
+}
+
+//===========================================================================
+int _SearchMemoryFind(
+	MemorySearchValues_t vMemorySearchValues,
+	WORD nAddressStart,
+	WORD nAddressEnd,
+	bool bAllBanks = false )
+{
+	int   nFound = 0;
+	g_vMemorySearchResults.erase( g_vMemorySearchResults.begin(), g_vMemorySearchResults.end() );
+	g_vMemorySearchResults.push_back( NO_6502_TARGET );
+
+	MemorySearchPattern_t pattern;
+	_SearchMemoryCompile( vMemorySearchValues, pattern );
+
+	if (!bAllBanks)
+		return _SearchMemoryBlock( pattern, mem, 0, _6502_MEM_LEN, true, nAddressStart, nAddressEnd, MEM_SEARCH_BANK_NONE );
+
+	// Main, Aux, RamWorks
+	const BYTE *pBank;
+	for (UINT nBank = 0; (pBank = MemGetBankPtr( nBank )) != NULL; nBank++)
+		nFound += _SearchMemoryBlock( pattern, pBank, 0, _6502_MEM_LEN, false, nAddressStart, nAddressEnd, MEM_SEARCH_BANK_RAM + nBank );
+
+	// Language Card / Saturn (II, II+)
+	LanguageCardUnit *pLC = GetLanguageCard();
+	if (pLC)
+	{
+		for (UINT nBank = 0; nBank < pLC->GetNumBanks(); nBank++)
+		{
+			if ((pBank = pLC->GetBankMemory( nBank )) != NULL)
+				nFound += _SearchMemoryBlock( pattern, pBank, 0xC000, LanguageCardSlot0::kMemBankSize, false, nAddressStart, nAddressEnd, MEM_SEARCH_BANK_LC + nBank );
 		}
 	}
 
@@ -5315,7 +5851,8 @@ Update_t _SearchMemoryDisplay (int nArgs)
 		int iFound = 1;
 		while (iFound <= nFound)
 		{
-			WORD nAddress = g_vMemorySearchResults.at( iFound );
+			WORD nAddress = g_vMemorySearchResults.at( iFound ) & MEM_SEARCH_BANK_MASK;
+			int  nBank    = g_vMemorySearchResults.at( iFound ) >> MEM_SEARCH_BANK_SHIFT;
 
 //			sprintf( sText, "%2d:$%04X ", iFound, nAddress );
 //			int nLen = _tcslen( sText );
@@ -5330,6 +5867,19 @@ Update_t _SearchMemoryDisplay (int nArgs)
 			        StringCat( sResult, CHC_DEFAULT, nBuf ); // intentional default instead of CHC_ARG_SEP for better readability
 			nLen += StringCat( sResult, ":" , nBuf );
 
+			if (nBank != MEM_SEARCH_BANK_NONE)
+			{
+				        StringCat( sResult, CHC_NUM_HEX, nBuf );
+				if (nBank >= MEM_SEARCH_BANK_LC)
+					sprintf( sText, "L%X", nBank - MEM_SEARCH_BANK_LC );
+				else
+					sprintf( sText, "R%02X", nBank - MEM_SEARCH_BANK_RAM );
+				nLen += StringCat( sResult, sText, nBuf );
+
+				        StringCat( sResult, CHC_DEFAULT, nBuf );
+				nLen += StringCat( sResult, ":" , nBuf );
+			}
+
 			        StringCat( sResult, CHC_ARG_SEP, nBuf );
 			nLen += StringCat( sResult, "$" , nBuf ); // 2.6.2.16 Fixed: Search Results: The hex specify for target address results now colorized properly
 
@@ -5393,7 +5943,7 @@ Update_t _SearchMemoryDisplay (int nArgs)
 
 
 //===========================================================================
-Update_t _CmdMemorySearch (int nArgs, bool bTextIsAscii = true )
+Update_t _CmdMemorySearch (int nArgs, bool bTextIsAscii = true, bool bAllBanks = false )
 {
 	WORD nAddressStart = 0;
 	WORD nAddress2   = 0;
@@ -5545,7 +6095,7 @@ Update_t _CmdMemorySearch (int nArgs, bool bTextIsAscii = true )
 		tLastType = ms.m_iType;
 	}
 
-	_SearchMemoryFind( vMemorySearchValues, nAddressStart, nAddressEnd );
+	_SearchMemoryFind( vMemorySearchValues, nAddressStart, nAddressEnd, bAllBanks );
 	vMemorySearchValues.erase( vMemorySearchValues.begin(), vMemorySearchValues.end() );
 
 	return _SearchMemoryDisplay();
@@ -5594,6 +6144,16 @@ Update_t CmdMemorySearchHex (int nArgs)
 	return _CmdMemorySearch( nArgs, true );
 }
 
+// Search main, aux, RamWorks and Language Card banks
+//===========================================================================
+Update_t CmdMemorySearchAll (int nArgs)
+{
+	if (nArgs < 4)
+		return HelpLastCommand();
+
+	return _CmdMemorySearch( nArgs, true, true );
+}
+
 
 // Registers ______________________________________________________________________________________
 
@@ -6208,6 +6768,7 @@ bool ParseAssemblyListing( bool bBytesToMemory, bool bAddSymbols )
 						char *pAddressEnd;
 						nAddress = (DWORD) strtol( pAddress, &pAddressEnd, 16 );
 						g_aSymbols[ SYMBOLS_SRC_2 ][ (WORD) nAddress] = sName;
+						SymbolsLookupInvalidate();
 						g_nSourceAssemblySymbols++;
 					}
 				}
@@ -7583,6 +8144,8 @@ Update_t ExecuteCommand (int nArgs)
 		bool bCook = true;
 		if (g_iCommand == CMD_OUTPUT_ECHO)
 			bCook = false;
+		if (g_iCommand == CMD_BREAKPOINT_IF) // expression is compiled from the raw input
+			bCook = false;
 
 		int nArgsCooked = nArgs;
 		if (bCook)
@@ -8113,13 +8676,13 @@ void DebugBegin ()
 //===========================================================================
 void DebugExitDebugger ()
 {
-	if (g_nBreakpoints == 0 && g_hTraceFile == NULL)
+	if (g_nBreakpoints == 0 && g_hTraceFile == NULL && !g_DebugTrace.bEnabled && !g_DebugHistory.bEnabled && !g_DebugCallProfile.bEnabled && !g_DebugCoverage.bEnabled && !g_DebugIoStats.bEnabled && !g_DebugCycleAudit.bEnabled)
 	{
 		DebugEnd();
 		return;
 	}
 
-	// Still have some BPs set or tracing to file, so continue single-stepping
+	// Still have some BPs set, tracing to file, recording history, profiling calls, coverage, I/O statistics or cycle audit, so continue single-stepping
 
 	if (!g_bLastGoCmdWasFullSpeed)
 		CmdGoNormalSpeed(0);
@@ -8148,6 +8711,7 @@ static void CheckBreakOpcode( int iOpcode )
 void DebugContinueStepping(const bool bCallerWillUpdateDisplay/*=false*/)
 {
 	static bool bForceSingleStepNext = false; // Allow at least one instruction to execute so we don't trigger on the same invalid opcode
+	char sStopReason[ CONSOLE_WIDTH ] = ""; // Breakpoint hit, for the debugger server once in MODE_DEBUG
 
 	if (g_nDebugSkipLen > 0)
 	{
@@ -8206,10 +8770,19 @@ void DebugContinueStepping(const bool bCallerWillUpdateDisplay/*=false*/)
 
 		if (bDoSingleStep)
 		{
+			// Run a whole execution period if the CPU core can trap all breakpoints, else just one opcode
+			g_BreakpointTraps.bArmed = BreakpointTrapsCanRun();
+
+			// The 1st opcode: the CPU core always executes it, and doesn't trap its pointer or stack accesses, see BreakpointTrapsBuild()
+			CheckBreakpointsIO();
+			g_BreakpointTraps.bHit = g_bBreakpointMemAccessed;	// Then the core stops after it
+
 			SingleStep(g_bGoCmd_ReinitFlag);
 			g_bGoCmd_ReinitFlag = false;
+			g_BreakpointTraps.bArmed = false;
 
-			g_bDebugBreakpointHit |= CheckBreakpointsIO() | CheckBreakpointsReg();
+			// Memory breakpoints stop after the opcode that accessed memory, trapped or not
+			g_bDebugBreakpointHit |= CheckBreakpointsMem() | CheckBreakpointsReg();
 		}
 
 		if (regs.pc == g_nDebugStepUntil || g_bDebugBreakpointHit)
@@ -8239,6 +8812,7 @@ void DebugContinueStepping(const bool bCallerWillUpdateDisplay/*=false*/)
 
 			ConsoleBufferPushFormat( sText, TEXT("Stop reason: %s"), pszStopReason );
 			ConsoleUpdate();
+			strcpy( sStopReason, pszStopReason );
 
 			g_nDebugSteps = 0;
 		}
@@ -8261,6 +8835,11 @@ void DebugContinueStepping(const bool bCallerWillUpdateDisplay/*=false*/)
 
 		if (!bCallerWillUpdateDisplay)
 			UpdateDisplay( UPDATE_ALL );
+
+		if (sStopReason[0])
+			DebuggerServerEvent( "break", sStopReason );
+
+		GdbStubStopped( g_bDebugBreakpointHit, g_uBreakMemoryAddress );
 	}
 }
 
@@ -8279,6 +8858,8 @@ void DebugStopStepping(void)
 //===========================================================================
 void DebugDestroy ()
 {
+	DebuggerServerStop();
+	GdbStubStop();
 	DebugEnd();
 	FontsDestroy();
 
@@ -8314,6 +8895,13 @@ static void DebugEnd ()
 		g_hTraceFile = NULL;
 	}
 
+	DebugTraceStop();
+	HistoryReset();	// Running without the debug CPU core, so history would be inconsistent
+	CallProfileStop();
+	CoverageStop();
+	IoStatsStop();
+	CycleAuditStop();
+
 	g_vMemorySearchResults.erase( g_vMemorySearchResults.begin(), g_vMemorySearchResults.end() );
 
 	g_nAppMode = MODE_RUNNING;
@@ -8367,6 +8955,7 @@ void DebugInitialize ()
 
 	// CLEAR THE BREAKPOINT AND WATCH TABLES
 	memset( g_aBreakpoints     , 0, MAX_BREAKPOINTS       * sizeof(Breakpoint_t));
+	memset( g_aBreakpointConditions, 0, MAX_BREAKPOINTS   * sizeof(BreakpointCondition_t));
 	memset( g_aWatches         , 0, MAX_WATCHES           * sizeof(Watches_t) );
 	memset( g_aZeroPagePointers, 0, MAX_ZEROPAGE_POINTERS * sizeof(ZeroPagePointers_t));
 
@@ -8619,6 +9208,27 @@ Update_t DebuggerProcessCommand ( const bool bEchoConsoleInput )
 	return bUpdateDisplay;
 }
 
+// Execute a command that didn't come from the console input line, eg. from the debugger server
+// All output is flushed to the console, since there's no user to un-pause it
+//===========================================================================
+void DebuggerProcessCommandText ( const char *pText )
+{
+	ConsoleInputReset();
+
+	const int nLen = MIN( (int) strlen( pText ), CONSOLE_WIDTH - 2 );
+	memcpy( g_pConsoleInput, pText, nLen );
+	g_pConsoleInput[ nLen ] = 0;
+	g_nConsoleInputChars = nLen;
+
+	Update_t bUpdateDisplay = DebuggerProcessCommand( false );
+
+	ConsoleFlush();
+	ConsoleInputReset();
+
+	if (!DebugVideoMode::Instance().IsSet())
+		UpdateDisplay( bUpdateDisplay | UPDATE_CONSOLE_DISPLAY | UPDATE_CONSOLE_INPUT );
+}
+
 void ToggleFullScreenConsole()
 {
 	// Switch to Console Window
@@ -9031,6 +9641,8 @@ void DebugDisplay( BOOL bInitDisasm/*=FALSE*/ )
 //===========================================================================
 void DebuggerUpdate()
 {
+	DebuggerServerUpdate();	// Commands that were waiting for the debugger to stop
+	GdbStubUpdate();
 	DebuggerCursorUpdate();
 }
 
@@ -13,6 +13,16 @@
 #include "Debugger_Help.h"
 #include "Debugger_Display.h"
 #include "Debugger_Symbols.h"
+#include "Debugger_Traps.h"
+#include "Debugger_Trace.h"
+#include "Debugger_History.h"
+#include "Debugger_CallProfile.h"
+#include "Debugger_Condition.h"
+#include "Debugger_Coverage.h"
+#include "Debugger_CycleAudit.h"
+#include "Debugger_IOStats.h"
+#include "Debugger_Server.h"
+#include "Debugger_GdbStub.h"
 #include "Util_MemoryTextFile.h"
 
 // Globals __________________________________________________________________
@@ -143,10 +153,13 @@
 	int Bookmark_Find( const WORD nAddress );
 
 // Breakpoints
-	int CheckBreakpointsIO ();
-	int CheckBreakpointsReg ();
+	void CheckBreakpointsIO ();
+	int  CheckBreakpointsMem ();
+	int  CheckBreakpointsReg ();
 
 	bool GetBreakpointInfo ( WORD nOffset, bool & bBreakpointActive_, bool & bBreakpointEnable_ );
+	int  BreakpointAdd    ( BreakpointSource_t iSrc, WORD nAddress, int nLen );
+	bool BreakpointRemove ( BreakpointSource_t iSrc, WORD nAddress, int nLen );
 
 // Source Level Debugging
 	int FindSourceLine( WORD nAddress );
@@ -157,6 +170,7 @@
 
 // Main
 	Update_t DebuggerProcessCommand( const bool bEchoConsoleInput );
+	void    DebuggerProcessCommandText( const char *pText );
 
 // Prototypes _______________________________________________________________
 
@@ -0,0 +1,413 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Debugger Call Profile (per routine call counts and cycles)
+ *
+ * Author: Various
+ */
+
+#include "StdAfx.h"
+
+#include "Debug.h"
+
+#include "../Core.h"
+#include "../CPU.h"
+#include "../Memory.h"
+
+// Call Profile ___________________________________________________________________________________
+
+	DebugCallProfile_t g_DebugCallProfile;
+
+	static const char g_sFileNameCallProfile[] = "CallProfile.txt";
+
+	enum
+	{
+		SP_DELTA_UNKNOWN = 0x7F,
+
+		CALL_PROFILE_LIST_LINES = 20,
+	};
+
+	// Change to SP by the opcode
+	static signed char g_aCallProfileSPDelta[ NUM_OPCODES ];
+
+
+// Recording ______________________________________________________________________________________
+
+//===========================================================================
+static void _CallProfileInitSPDelta ()
+{
+	memset( g_aCallProfileSPDelta, 0, sizeof( g_aCallProfileSPDelta ) );
+
+	g_aCallProfileSPDelta[ OPCODE_BRK ] = -3;
+	g_aCallProfileSPDelta[ OPCODE_JSR ] = -2;
+	g_aCallProfileSPDelta[ 0x08       ] = -1; // PHP
+	g_aCallProfileSPDelta[ 0x48       ] = -1; // PHA
+	g_aCallProfileSPDelta[ 0x5A       ] = -1; // PHY
+	g_aCallProfileSPDelta[ 0xDA       ] = -1; // PHX
+	g_aCallProfileSPDelta[ 0x28       ] = +1; // PLP
+	g_aCallProfileSPDelta[ 0x68       ] = +1; // PLA
+	g_aCallProfileSPDelta[ 0x7A       ] = +1; // PLY
+	g_aCallProfileSPDelta[ 0xFA       ] = +1; // PLX
+	g_aCallProfileSPDelta[ OPCODE_RTS ] = +2;
+	g_aCallProfileSPDelta[ OPCODE_RTI ] = +3;
+	g_aCallProfileSPDelta[ OPCODE_TXS ] = SP_DELTA_UNKNOWN;
+
+	if (GetMainCpu() == CPU_6502) // PHX, PHY, PLX, PLY are NOPs
+	{
+		g_aCallProfileSPDelta[ 0x5A ] = 0;
+		g_aCallProfileSPDelta[ 0xDA ] = 0;
+		g_aCallProfileSPDelta[ 0x7A ] = 0;
+		g_aCallProfileSPDelta[ 0xFA ] = 0;
+	}
+}
+
+//===========================================================================
+static void _CallProfileReset ()
+{
+	if (!g_DebugCallProfile.pRoutines)
+		g_DebugCallProfile.pRoutines = new CallProfileRoutine_t[ _6502_MEM_LEN ];
+
+	_CallProfileInitSPDelta();
+
+	memset( g_DebugCallProfile.pRoutines, 0, sizeof(CallProfileRoutine_t) * _6502_MEM_LEN );
+
+	g_DebugCallProfile.bPrevValid  = false;
+	g_DebugCallProfile.nDepth      = 0;
+	g_DebugCallProfile.nCycleStart = g_nCumulativeCycles;
+	g_DebugCallProfile.nCycleLast  = g_nCumulativeCycles;
+	g_DebugCallProfile.nCyclesRoot = 0;
+}
+
+//===========================================================================
+static void _CallProfilePop ( const uint64_t nCycles )
+{
+	const CallProfileFrame_t & frame = g_DebugCallProfile.aFrames[ --g_DebugCallProfile.nDepth ];
+	CallProfileRoutine_t & routine = g_DebugCallProfile.pRoutines[ frame.nAddress ];
+
+	if (--routine.nActive == 0) // outermost activation
+		routine.nInclusive += nCycles - frame.nCycleEnter;
+}
+
+// Pop frames that have been returned from, ie. SP is now above the frame's return address
+//===========================================================================
+static void _CallProfileUnwind ( const BYTE nSP, const uint64_t nCycles, const bool bPush )
+{
+	while (g_DebugCallProfile.nDepth)
+	{
+		const BYTE nFrameSP = g_DebugCallProfile.aFrames[ g_DebugCallProfile.nDepth - 1 ].nSP;
+
+		// A new frame must be below (deeper than) its caller's, so a frame at the same SP is stale
+		if ((nFrameSP > nSP) || (!bPush && nFrameSP == nSP))
+			break;
+
+		_CallProfilePop( nCycles );
+	}
+}
+
+//===========================================================================
+static void _CallProfilePush ( const WORD nAddress, const BYTE nSP, const uint64_t nCycles, const bool bInterrupt )
+{
+	_CallProfileUnwind( nSP, nCycles, true );
+
+	if (g_DebugCallProfile.nDepth == CALL_PROFILE_MAX_DEPTH)
+	{
+		// Runaway recursion or a stack switch: drop the oldest frame
+		const CallProfileFrame_t & oldest = g_DebugCallProfile.aFrames[ 0 ];
+		CallProfileRoutine_t & routine = g_DebugCallProfile.pRoutines[ oldest.nAddress ];
+		if (--routine.nActive == 0)
+			routine.nInclusive += nCycles - oldest.nCycleEnter;
+
+		memmove( &g_DebugCallProfile.aFrames[0], &g_DebugCallProfile.aFrames[1], sizeof(CallProfileFrame_t) * (CALL_PROFILE_MAX_DEPTH - 1) );
+		g_DebugCallProfile.nDepth--;
+	}
+
+	CallProfileFrame_t & frame = g_DebugCallProfile.aFrames[ g_DebugCallProfile.nDepth++ ];
+	frame.nAddress    = nAddress;
+	frame.nSP         = nSP;
+	frame.nCycleEnter = nCycles;
+
+	CallProfileRoutine_t & routine = g_DebugCallProfile.pRoutines[ nAddress ];
+	routine.nCalls++;
+	routine.nActive++;
+	if (bInterrupt)
+		routine.bInterrupt = true;
+}
+
+// Called by the debug CPU core before the opcode at nPC is executed
+//===========================================================================
+void CallProfileStep ( WORD nPC, BYTE nSP, uint64_t nCycles )
+{
+	// The previous opcode's cycles belong to the routine it was executed in
+	const uint64_t nDelta = nCycles - g_DebugCallProfile.nCycleLast;
+	g_DebugCallProfile.nCycleLast = nCycles;
+
+	if (g_DebugCallProfile.nDepth)
+		g_DebugCallProfile.pRoutines[ g_DebugCallProfile.aFrames[ g_DebugCallProfile.nDepth - 1 ].nAddress ].nExclusive += nDelta;
+	else
+		g_DebugCallProfile.nCyclesRoot += nDelta;
+
+	if (g_DebugCallProfile.bPrevValid)
+	{
+		const BYTE nOpcode   = g_DebugCallProfile.nOpcodePrev;
+		const int  nExpected = g_aCallProfileSPDelta[ nOpcode ];
+		const int  nSPDelta  = (signed char)(nSP - g_DebugCallProfile.nSPPrev);
+
+		if ((nExpected != SP_DELTA_UNKNOWN) && (nSPDelta == nExpected - 3))
+		{
+			// IRQ/NMI was taken after the previous opcode
+			if (nOpcode == OPCODE_JSR)
+				_CallProfilePush( g_DebugCallProfile.nTargetPrev, (BYTE)(nSP + 3), nCycles, false );
+
+			_CallProfilePush( nPC, nSP, nCycles, true );
+		}
+		else
+		if (nOpcode == OPCODE_JSR)
+		{
+			_CallProfilePush( nPC, nSP, nCycles, false );
+		}
+		else
+		if (nOpcode == OPCODE_BRK)
+		{
+			_CallProfilePush( nPC, nSP, nCycles, true );
+		}
+		else
+		if ((nOpcode == OPCODE_RTS   ) || (nOpcode == OPCODE_RTI    ) || (nOpcode == OPCODE_TXS    )
+		||  (nOpcode == OPCODE_JMP_A ) || (nOpcode == OPCODE_JMP_NA ) || (nOpcode == OPCODE_JMP_IAX))
+		{
+			// Only unwind on a transfer of control, so PLA PLA ... PHA PHA RTS doesn't pop the frame early
+			_CallProfileUnwind( nSP, nCycles, false );
+		}
+	}
+
+	const BYTE nOpcode = *(mem + nPC);
+	g_DebugCallProfile.nOpcodePrev = nOpcode;
+	g_DebugCallProfile.nSPPrev     = nSP;
+	g_DebugCallProfile.bPrevValid  = true;
+
+	if (nOpcode == OPCODE_JSR)
+		g_DebugCallProfile.nTargetPrev = *(mem + ((nPC + 1) & 0xFFFF)) | (*(mem + ((nPC + 2) & 0xFFFF)) << 8);
+}
+
+//===========================================================================
+static void CallProfileStart ()
+{
+	_CallProfileReset();
+	g_DebugCallProfile.bEnabled = true;
+}
+
+// Keeps the profile, so it can still be listed or saved
+//===========================================================================
+void CallProfileStop ()
+{
+	if (!g_DebugCallProfile.bEnabled)
+		return;
+
+	g_DebugCallProfile.bEnabled = false;
+
+	while (g_DebugCallProfile.nDepth)
+		_CallProfilePop( g_DebugCallProfile.nCycleLast );
+}
+
+
+// Reporting ______________________________________________________________________________________
+
+	struct CallProfileLine_t
+	{
+		WORD                 nAddress;
+		CallProfileRoutine_t routine ;
+	};
+
+//===========================================================================
+static bool _CallProfileCompareInclusive ( const CallProfileLine_t & line1, const CallProfileLine_t & line2 )
+{
+	return line1.routine.nInclusive > line2.routine.nInclusive;
+}
+
+// Returns routines by descending inclusive cycles, including calls that haven't returned yet
+//===========================================================================
+static void _CallProfileSort ( std::vector<CallProfileLine_t> & vRoutines_ )
+{
+	vRoutines_.clear();
+
+	CallProfileLine_t line;
+	for (UINT nAddress = 0; nAddress < _6502_MEM_LEN; nAddress++)
+	{
+		line.nAddress = (WORD) nAddress;
+		line.routine  = g_DebugCallProfile.pRoutines[ nAddress ];
+
+		if (!line.routine.nCalls)
+			continue;
+
+		if (line.routine.nActive)
+		{
+			// Outermost open frame
+			for (UINT iFrame = 0; iFrame < g_DebugCallProfile.nDepth; iFrame++)
+			{
+				const CallProfileFrame_t & frame = g_DebugCallProfile.aFrames[ iFrame ];
+				if (frame.nAddress == nAddress)
+				{
+					line.routine.nInclusive += g_DebugCallProfile.nCycleLast - frame.nCycleEnter;
+					break;
+				}
+			}
+		}
+
+		vRoutines_.push_back( line );
+	}
+
+	std::sort( vRoutines_.begin(), vRoutines_.end(), _CallProfileCompareInclusive );
+}
+
+//===========================================================================
+static void _CallProfileFormat ( std::vector<std::string> & vLines_, const bool bExport, const UINT nMaxLines )
+{
+	vLines_.clear();
+
+	std::vector<CallProfileLine_t> vRoutines;
+	_CallProfileSort( vRoutines );
+
+	const uint64_t nTotal = g_DebugCallProfile.nCycleLast - g_DebugCallProfile.nCycleStart;
+	const double   fTotal = nTotal ? (double) nTotal : 1.0;
+
+	char sLine[ CONSOLE_WIDTH * 2 ];
+
+	if (bExport)
+		sprintf( sLine, "Address\tSymbol\tCalls\tInclusive\t%%\tExclusive\t%%\tType" );
+	else
+		sprintf( sLine, " Addr  Symbol           Calls  Inclusive    %%   Exclusive    %%" );
+	vLines_.push_back( sLine );
+
+	for (UINT iRoutine = 0; iRoutine < vRoutines.size() && iRoutine < nMaxLines; iRoutine++)
+	{
+		const WORD                   nAddress = vRoutines[ iRoutine ].nAddress;
+		const CallProfileRoutine_t & routine  = vRoutines[ iRoutine ].routine;
+
+		const char *pSymbol = FindSymbolFromAddress( nAddress );
+		if (!pSymbol)
+			pSymbol = "";
+
+		if (bExport)
+		{
+			sprintf( sLine, "$%04X\t%s\t%u\t%u\t%.2f\t%u\t%.2f\t%s"
+				, nAddress, pSymbol, routine.nCalls
+				, (UINT) routine.nInclusive, 100.0 * routine.nInclusive / fTotal
+				, (UINT) routine.nExclusive, 100.0 * routine.nExclusive / fTotal
+				, routine.bInterrupt ? "INT" : "JSR"
+			);
+		}
+		else
+		{
+			sprintf( sLine, " %04X %c%-16.16s %6u %10u %5.1f %10u %5.1f"
+				, nAddress, routine.bInterrupt ? '*' : ' ', pSymbol, routine.nCalls
+				, (UINT) routine.nInclusive, 100.0 * routine.nInclusive / fTotal
+				, (UINT) routine.nExclusive, 100.0 * routine.nExclusive / fTotal
+			);
+		}
+		vLines_.push_back( sLine );
+	}
+
+	sprintf( sLine, bExport ? "Total\t\t\t%u\t\tOutside calls\t%u"
+	                        : " Total: %u cycles, %u outside any call.  * = IRQ/NMI/BRK"
+		, (UINT) nTotal, (UINT) g_DebugCallProfile.nCyclesRoot );
+	vLines_.push_back( sLine );
+}
+
+//===========================================================================
+static bool _CallProfileSave ()
+{
+	const std::string sFileName = g_sProgramDir + g_sFileNameCallProfile;
+
+	FILE *hFile = fopen( sFileName.c_str(), "wt" );
+	if (!hFile)
+		return false;
+
+	std::vector<std::string> vLines;
+	_CallProfileFormat( vLines, true, _6502_MEM_LEN );
+
+	for (size_t iLine = 0; iLine < vLines.size(); iLine++)
+		fprintf( hFile, "%s\n", vLines[ iLine ].c_str() );
+
+	fclose( hFile );
+	return true;
+}
+
+
+// Commands _______________________________________________________________________________________
+
+// PROFILE CALLS [ON | OFF | RESET | LIST | SAVE]
+// Pre: g_aArgs[1] is CALLS
+//===========================================================================
+Update_t CmdProfileCalls (int nArgs)
+{
+	char sText[ CONSOLE_WIDTH ];
+
+	int iParam = PARAM_LIST;
+	if (nArgs >= 2)
+	{
+		int nFound = FindParam( g_aArgs[ 2 ].sArg, MATCH_EXACT, iParam, _PARAM_GENERAL_BEGIN, _PARAM_GENERAL_END );
+		if (!nFound || (nArgs > 2))
+			return Help_Arg_1( CMD_PROFILE );
+	}
+
+	switch (iParam)
+	{
+		case PARAM_ON:
+		case PARAM_RESET:
+			CallProfileStart();
+			ConsoleBufferPush( " Call profile started." );
+			break;
+
+		case PARAM_OFF:
+			CallProfileStop();
+			ConsoleBufferPush( " Call profile stopped." );
+			break;
+
+		case PARAM_LIST:
+		{
+			if (!g_DebugCallProfile.pRoutines)
+			{
+				ConsoleBufferPush( " No call profile. See: PROFILE CALLS ON" );
+				break;
+			}
+
+			std::vector<std::string> vLines;
+			_CallProfileFormat( vLines, false, CALL_PROFILE_LIST_LINES );
+
+			for (size_t iLine = 0; iLine < vLines.size(); iLine++)
+				ConsolePrint( vLines[ iLine ].c_str() );
+			break;
+		}
+
+		case PARAM_SAVE:
+			if (g_DebugCallProfile.pRoutines && _CallProfileSave())
+				ConsoleBufferPushFormat( sText, " Saved: %s", g_sFileNameCallProfile );
+			else
+				ConsoleBufferPush( " ERROR: Couldn't save file. (In use?)" );
+			break;
+
+		default:
+			return Help_Arg_1( CMD_PROFILE );
+	}
+
+	return ConsoleUpdate();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+// Call Profile ___________________________________________________________________________________
+
+	// The debug CPU core (Cpu6502_debug, Cpu65C02_debug) calls CallProfileStep() before each opcode is executed,
+	// see CallProfile_X() in cpu_heatmap.inl
+	// Calls (JSR, BRK, IRQ/NMI) push a frame onto a shadow call stack, keyed by the routine's entry address.
+	// Frames are popped by comparing SP, not by matching RTS/RTI, so routines that pull their return address
+	// (inline parameters), or code that resets the stack with TXS, don't leave stale frames.
+	enum
+	{
+		CALL_PROFILE_MAX_DEPTH = 256,
+	};
+
+	struct CallProfileRoutine_t
+	{
+		uint32_t nCalls     ;
+		uint32_t nActive    ; // frames on the shadow stack, so recursion isn't counted twice in nInclusive
+		uint64_t nInclusive ; // cycles
+		uint64_t nExclusive ; // cycles
+		bool     bInterrupt ; // entered via IRQ/NMI/BRK
+	};
+
+	struct CallProfileFrame_t
+	{
+		WORD     nAddress   ; // routine
+		BYTE     nSP        ; // SP on entry, after the return address was pushed
+		uint64_t nCycleEnter;
+	};
+
+	struct DebugCallProfile_t
+	{
+		bool                  bEnabled   ;
+		bool                  bPrevValid ; // nOpcodePrev, nSPPrev, etc. are from the previous opcode
+		BYTE                  nOpcodePrev;
+		BYTE                  nSPPrev    ;
+		WORD                  nTargetPrev; // JSR operand
+		UINT                  nDepth     ;
+		uint64_t              nCycleStart;
+		uint64_t              nCycleLast ;
+		uint64_t              nCyclesRoot; // exclusive cycles outside any call
+		CallProfileFrame_t    aFrames[ CALL_PROFILE_MAX_DEPTH ];
+		CallProfileRoutine_t *pRoutines  ; // [_6502_MEM_LEN]
+	};
+
+	extern DebugCallProfile_t g_DebugCallProfile;
+
+	void CallProfileStep ( WORD nPC, BYTE nSP, uint64_t nCycles );
+	void CallProfileStop ();
@@ -47,13 +47,18 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		{TEXT("=")           , CmdCursorSetPC       , CMD_CURSOR_SET_PC        , "Sets the PC to the current instruction" },
 		{TEXT("G")           , CmdGoNormalSpeed     , CMD_GO_NORMAL_SPEED      , "Run at normal speed [until PC == address]"   },
 		{TEXT("GG")          , CmdGoFullSpeed       , CMD_GO_FULL_SPEED        , "Run at full speed [until PC == address]"   },
+		{TEXT("GR")          , CmdGoReverse         , CMD_GO_REVERSE           , "Run backwards until breakpoint"   },
 		{TEXT("IN")          , CmdIn                , CMD_IN                   , "Input byte from IO $C0xx"   },
 		{TEXT("KEY")         , CmdKey               , CMD_INPUT_KEY            , "Feed key into emulator"     },
 		{TEXT("JSR")         , CmdJSR               , CMD_JSR                  , "Call sub-routine"           },
 		{TEXT("NOP")         , CmdNOP               , CMD_NOP                  , "Zap the current instruction with a NOP" },
 		{TEXT("OUT")         , CmdOut               , CMD_OUT                  , "Output byte to IO $C0xx"    },
 	// CPU - Meta Info
+		{TEXT("HISTORY")     , CmdHistory           , CMD_HISTORY              , "Record execution history for reverse stepping" },
 		{TEXT("PROFILE")     , CmdProfile           , CMD_PROFILE              , "List/Save 6502 profiling" },
+		{TEXT("COVERAGE")    , CmdCoverage          , CMD_COVERAGE             , "Record code coverage" },
+		{TEXT("IOSTATS")     , CmdIoStats           , CMD_IOSTATS              , "Count I/O soft switch accesses" },
+		{TEXT("CYCLEAUDIT")  , CmdCycleAudit        , CMD_CYCLEAUDIT           , "Check cycles charged per opcode" },
 		{TEXT("R")           , CmdRegisterSet       , CMD_REGISTER_SET         , "Set register" },
 	// CPU - Stack
 		{TEXT("POP")         , CmdStackPop          , CMD_STACK_POP            },
@@ -64,8 +69,12 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		{TEXT("RTS")         , CmdStepOut           , CMD_STEP_OUT             , "Step out of subroutine"     }, 
 	// CPU - Meta Info
 		{TEXT("T")           , CmdTrace             , CMD_TRACE                , "Trace current instruction"  },
+		{TEXT("TB")          , CmdTraceBuffer       , CMD_TRACE_BUFFER         , "Trace to memory ring buffer [with video scanner info]" },
 		{TEXT("TF")          , CmdTraceFile         , CMD_TRACE_FILE           , "Save trace to filename [with video scanner info]" },
+		{TEXT("TFB")         , CmdTraceFileBinary   , CMD_TRACE_FILE_BINARY    , "Save binary trace to filename [with video scanner info]" },
+		{TEXT("TFD")         , CmdTraceFileDecode   , CMD_TRACE_FILE_DECODE    , "Decode binary trace (or ring buffer) to text file" },
 		{TEXT("TL")          , CmdTraceLine         , CMD_TRACE_LINE           , "Trace (with cycle counting)" },
+		{TEXT("TR")          , CmdTraceReverse      , CMD_TRACE_REVERSE        , "Trace backwards # instructions" },
 		{TEXT("U")           , CmdUnassemble        , CMD_UNASSEMBLE           , "Disassemble instructions"   },
 //		{TEXT("WAIT")        , CmdWait              , CMD_WAIT                 , "Run until
 	// Bookmarks
@@ -85,6 +94,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		{TEXT("BPR")         , CmdBreakpointAddReg  , CMD_BREAKPOINT_ADD_REG   , "Add breakpoint on register value"      }, // NOTE! Different from SoftICE !!!!
 		{TEXT("BPX")         , CmdBreakpointAddPC   , CMD_BREAKPOINT_ADD_PC    , "Add breakpoint at current instruction" },
 		{TEXT("BPIO")        , CmdBreakpointAddIO   , CMD_BREAKPOINT_ADD_IO    , "Add breakpoint for IO address $C0xx"   },
+		{TEXT("BPIF")        , CmdBreakpointIf      , CMD_BREAKPOINT_IF        , "Set breakpoint condition"              },
 		{TEXT("BPM")         , CmdBreakpointAddMemA , CMD_BREAKPOINT_ADD_MEM   , "Add breakpoint on memory access"       },  // SoftICE
 		{TEXT("BPMR")        , CmdBreakpointAddMemR , CMD_BREAKPOINT_ADD_MEMR  , "Add breakpoint on memory read access"  },
 		{TEXT("BPMW")        , CmdBreakpointAddMemW , CMD_BREAKPOINT_ADD_MEMW  , "Add breakpoint on memory write access" },
@@ -206,6 +216,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //		{TEXT("SA")          , CmdMemorySearchAscii,  CMD_MEMORY_SEARCH_ASCII  , "Search ASCII text"            },
 //		{TEXT("ST")          , CmdMemorySearchApple , CMD_MEMORY_SEARCH_APPLE  , "Search Apple text (hi-bit)"   },
 		{TEXT("SH")          , CmdMemorySearchHex   , CMD_MEMORY_SEARCH_HEX    , "Search memory for hex values" },
+		{TEXT("SALL")        , CmdMemorySearchAll   , CMD_MEMORY_SEARCH_ALL    , "Search all memory banks for text / hex values" },
 		{TEXT("F")           , CmdMemoryFill        , CMD_MEMORY_FILL          , "Memory fill"                  },
 
 		{TEXT("NTSC")        , CmdNTSC              , CMD_NTSC                 , "Save/Load the NTSC palette"   },
@@ -443,6 +454,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 // General
 		{TEXT("FIND")       , NULL, PARAM_FIND           },
 		{TEXT("BRANCH")     , NULL, PARAM_BRANCH         },
+		{TEXT("CALLS")      , NULL, PARAM_CALLS          }, // PROFILE CALLS
 		{"CATEGORY"         , NULL, PARAM_CATEGORY       },
 		{TEXT("CLEAR")      , NULL, PARAM_CLEAR          },
 		{TEXT("LOAD")       , NULL, PARAM_LOAD           },
@@ -0,0 +1,409 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Debugger Breakpoint Conditions (expression compiler and evaluator)
+ *
+ * Author: Various
+ */
+
+#include "StdAfx.h"
+
+#include "Debug.h"
+
+#include "../CPU.h"
+#include "../Memory.h"
+
+// Breakpoint Conditions __________________________________________________________________________
+
+	BreakpointCondition_t g_aBreakpointConditions[ MAX_BREAKPOINTS ];
+
+	// Same precedence as C/C++, higher binds tighter
+	// NOTE: 2 char operators must come before their 1 char prefix
+	struct ConditionOperator_t
+	{
+		const char *sName;
+		BYTE        eOp;
+		int         nPrecedence;
+	};
+
+	static const ConditionOperator_t g_aConditionOperators[] =
+	{
+		{ "||", COND_OP_LOR          ,  1 },
+		{ "&&", COND_OP_LAND         ,  2 },
+		{ "==", COND_OP_EQUAL        ,  6 },
+		{ "!=", COND_OP_NOT_EQUAL    ,  6 },
+		{ "<=", COND_OP_LESS_EQUAL   ,  7 },
+		{ ">=", COND_OP_GREATER_EQUAL,  7 },
+		{ "<<", COND_OP_SHL          ,  8 },
+		{ ">>", COND_OP_SHR          ,  8 },
+		{ "|" , COND_OP_OR           ,  3 },
+		{ "^" , COND_OP_XOR          ,  4 },
+		{ "&" , COND_OP_AND          ,  5 },
+		{ "=" , COND_OP_EQUAL        ,  6 }, // same as BPR
+		{ "<" , COND_OP_LESS_THAN    ,  7 },
+		{ ">" , COND_OP_GREATER_THAN ,  7 },
+		{ "+" , COND_OP_ADD          ,  9 },
+		{ "-" , COND_OP_SUB          ,  9 },
+		{ "*" , COND_OP_MUL          , 10 },
+		{ "/" , COND_OP_DIV          , 10 },
+		{ "%" , COND_OP_MOD          , 10 },
+	};
+
+	struct ConditionParser_t
+	{
+		const char            *pSrc      ;
+		const char            *pError    ;
+		BreakpointCondition_t *pCondition;
+		int                    nDepth    ; // stack depth at runtime
+		int                    nDepthMax ;
+	};
+
+	static bool _ConditionParseExpression ( ConditionParser_t & parser, int nMinPrecedence );
+
+
+//===========================================================================
+static bool _ConditionError ( ConditionParser_t & parser, const char *pError )
+{
+	if (! parser.pError)
+		parser.pError = pError;
+	return false;
+}
+
+// nPop/nPush: net effect of the op on the runtime stack
+//===========================================================================
+static bool _ConditionEmit ( ConditionParser_t & parser, BYTE eOp, DWORD nValue, int nPop, int nPush )
+{
+	BreakpointCondition_t *pCondition = parser.pCondition;
+
+	if (pCondition->nOps >= MAX_CONDITION_OPS)
+		return _ConditionError( parser, "Expression too long" );
+
+	parser.nDepth += nPush - nPop;
+	if (parser.nDepth > parser.nDepthMax)
+		parser.nDepthMax = parser.nDepth;
+
+	if (parser.nDepthMax > MAX_CONDITION_STACK)
+		return _ConditionError( parser, "Expression too complex" );
+
+	pCondition->aOps[ pCondition->nOps ].eOp    = eOp;
+	pCondition->aOps[ pCondition->nOps ].nValue = nValue;
+	pCondition->nOps++;
+	return true;
+}
+
+// "//" is a comment to end of line, same as the console
+//===========================================================================
+static char _ConditionPeek ( ConditionParser_t & parser )
+{
+	while ((*parser.pSrc == CHAR_SPACE) || (*parser.pSrc == CHAR_TAB))
+		parser.pSrc++;
+
+	if ((parser.pSrc[0] == '/') && (parser.pSrc[1] == '/'))
+		return 0;
+
+	return *parser.pSrc;
+}
+
+//===========================================================================
+static bool _ConditionIsNameChar ( char c )
+{
+	return isalnum( (unsigned char) c ) || (c == '_') || (c == '.');
+}
+
+// Registers, flags and keywords take precedence over symbols, which take precedence over hex numbers
+// $ skips registers and keywords, # is a hex value only: same as the console
+//===========================================================================
+static bool _ConditionParseName ( ConditionParser_t & parser, const bool bAddress, const bool bValue )
+{
+	char sName[ MAX_SYMBOLS_LEN+1 ];
+	int  nLen = 0;
+
+	while (_ConditionIsNameChar( *parser.pSrc ))
+	{
+		if (nLen < MAX_SYMBOLS_LEN)
+			sName[ nLen++ ] = *parser.pSrc;
+		parser.pSrc++;
+	}
+	sName[ nLen ] = 0;
+
+	if (! nLen)
+		return _ConditionError( parser, "Missing value" );
+
+	if (! bAddress && ! bValue)
+	{
+		char sUpper[ MAX_SYMBOLS_LEN+1 ];
+		strcpy( sUpper, sName );
+		_strupr( sUpper );
+
+		for (int iReg = BP_SRC_REG_A; iReg <= BP_SRC_REG_P; iReg++)
+			if (! strcmp( sUpper, g_aBreakpointSource[ iReg ] ))
+				return _ConditionEmit( parser, COND_OP_REG, iReg, 0, 1 );
+
+		for (int iFlag = BP_SRC_FLAG_C; iFlag <= BP_SRC_FLAG_N; iFlag++)
+			if (! strcmp( sUpper, g_aBreakpointSource[ iFlag ] ))
+				return _ConditionEmit( parser, COND_OP_FLAG, iFlag - BP_SRC_FLAG_C, 0, 1 );
+
+		if (! strcmp( sUpper, g_aBreakpointSource[ BP_SRC_OPCODE ] ))
+			return _ConditionEmit( parser, COND_OP_OPCODE, 0, 0, 1 );
+
+		if (! strcmp( sUpper, "CYCLES" ))
+			return _ConditionEmit( parser, COND_OP_CYCLES, 0, 0, 1 );
+
+		if (! strcmp( sUpper, "HITS" ))
+			return _ConditionEmit( parser, COND_OP_HITS, 0, 0, 1 );
+	}
+
+	if (! bValue)
+	{
+		WORD nAddress = 0;
+		if (FindAddressFromSymbol( sName, &nAddress ))
+			return _ConditionEmit( parser, COND_OP_CONST, nAddress, 0, 1 );
+	}
+
+	if (nLen > 8)
+		return _ConditionError( parser, "Value too large" );
+
+	for (int iChar = 0; iChar < nLen; iChar++)
+		if (! isxdigit( (unsigned char) sName[ iChar ] ))
+			return _ConditionError( parser, "Unknown symbol" );
+
+	return _ConditionEmit( parser, COND_OP_CONST, (DWORD) strtoul( sName, NULL, 16 ), 0, 1 );
+}
+
+//===========================================================================
+static bool _ConditionParseUnary ( ConditionParser_t & parser )
+{
+	const char c = _ConditionPeek( parser );
+
+	switch (c)
+	{
+		case '(':
+		case '[':
+		case '{':
+		{
+			parser.pSrc++;
+			if (! _ConditionParseExpression( parser, 0 ))
+				return false;
+
+			const char cClose = (c == '(') ? ')' : (c == '[') ? ']' : '}';
+			if (_ConditionPeek( parser ) != cClose)
+				return _ConditionError( parser, "Unbalanced brackets" );
+			parser.pSrc++;
+
+			if (c == '[')
+				return _ConditionEmit( parser, COND_OP_PEEK, 0, 1, 1 );
+			if (c == '{')
+				return _ConditionEmit( parser, COND_OP_PEEK_WORD, 0, 1, 1 );
+			return true;
+		}
+
+		case '-':
+		case '~':
+		case '!':
+			parser.pSrc++;
+			if (! _ConditionParseUnary( parser ))
+				return false;
+			return _ConditionEmit( parser, (c == '-') ? COND_OP_NEG : (c == '~') ? COND_OP_NOT : COND_OP_LNOT, 0, 1, 1 );
+
+		case '$':
+			parser.pSrc++;
+			return _ConditionParseName( parser, true, false );
+
+		case '#':
+			parser.pSrc++;
+			return _ConditionParseName( parser, false, true );
+
+		default:
+			if (_ConditionIsNameChar( c ))
+				return _ConditionParseName( parser, false, false );
+			break;
+	}
+
+	return _ConditionError( parser, "Missing value" );
+}
+
+// Precedence climbing, emits postfix
+//===========================================================================
+static bool _ConditionParseExpression ( ConditionParser_t & parser, int nMinPrecedence )
+{
+	if (! _ConditionParseUnary( parser ))
+		return false;
+
+	while (_ConditionPeek( parser ))
+	{
+		const ConditionOperator_t *pOperator = NULL;
+
+		for (int iOperator = 0; iOperator < sizeof(g_aConditionOperators) / sizeof(g_aConditionOperators[0]); iOperator++)
+		{
+			const char *sName = g_aConditionOperators[ iOperator ].sName;
+			if (! strncmp( parser.pSrc, sName, strlen( sName ) ))
+			{
+				pOperator = &g_aConditionOperators[ iOperator ];
+				break;
+			}
+		}
+
+		if (! pOperator || (pOperator->nPrecedence <= nMinPrecedence))
+			break;
+
+		parser.pSrc += strlen( pOperator->sName );
+
+		if (! _ConditionParseExpression( parser, pOperator->nPrecedence ))
+			return false;
+
+		if (! _ConditionEmit( parser, pOperator->eOp, 0, 2, 1 ))
+			return false;
+	}
+
+	return true;
+}
+
+// Returns false and sets pError_ on a syntax error, condition_ is then cleared
+// An empty expression clears the condition
+//===========================================================================
+bool ConditionCompile ( const char *pText, BreakpointCondition_t & condition_, const char* & pError_ )
+{
+	ConditionParser_t parser;
+	parser.pSrc       = pText;
+	parser.pError     = NULL;
+	parser.pCondition = &condition_;
+	parser.nDepth     = 0;
+	parser.nDepthMax  = 0;
+
+	condition_.nOps     = 0;
+	condition_.sText[0] = 0;
+
+	if (! _ConditionPeek( parser ))
+		return true;
+
+	bool bStatus = _ConditionParseExpression( parser, 0 );
+	if (bStatus && _ConditionPeek( parser ))
+		bStatus = _ConditionError( parser, (*parser.pSrc == ')' || *parser.pSrc == ']' || *parser.pSrc == '}')
+			? "Unbalanced brackets"
+			: "Unknown operator" );
+
+	if (! bStatus)
+	{
+		condition_.nOps = 0;
+		pError_ = parser.pError;
+		return false;
+	}
+
+	_ASSERT( parser.nDepth == 1 );
+
+	// Trim trailing white space and comment
+	int nLen = (int)(parser.pSrc - pText);
+	while (nLen && ((pText[ nLen-1 ] == CHAR_SPACE) || (pText[ nLen-1 ] == CHAR_TAB)))
+		nLen--;
+
+	nLen = MIN( nLen, MAX_CONDITION_TEXT );
+	strncpy( condition_.sText, pText, nLen );
+	condition_.sText[ nLen ] = 0;
+
+	return true;
+}
+
+// Evaluated only when the breakpoint is hit, so it need not be fast, just not slow
+// NB. && and || are not short-circuit, since nothing has side effects
+//===========================================================================
+bool ConditionEvaluate ( const BreakpointCondition_t & condition, UINT nHits )
+{
+	if (! condition.nOps)
+		return true;
+
+	int64_t aStack[ MAX_CONDITION_STACK ];
+	int     iTop = -1;
+
+	for (int iOp = 0; iOp < condition.nOps; iOp++)
+	{
+		const ConditionOp_t & op = condition.aOps[ iOp ];
+
+		if (op.eOp >= COND_OP_MUL)
+		{
+			const int64_t nRight = aStack[ iTop-- ];
+			int64_t     & nLeft  = aStack[ iTop ];
+
+			switch (op.eOp)
+			{
+				case COND_OP_MUL          : nLeft = nLeft * nRight; break;
+				case COND_OP_DIV          : nLeft = nRight ? (nLeft / nRight) : 0; break;
+				case COND_OP_MOD          : nLeft = nRight ? (nLeft % nRight) : 0; break;
+				case COND_OP_ADD          : nLeft = nLeft + nRight; break;
+				case COND_OP_SUB          : nLeft = nLeft - nRight; break;
+				case COND_OP_SHL          : nLeft = nLeft << (nRight & 63); break;
+				case COND_OP_SHR          : nLeft = nLeft >> (nRight & 63); break;
+				case COND_OP_LESS_THAN    : nLeft = nLeft <  nRight; break;
+				case COND_OP_LESS_EQUAL   : nLeft = nLeft <= nRight; break;
+				case COND_OP_GREATER_THAN : nLeft = nLeft >  nRight; break;
+				case COND_OP_GREATER_EQUAL: nLeft = nLeft >= nRight; break;
+				case COND_OP_EQUAL        : nLeft = nLeft == nRight; break;
+				case COND_OP_NOT_EQUAL    : nLeft = nLeft != nRight; break;
+				case COND_OP_AND          : nLeft = nLeft &  nRight; break;
+				case COND_OP_XOR          : nLeft = nLeft ^  nRight; break;
+				case COND_OP_OR           : nLeft = nLeft |  nRight; break;
+				case COND_OP_LAND         : nLeft = nLeft && nRight; break;
+				case COND_OP_LOR          : nLeft = nLeft || nRight; break;
+				default: _ASSERT(0); break;
+			}
+			continue;
+		}
+
+		switch (op.eOp)
+		{
+			case COND_OP_CONST : aStack[ ++iTop ] = op.nValue; break;
+			case COND_OP_FLAG  : aStack[ ++iTop ] = (regs.ps >> op.nValue) & 1; break;
+			case COND_OP_OPCODE: aStack[ ++iTop ] = mem[ regs.pc ]; break;
+			case COND_OP_CYCLES: aStack[ ++iTop ] = (int64_t) g_nCumulativeCycles; break;
+			case COND_OP_HITS  : aStack[ ++iTop ] = nHits; break;
+
+			case COND_OP_REG:
+				switch (op.nValue)
+				{
+					case BP_SRC_REG_A : aStack[ ++iTop ] = regs.a ; break;
+					case BP_SRC_REG_X : aStack[ ++iTop ] = regs.x ; break;
+					case BP_SRC_REG_Y : aStack[ ++iTop ] = regs.y ; break;
+					case BP_SRC_REG_PC: aStack[ ++iTop ] = regs.pc; break;
+					case BP_SRC_REG_S : aStack[ ++iTop ] = regs.sp; break;
+					default           : aStack[ ++iTop ] = regs.ps; break;
+				}
+				break;
+
+			case COND_OP_PEEK:
+				aStack[ iTop ] = mem[ (WORD) aStack[ iTop ] ];
+				break;
+			case COND_OP_PEEK_WORD:
+			{
+				const WORD nAddress = (WORD) aStack[ iTop ];
+				aStack[ iTop ] = mem[ nAddress ] | (mem[ (WORD)(nAddress + 1) ] << 8);
+				break;
+			}
+			case COND_OP_NEG : aStack[ iTop ] = -aStack[ iTop ]; break;
+			case COND_OP_NOT : aStack[ iTop ] = ~aStack[ iTop ]; break;
+			case COND_OP_LNOT: aStack[ iTop ] = !aStack[ iTop ]; break;
+
+			default: _ASSERT(0); break;
+		}
+	}
+
+	return aStack[ 0 ] != 0;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+// Breakpoint Conditions __________________________________________________________________________
+
+	// BPIF # expression
+	// The expression is compiled once to postfix bytecode, and only evaluated when its breakpoint is hit,
+	// ie. after the PC/memory trap fired and _CheckBreakpointValue() matched, see _CheckBreakpointCondition()
+	// NB. Memory breakpoints are evaluated after the opcode that accessed memory (not during it), so P & cycles are up-to-date, see CheckBreakpointsMem()
+	enum ConditionOp_e
+	{
+		// Operands: push
+		  COND_OP_CONST    // nValue
+		, COND_OP_REG      // nValue = BP_SRC_REG_A .. BP_SRC_REG_P
+		, COND_OP_FLAG     // nValue = bit 0..7 of P
+		, COND_OP_OPCODE   // [PC]
+		, COND_OP_CYCLES   // g_nCumulativeCycles
+		, COND_OP_HITS     // times the breakpoint was hit, including this one
+		// Unary: pop 1, push 1
+		, COND_OP_PEEK     // [addr]
+		, COND_OP_PEEK_WORD// {addr}
+		, COND_OP_NEG      // -
+		, COND_OP_NOT      // ~
+		, COND_OP_LNOT     // !
+		// Binary: pop 2, push 1
+		, COND_OP_MUL
+		, COND_OP_DIV
+		, COND_OP_MOD
+		, COND_OP_ADD
+		, COND_OP_SUB
+		, COND_OP_SHL
+		, COND_OP_SHR
+		, COND_OP_LESS_THAN
+		, COND_OP_LESS_EQUAL
+		, COND_OP_GREATER_THAN
+		, COND_OP_GREATER_EQUAL
+		, COND_OP_EQUAL
+		, COND_OP_NOT_EQUAL
+		, COND_OP_AND
+		, COND_OP_XOR
+		, COND_OP_OR
+		, COND_OP_LAND
+		, COND_OP_LOR
+	};
+
+	enum
+	{
+		MAX_CONDITION_OPS   = 64,
+		MAX_CONDITION_STACK = 16,
+		MAX_CONDITION_TEXT  = 64,
+	};
+
+	struct ConditionOp_t
+	{
+		BYTE  eOp   ; // ConditionOp_e
+		DWORD nValue;
+	};
+
+	struct BreakpointCondition_t
+	{
+		int           nOps; // 0 = no condition, always true
+		ConditionOp_t aOps [ MAX_CONDITION_OPS ];
+		char          sText[ MAX_CONDITION_TEXT+1 ]; // as entered, for BPL and BPSAVE
+	};
+
+	extern BreakpointCondition_t g_aBreakpointConditions[ MAX_BREAKPOINTS ];
+
+	bool ConditionCompile ( const char *pText, BreakpointCondition_t & condition_, const char* & pError_ );
+	bool ConditionEvaluate ( const BreakpointCondition_t & condition, UINT nHits );
@@ -67,6 +67,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 		int       g_nConsoleDisplayLines  = 0;
 		int       g_nConsoleDisplayWidth  = 0;
 		conchar_t g_aConsoleDisplay[ CONSOLE_HEIGHT ][ CONSOLE_WIDTH ];
+		std::vector<std::string> *g_pConsoleCapture = NULL;
 
 	// Input History
 		int   g_nHistoryLinesStart = 0;
@@ -403,6 +404,14 @@ void ConsoleDisplayPush ( const conchar_t * pText )
 			, pText
 			, sizeof(conchar_t) * CONSOLE_WIDTH
 		);
+
+		if (g_pConsoleCapture)
+		{
+			std::string sLine;
+			for (int x = 0; (x < CONSOLE_WIDTH) && pText[ x ]; x++)
+				sLine += ConsoleChar_GetChar( pText[ x ] );
+			g_pConsoleCapture->push_back( sLine );
+		}
 	}
 	
 	g_nConsoleDisplayTotal++;
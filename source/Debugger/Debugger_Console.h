@@ -231,6 +231,7 @@
 		extern int       g_nConsoleDisplayLines  ;
 		extern int       g_nConsoleDisplayWidth  ;
 		extern conchar_t g_aConsoleDisplay[ CONSOLE_HEIGHT ][ CONSOLE_WIDTH ];
+		extern std::vector<std::string> *g_pConsoleCapture; // if set, lines pushed to the display are also copied here as plain text
 
 	// Input History
 		extern int   g_nHistoryLinesStart;// = 0;
@@ -0,0 +1,409 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Debugger Code Coverage (executed opcodes and branch directions, per bank)
+ *
+ * Author: Various
+ */
+
+#include "StdAfx.h"
+
+#include "Debug.h"
+
+#include "../Core.h"
+#include "../CPU.h"
+#include "../Memory.h"
+
+// Code Coverage __________________________________________________________________________________
+
+	DebugCoverage_t g_DebugCoverage;
+
+	static const char g_sFileNameCoverage       [] = "Coverage.txt";
+	static const char g_sFileNameCoverageListing[] = "CoverageListing.txt";
+
+	static const char *g_aCoverageBankNames[ NUM_COVERAGE_BANKS ] =
+	{
+		"MAIN",
+		"AUX" ,
+		"ROM" ,
+	};
+
+
+// Recording ______________________________________________________________________________________
+
+//===========================================================================
+static void _CoverageSetBranch ( const BYTE iOpcode, const BYTE nMask, const BYTE nValue )
+{
+	g_DebugCoverage.aBranches[ iOpcode ].bBranch = true;
+	g_DebugCoverage.aBranches[ iOpcode ].nMask   = nMask;
+	g_DebugCoverage.aBranches[ iOpcode ].nValue  = nValue;
+}
+
+//===========================================================================
+static void _CoverageInitBranches ()
+{
+	memset( g_DebugCoverage.aBranches, 0, sizeof( g_DebugCoverage.aBranches ) );
+
+	_CoverageSetBranch( 0x10, 0x80, 0x00 ); // BPL
+	_CoverageSetBranch( 0x30, 0x80, 0x80 ); // BMI
+	_CoverageSetBranch( 0x50, 0x40, 0x00 ); // BVC
+	_CoverageSetBranch( 0x70, 0x40, 0x40 ); // BVS
+	_CoverageSetBranch( 0x90, 0x01, 0x00 ); // BCC
+	_CoverageSetBranch( 0xB0, 0x01, 0x01 ); // BCS
+	_CoverageSetBranch( 0xD0, 0x02, 0x00 ); // BNE
+	_CoverageSetBranch( 0xF0, 0x02, 0x02 ); // BEQ
+
+	if (GetMainCpu() != CPU_6502) // 6502: NOP #
+		_CoverageSetBranch( 0x80, 0x00, 0x00 ); // BRA
+}
+
+// Mirrors the read paging in Memory.cpp UpdatePaging()
+//===========================================================================
+void CoverageUpdatePaging ( const DWORD nMemMode )
+{
+	g_DebugCoverage.nMemMode = nMemMode;
+
+	const BYTE iBankAuxZP = (nMemMode & MF_ALTZP  ) ? COVERAGE_BANK_AUX : COVERAGE_BANK_MAIN;
+	const BYTE iBankRead  = (nMemMode & MF_AUXREAD) ? COVERAGE_BANK_AUX : COVERAGE_BANK_MAIN;
+	const BYTE iBankPage2 = (nMemMode & MF_PAGE2  ) ? COVERAGE_BANK_AUX : COVERAGE_BANK_MAIN;
+
+	for (UINT iPage = 0; iPage < 0x100; iPage++)
+	{
+		BYTE iBank = iBankRead;
+		BYTE iPhys = iPage;
+
+		if (iPage < 0x02)
+			iBank = iBankAuxZP;
+		else
+		if (iPage >= 0xC0)
+		{
+			iBank = COVERAGE_BANK_ROM;
+
+			if ((iPage >= 0xD0) && (nMemMode & MF_HIGHRAM))
+			{
+				iBank = iBankAuxZP;
+				if ((iPage < 0xE0) && !(nMemMode & MF_BANK2))
+					iPhys = iPage - 0x10;
+			}
+		}
+		else
+		if (nMemMode & MF_80STORE)
+		{
+			if ((iPage >= 0x04) && (iPage < 0x08))
+				iBank = iBankPage2;
+			if ((iPage >= 0x20) && (iPage < 0x40) && (nMemMode & MF_HIRES))
+				iBank = iBankPage2;
+		}
+
+		g_DebugCoverage.aPageBank[ iPage ] = iBank;
+		g_DebugCoverage.aPagePhys[ iPage ] = iPhys;
+	}
+}
+
+//===========================================================================
+static void CoverageStart ()
+{
+	if (!g_DebugCoverage.pBanks)
+		g_DebugCoverage.pBanks = new CoverageBank_t[ NUM_COVERAGE_BANKS ];
+
+	memset( g_DebugCoverage.pBanks, 0, NUM_COVERAGE_BANKS * sizeof(CoverageBank_t) );
+
+	_CoverageInitBranches();
+	CoverageUpdatePaging( GetMemMode() );
+
+	g_DebugCoverage.bEnabled = true;
+}
+
+// Keeps the coverage, so it can still be listed or saved
+//===========================================================================
+void CoverageStop ()
+{
+	g_DebugCoverage.bEnabled = false;
+}
+
+
+// Reporting ______________________________________________________________________________________
+
+	struct CoverageCounts_t
+	{
+		UINT nExecuted;
+		UINT nBranches; // executed branch opcodes
+		UINT nTaken   ; // only taken
+		UINT nNotTaken; // only not taken
+		UINT nBoth    ;
+	};
+
+//===========================================================================
+static bool _CoverageBit ( const BYTE *pBitmap, const UINT nAddress )
+{
+	return (pBitmap[ nAddress >> 3 ] & (1 << (nAddress & 7))) != 0;
+}
+
+//===========================================================================
+static void _CoverageCount ( const CoverageBank_t & bank, CoverageCounts_t & counts_ )
+{
+	memset( &counts_, 0, sizeof( counts_ ) );
+
+	for (UINT nAddress = 0; nAddress < 0x10000; nAddress++)
+	{
+		if (!_CoverageBit( bank.aExecuted, nAddress ))
+			continue;
+
+		counts_.nExecuted++;
+
+		const bool bTaken    = _CoverageBit( bank.aTaken   , nAddress );
+		const bool bNotTaken = _CoverageBit( bank.aNotTaken, nAddress );
+		if (!bTaken && !bNotTaken)
+			continue;
+
+		counts_.nBranches++;
+		if (bTaken && bNotTaken)
+			counts_.nBoth++;
+		else
+		if (bTaken)
+			counts_.nTaken++;
+		else
+			counts_.nNotTaken++;
+	}
+}
+
+// '*' = executed, then branch: 'T' = only taken, 'N' = only not taken, 'B' = both
+//===========================================================================
+static void _CoverageFlags ( const CoverageBank_t & bank, const UINT nAddress, char sFlags_[3] )
+{
+	const bool bTaken    = _CoverageBit( bank.aTaken   , nAddress );
+	const bool bNotTaken = _CoverageBit( bank.aNotTaken, nAddress );
+
+	sFlags_[0] = _CoverageBit( bank.aExecuted, nAddress ) ? '*' : ' ';
+	sFlags_[1] = (bTaken && bNotTaken) ? 'B' : bTaken ? 'T' : bNotTaken ? 'N' : ' ';
+	sFlags_[2] = 0;
+}
+
+// One line per executed opcode: <bank>:<address> <flags>
+//===========================================================================
+static bool _CoverageSave ( const std::string & sFileName )
+{
+	FILE *hFile = fopen( sFileName.c_str(), "wt" );
+	if (!hFile)
+		return false;
+
+	fprintf( hFile, "; Bank Executed Branches Taken NotTaken Both\n" );
+	for (int iBank = 0; iBank < NUM_COVERAGE_BANKS; iBank++)
+	{
+		CoverageCounts_t counts;
+		_CoverageCount( g_DebugCoverage.pBanks[ iBank ], counts );
+		fprintf( hFile, "; %-4s %8u %8u %5u %8u %4u\n"
+			, g_aCoverageBankNames[ iBank ]
+			, counts.nExecuted, counts.nBranches, counts.nTaken, counts.nNotTaken, counts.nBoth );
+	}
+
+	for (int iBank = 0; iBank < NUM_COVERAGE_BANKS; iBank++)
+	{
+		const CoverageBank_t & bank = g_DebugCoverage.pBanks[ iBank ];
+
+		for (UINT nAddress = 0; nAddress < 0x10000; nAddress++)
+		{
+			if (!_CoverageBit( bank.aExecuted, nAddress ))
+				continue;
+
+			char sFlags[3];
+			_CoverageFlags( bank, nAddress, sFlags );
+			fprintf( hFile, "%s:%04X %s\n", g_aCoverageBankNames[ iBank ], nAddress, sFlags );
+		}
+	}
+
+	fclose( hFile );
+	return true;
+}
+
+// Disassembly of [nAddressBegin,nAddressEnd] as currently paged in, with coverage flags
+// Re-syncs to an executed opcode that would otherwise be hidden in the operand of the previous line
+//===========================================================================
+static bool _CoverageSaveListing ( const std::string & sFileName, const WORD nAddressBegin, const WORD nAddressEnd, UINT & nExecuted_, UINT & nLines_ )
+{
+	FILE *hFile = fopen( sFileName.c_str(), "wt" );
+	if (!hFile)
+		return false;
+
+	CoverageUpdatePaging( GetMemMode() );
+
+	nExecuted_ = 0;
+	nLines_    = 0;
+
+	UINT nAddress = nAddressBegin;
+	while (nAddress <= nAddressEnd)
+	{
+		const BYTE iPage = (BYTE)(nAddress >> 8);
+		const CoverageBank_t & bank = g_DebugCoverage.pBanks[ g_DebugCoverage.aPageBank[ iPage ] ];
+		const UINT nPhys = (g_DebugCoverage.aPagePhys[ iPage ] << 8) | (nAddress & 0xFF);
+
+		DisasmLine_t line;
+		GetDisassemblyLine( (WORD) nAddress, line );
+		int nOpbytes = MAX( 1, line.nOpbyte );
+
+		for (int iByte = 1; iByte < nOpbytes; iByte++)
+		{
+			const UINT nNext = nAddress + iByte;
+			const BYTE iNextPage = (BYTE)(nNext >> 8);
+			const UINT nNextPhys = (g_DebugCoverage.aPagePhys[ iNextPage ] << 8) | (nNext & 0xFF);
+			if ((nNext <= 0xFFFF) && _CoverageBit( g_DebugCoverage.pBanks[ g_DebugCoverage.aPageBank[ iNextPage ] ].aExecuted, nNextPhys ))
+			{
+				nOpbytes = iByte;
+				break;
+			}
+		}
+
+		char sFlags[3];
+		_CoverageFlags( bank, nPhys, sFlags );
+
+		const char *pSymbol = FindSymbolFromAddress( (WORD) nAddress );
+		if (pSymbol)
+			fprintf( hFile, "%s:\n", pSymbol );
+
+		if (nOpbytes == line.nOpbyte)
+		{
+			char sDisassembly[ CONSOLE_WIDTH ];
+			FormatDisassemblyLine( line, sDisassembly, CONSOLE_WIDTH );
+			fprintf( hFile, "%s %-4s %s\n", sFlags, g_aCoverageBankNames[ g_DebugCoverage.aPageBank[ iPage ] ], sDisassembly );
+		}
+		else
+		{
+			fprintf( hFile, "%s %-4s %04X:", sFlags, g_aCoverageBankNames[ g_DebugCoverage.aPageBank[ iPage ] ], nAddress );
+			for (int iByte = 0; iByte < nOpbytes; iByte++)
+				fprintf( hFile, "%02X ", *(mem + ((nAddress + iByte) & 0xFFFF)) );
+			fprintf( hFile, "\n" );
+		}
+
+		if (sFlags[0] == '*')
+			nExecuted_++;
+		nLines_++;
+
+		nAddress += nOpbytes;
+	}
+
+	fclose( hFile );
+	return true;
+}
+
+
+// Commands _______________________________________________________________________________________
+
+// COVERAGE [ON | OFF | RESET | SAVE ["file"] | LIST range ["file"]]
+//===========================================================================
+Update_t CmdCoverage (int nArgs)
+{
+	char sText[ CONSOLE_WIDTH ];
+
+	int iParam = PARAM_LIST;
+	if (nArgs >= 1)
+	{
+		int nFound = FindParam( g_aArgs[ 1 ].sArg, MATCH_EXACT, iParam, _PARAM_GENERAL_BEGIN, _PARAM_GENERAL_END );
+		if (!nFound)
+			return Help_Arg_1( CMD_COVERAGE );
+	}
+
+	const bool bQuotedFile = (nArgs >= 2) && (g_aArgs[ nArgs ].bType & TYPE_QUOTED_2);
+
+	switch (iParam)
+	{
+		case PARAM_ON:
+		case PARAM_RESET:
+			CoverageStart();
+			ConsoleBufferPush( " Coverage started." );
+			return ConsoleUpdate();
+
+		case PARAM_OFF:
+			CoverageStop();
+			ConsoleBufferPush( " Coverage stopped." );
+			return ConsoleUpdate();
+
+		case PARAM_LIST:
+		case PARAM_SAVE:
+			break;
+
+		default:
+			return Help_Arg_1( CMD_COVERAGE );
+	}
+
+	if (!g_DebugCoverage.pBanks)
+	{
+		ConsoleBufferPush( " No coverage. See: COVERAGE ON" );
+		return ConsoleUpdate();
+	}
+
+	if (iParam == PARAM_SAVE)
+	{
+		if (nArgs > 2 || (nArgs == 2 && !bQuotedFile))
+			return Help_Arg_1( CMD_COVERAGE );
+
+		const std::string sFileName = g_sProgramDir + (bQuotedFile ? g_aArgs[ 2 ].sArg : g_sFileNameCoverage);
+		if (_CoverageSave( sFileName ))
+			ConsoleBufferPushFormat( sText, " Saved: %s", sFileName.c_str() );
+		else
+			ConsoleBufferPush( " ERROR: Couldn't save file. (In use?)" );
+
+		return ConsoleUpdate();
+	}
+
+	// LIST range: annotated disassembly
+	if (nArgs >= 2)
+	{
+		WORD nAddressBegin;
+		WORD nAddress2;
+		WORD nAddressEnd;
+		int  nAddressLen;
+
+		RangeType_t eRange = Range_Get( nAddressBegin, nAddress2, 2 );
+		if (!Range_CalcEndLen( eRange, nAddressBegin, nAddress2, nAddressEnd, nAddressLen ) || !nAddressLen)
+			return Help_Arg_1( CMD_COVERAGE );
+
+		const std::string sFileName = g_sProgramDir + (bQuotedFile ? g_aArgs[ nArgs ].sArg : g_sFileNameCoverageListing);
+
+		UINT nExecuted;
+		UINT nLines;
+		if (_CoverageSaveListing( sFileName, nAddressBegin, nAddressEnd, nExecuted, nLines ))
+		{
+			ConsoleBufferPushFormat( sText, " %04X:%04X: %u of %u lines executed (%u%%)"
+				, nAddressBegin, nAddressEnd, nExecuted, nLines, nLines ? (nExecuted * 100 / nLines) : 0 );
+			ConsoleBufferPushFormat( sText, " Saved: %s", sFileName.c_str() );
+		}
+		else
+			ConsoleBufferPush( " ERROR: Couldn't save file. (In use?)" );
+
+		return ConsoleUpdate();
+	}
+
+	// Summary
+	ConsoleBufferPushFormat( sText, " Coverage: %s", g_aParameters[ g_DebugCoverage.bEnabled ? PARAM_ON : PARAM_OFF ].m_sName );
+	ConsoleBufferPush( " Bank Executed Branches Taken NotTaken Both" );
+	for (int iBank = 0; iBank < NUM_COVERAGE_BANKS; iBank++)
+	{
+		CoverageCounts_t counts;
+		_CoverageCount( g_DebugCoverage.pBanks[ iBank ], counts );
+		ConsoleBufferPushFormat( sText, " %-4s %8u %8u %5u %8u %4u"
+			, g_aCoverageBankNames[ iBank ]
+			, counts.nExecuted, counts.nBranches, counts.nTaken, counts.nNotTaken, counts.nBoth );
+	}
+
+	return ConsoleUpdate();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+// Code Coverage __________________________________________________________________________________
+
+	// The debug CPU core (Cpu6502_debug, Cpu65C02_debug) marks each opcode before it's executed,
+	// see Coverage_X() in cpu_heatmap.inl
+	// Coverage is kept per bank, so aux and Language Card code isn't merged with main RAM or ROM.
+	// Branches also record taken and/or not taken, from the flags before the branch is executed.
+	enum CoverageBank_e
+	{
+		COVERAGE_BANK_MAIN, // main RAM, LC bank 1 $D000..$DFFF is at $C000..$CFFF (same as Memory.cpp)
+		COVERAGE_BANK_AUX , // aux RAM (active RamWorks bank), LC as main
+		COVERAGE_BANK_ROM , // $C100..$FFFF internal and slot ROMs
+		NUM_COVERAGE_BANKS
+	};
+
+	enum
+	{
+		COVERAGE_BITMAP_SIZE = 0x10000 / 8,
+	};
+
+	struct CoverageBank_t
+	{
+		BYTE aExecuted[ COVERAGE_BITMAP_SIZE ]; // opcode addresses
+		BYTE aTaken   [ COVERAGE_BITMAP_SIZE ]; // branch opcode addresses
+		BYTE aNotTaken[ COVERAGE_BITMAP_SIZE ];
+	};
+
+	struct CoverageBranch_t
+	{
+		bool bBranch;
+		BYTE nMask  ; // taken if (P & nMask) == nValue
+		BYTE nValue ;
+	};
+
+	struct DebugCoverage_t
+	{
+		bool             bEnabled  ;
+		DWORD            nMemMode  ; // aPageBank, aPagePhys are valid for this GetMemMode()
+		BYTE             aPageBank [ 0x100 ]; // CoverageBank_e
+		BYTE             aPagePhys [ 0x100 ]; // page within the bank
+		CoverageBranch_t aBranches [ 0x100 ]; // by opcode
+		CoverageBank_t  *pBanks    ; // [NUM_COVERAGE_BANKS]
+	};
+
+	extern DebugCoverage_t g_DebugCoverage;
+
+	void CoverageUpdatePaging ( const DWORD nMemMode );
+	void CoverageStop ();
@@ -0,0 +1,428 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Debugger Cycle Audit (cycles charged per opcode and path, versus the datasheet)
+ *
+ * Author: Various
+ */
+
+#include "StdAfx.h"
+
+#include "Debug.h"
+
+#include "../Core.h"
+#include "../CPU.h"
+#include "../Memory.h"
+
+// Cycle Audit ____________________________________________________________________________________
+
+	DebugCycleAudit_t g_DebugCycleAudit;
+
+	static const char g_sFileNameCycleAudit[] = "CycleAudit.txt";
+
+	// How the opcode's path is worked out
+	enum CycleAuditMode_e
+	{
+		CYCLE_AUDIT_MODE_FIXED,
+		CYCLE_AUDIT_MODE_ABS_X , // +1 if page crossed
+		CYCLE_AUDIT_MODE_ABS_Y , // +1 if page crossed
+		CYCLE_AUDIT_MODE_IND_Y , // (zp),Y: +1 if page crossed
+		CYCLE_AUDIT_MODE_BRANCH, // +1 if taken, +1 more if that crosses a page
+
+		CYCLE_AUDIT_MODE_MASK    = 0x7F,
+		CYCLE_AUDIT_MODE_DECIMAL = 0x80, // +1 if D set
+	};
+
+	struct CycleAuditOpcode_t
+	{
+		BYTE nCycles;
+		BYTE nMode  ; // CycleAuditMode_e
+	};
+
+	#define FX(n) { n, CYCLE_AUDIT_MODE_FIXED  }
+	#define AX(n) { n, CYCLE_AUDIT_MODE_ABS_X  }
+	#define AY(n) { n, CYCLE_AUDIT_MODE_ABS_Y  }
+	#define IY(n) { n, CYCLE_AUDIT_MODE_IND_Y  }
+	#define BR(n) { n, CYCLE_AUDIT_MODE_BRANCH }
+	#define DF(n) { n, CYCLE_AUDIT_MODE_FIXED | CYCLE_AUDIT_MODE_DECIMAL }
+	#define DX(n) { n, CYCLE_AUDIT_MODE_ABS_X | CYCLE_AUDIT_MODE_DECIMAL }
+	#define DY(n) { n, CYCLE_AUDIT_MODE_ABS_Y | CYCLE_AUDIT_MODE_DECIMAL }
+	#define DI(n) { n, CYCLE_AUDIT_MODE_IND_Y | CYCLE_AUDIT_MODE_DECIMAL }
+
+	// MOS 6502, including the undocumented opcodes. JAM (halts the CPU) is 2, as it's emulated
+	// NB. $0C is NOP abs: 4 cycles, no page-cross (AppleWin executes it as NOP abs,X)
+	static const CycleAuditOpcode_t g_aCycleAudit6502[ 0x100 ] =
+	{
+	FX(7), FX(6), FX(2), FX(8), FX(3), FX(3), FX(5), FX(5), FX(3), FX(2), FX(2), FX(2), FX(4), FX(4), FX(6), FX(6), // 00 .. 0F
+	BR(2), IY(5), FX(2), FX(8), FX(4), FX(4), FX(6), FX(6), FX(2), AY(4), FX(2), FX(7), AX(4), AX(4), FX(7), FX(7), // 10 .. 1F
+	FX(6), FX(6), FX(2), FX(8), FX(3), FX(3), FX(5), FX(5), FX(4), FX(2), FX(2), FX(2), FX(4), FX(4), FX(6), FX(6), // 20 .. 2F
+	BR(2), IY(5), FX(2), FX(8), FX(4), FX(4), FX(6), FX(6), FX(2), AY(4), FX(2), FX(7), AX(4), AX(4), FX(7), FX(7), // 30 .. 3F
+	FX(6), FX(6), FX(2), FX(8), FX(3), FX(3), FX(5), FX(5), FX(3), FX(2), FX(2), FX(2), FX(3), FX(4), FX(6), FX(6), // 40 .. 4F
+	BR(2), IY(5), FX(2), FX(8), FX(4), FX(4), FX(6), FX(6), FX(2), AY(4), FX(2), FX(7), AX(4), AX(4), FX(7), FX(7), // 50 .. 5F
+	FX(6), FX(6), FX(2), FX(8), FX(3), FX(3), FX(5), FX(5), FX(4), FX(2), FX(2), FX(2), FX(5), FX(4), FX(6), FX(6), // 60 .. 6F
+	BR(2), IY(5), FX(2), FX(8), FX(4), FX(4), FX(6), FX(6), FX(2), AY(4), FX(2), FX(7), AX(4), AX(4), FX(7), FX(7), // 70 .. 7F
+	FX(2), FX(6), FX(2), FX(6), FX(3), FX(3), FX(3), FX(3), FX(2), FX(2), FX(2), FX(2), FX(4), FX(4), FX(4), FX(4), // 80 .. 8F
+	BR(2), FX(6), FX(2), FX(6), FX(4), FX(4), FX(4), FX(4), FX(2), FX(5), FX(2), FX(5), FX(5), FX(5), FX(5), FX(5), // 90 .. 9F
+	FX(2), FX(6), FX(2), FX(6), FX(3), FX(3), FX(3), FX(3), FX(2), FX(2), FX(2), FX(2), FX(4), FX(4), FX(4), FX(4), // A0 .. AF
+	BR(2), IY(5), FX(2), IY(5), FX(4), FX(4), FX(4), FX(4), FX(2), AY(4), FX(2), AY(4), AX(4), AX(4), AY(4), AY(4), // B0 .. BF
+	FX(2), FX(6), FX(2), FX(8), FX(3), FX(3), FX(5), FX(5), FX(2), FX(2), FX(2), FX(2), FX(4), FX(4), FX(6), FX(6), // C0 .. CF
+	BR(2), IY(5), FX(2), FX(8), FX(4), FX(4), FX(6), FX(6), FX(2), AY(4), FX(2), FX(7), AX(4), AX(4), FX(7), FX(7), // D0 .. DF
+	FX(2), FX(6), FX(2), FX(8), FX(3), FX(3), FX(5), FX(5), FX(2), FX(2), FX(2), FX(2), FX(4), FX(4), FX(6), FX(6), // E0 .. EF
+	BR(2), IY(5), FX(2), FX(8), FX(4), FX(4), FX(6), FX(6), FX(2), AY(4), FX(2), FX(7), AX(4), AX(4), FX(7), FX(7), // F0 .. FF
+	};
+
+	// 65C02 (as //e enhanced): the unused opcodes are NOPs. $x3, $x7, $xB, $xF are 1 cycle
+	// NB. JMP (abs) is always 6 cycles (AppleWin adds 1 when abs is $xxFF)
+	static const CycleAuditOpcode_t g_aCycleAudit65C02[ 0x100 ] =
+	{
+	FX(7), FX(6), FX(2), FX(1), FX(5), FX(3), FX(5), FX(1), FX(3), FX(2), FX(2), FX(1), FX(6), FX(4), FX(6), FX(1), // 00 .. 0F
+	BR(2), IY(5), FX(5), FX(1), FX(5), FX(4), FX(6), FX(1), FX(2), AY(4), FX(2), FX(1), FX(6), AX(4), AX(6), FX(1), // 10 .. 1F
+	FX(6), FX(6), FX(2), FX(1), FX(3), FX(3), FX(5), FX(1), FX(4), FX(2), FX(2), FX(1), FX(4), FX(4), FX(6), FX(1), // 20 .. 2F
+	BR(2), IY(5), FX(5), FX(1), FX(4), FX(4), FX(6), FX(1), FX(2), AY(4), FX(2), FX(1), AX(4), AX(4), AX(6), FX(1), // 30 .. 3F
+	FX(6), FX(6), FX(2), FX(1), FX(3), FX(3), FX(5), FX(1), FX(3), FX(2), FX(2), FX(1), FX(3), FX(4), FX(6), FX(1), // 40 .. 4F
+	BR(2), IY(5), FX(5), FX(1), FX(4), FX(4), FX(6), FX(1), FX(2), AY(4), FX(3), FX(1), FX(8), AX(4), AX(6), FX(1), // 50 .. 5F
+	FX(6), DF(6), FX(2), FX(1), FX(3), DF(3), FX(5), FX(1), FX(4), DF(2), FX(2), FX(1), FX(6), DF(4), FX(6), FX(1), // 60 .. 6F
+	BR(2), DI(5), DF(5), FX(1), FX(4), DF(4), FX(6), FX(1), FX(2), DY(4), FX(4), FX(1), FX(6), DX(4), AX(6), FX(1), // 70 .. 7F
+	BR(2), FX(6), FX(2), FX(1), FX(3), FX(3), FX(3), FX(1), FX(2), FX(2), FX(2), FX(1), FX(4), FX(4), FX(4), FX(1), // 80 .. 8F
+	BR(2), FX(6), FX(5), FX(1), FX(4), FX(4), FX(4), FX(1), FX(2), FX(5), FX(2), FX(1), FX(4), FX(5), FX(5), FX(1), // 90 .. 9F
+	FX(2), FX(6), FX(2), FX(1), FX(3), FX(3), FX(3), FX(1), FX(2), FX(2), FX(2), FX(1), FX(4), FX(4), FX(4), FX(1), // A0 .. AF
+	BR(2), IY(5), FX(5), FX(1), FX(4), FX(4), FX(4), FX(1), FX(2), AY(4), FX(2), FX(1), AX(4), AX(4), AY(4), FX(1), // B0 .. BF
+	FX(2), FX(6), FX(2), FX(1), FX(3), FX(3), FX(5), FX(1), FX(2), FX(2), FX(2), FX(1), FX(4), FX(4), FX(6), FX(1), // C0 .. CF
+	BR(2), IY(5), FX(5), FX(1), FX(4), FX(4), FX(6), FX(1), FX(2), AY(4), FX(3), FX(1), FX(4), AX(4), FX(7), FX(1), // D0 .. DF
+	FX(2), DF(6), FX(2), FX(1), FX(3), DF(3), FX(5), FX(1), FX(2), DF(2), FX(2), FX(1), FX(4), DF(4), FX(6), FX(1), // E0 .. EF
+	BR(2), DI(5), DF(5), FX(1), FX(4), DF(4), FX(6), FX(1), FX(2), DY(4), FX(4), FX(1), FX(4), DX(4), FX(7), FX(1), // F0 .. FF
+	};
+
+	#undef FX
+	#undef AX
+	#undef AY
+	#undef IY
+	#undef BR
+	#undef DF
+	#undef DX
+	#undef DY
+	#undef DI
+
+	static const char *g_aCycleAuditPathNames[ NUM_CYCLE_AUDIT_PATHS ] =
+	{
+		"",
+		"page",
+		"taken",
+		"taken+page",
+		"decimal",
+		"decimal+page",
+		"", // not possible
+		"",
+	};
+
+	struct CycleAuditLine_t
+	{
+		UINT iEntry;
+		BYTE nExpected;
+	};
+
+
+// Recording ______________________________________________________________________________________
+
+//===========================================================================
+static bool _CycleAuditBranchTaken ( const BYTE nOpcode )
+{
+	if (nOpcode == 0x80) // BRA
+		return true;
+
+	// Bxx: bits 7-6 = flag (N, V, C, Z), bit 5 = taken if flag is set
+	static const BYTE aMasks[ 4 ] = { 0x80, 0x40, 0x01, 0x02 }; // N, V, C, Z
+	const bool bSet = (regs.ps & aMasks[ nOpcode >> 6 ]) != 0;
+	return bSet == ((nOpcode & 0x20) != 0);
+}
+
+//===========================================================================
+static const CycleAuditOpcode_t & _CycleAuditGetOpcode ( const BYTE nOpcode )
+{
+	return (GetMainCpu() == CPU_6502) ? g_aCycleAudit6502[ nOpcode ] : g_aCycleAudit65C02[ nOpcode ];
+}
+
+//===========================================================================
+static BYTE _CycleAuditGetExpected ( const UINT iEntry )
+{
+	const CycleAuditOpcode_t & op = _CycleAuditGetOpcode( iEntry / NUM_CYCLE_AUDIT_PATHS );
+	const UINT nPath = iEntry % NUM_CYCLE_AUDIT_PATHS;
+
+	return op.nCycles
+		+ ((nPath & CYCLE_AUDIT_PAGE_CROSSED) ? 1 : 0)
+		+ ((nPath & CYCLE_AUDIT_BRANCH_TAKEN) ? 1 : 0)
+		+ ((nPath & CYCLE_AUDIT_DECIMAL     ) ? 1 : 0);
+}
+
+// Work out the path of the opcode at nAddress, from the registers and memory before it's executed
+// Pre: regs.ps is up-to-date
+// See: CycleAudit_X()
+//===========================================================================
+void CycleAuditStep ( const WORD nAddress )
+{
+	const BYTE nOpcode  = *(mem + nAddress);
+	const BYTE nOperand = *(mem + (WORD)(nAddress + 1));
+	const CycleAuditOpcode_t & op = _CycleAuditGetOpcode( nOpcode );
+
+	UINT nPath = 0;
+	switch (op.nMode & CYCLE_AUDIT_MODE_MASK)
+	{
+		case CYCLE_AUDIT_MODE_ABS_X: // page-cross only depends on the low byte
+			if (nOperand + regs.x > 0xFF)
+				nPath |= CYCLE_AUDIT_PAGE_CROSSED;
+			break;
+		case CYCLE_AUDIT_MODE_ABS_Y:
+			if (nOperand + regs.y > 0xFF)
+				nPath |= CYCLE_AUDIT_PAGE_CROSSED;
+			break;
+		case CYCLE_AUDIT_MODE_IND_Y:
+			if (*(mem + nOperand) + regs.y > 0xFF) // only the pointer's low byte matters
+				nPath |= CYCLE_AUDIT_PAGE_CROSSED;
+			break;
+		case CYCLE_AUDIT_MODE_BRANCH:
+			if (_CycleAuditBranchTaken( nOpcode ))
+			{
+				const WORD nNext   = nAddress + 2;
+				const WORD nTarget = nNext + (signed char) nOperand;
+				nPath |= CYCLE_AUDIT_BRANCH_TAKEN;
+				if ((nNext ^ nTarget) & 0xFF00)
+					nPath |= CYCLE_AUDIT_PAGE_CROSSED;
+			}
+			break;
+		default:
+			break;
+	}
+
+	if ((op.nMode & CYCLE_AUDIT_MODE_DECIMAL) && (regs.ps & 0x08)) // D
+		nPath |= CYCLE_AUDIT_DECIMAL;
+
+	g_DebugCycleAudit.iEntry    = (nOpcode * NUM_CYCLE_AUDIT_PATHS) + nPath;
+	g_DebugCycleAudit.nExpected = _CycleAuditGetExpected( g_DebugCycleAudit.iEntry );
+	g_DebugCycleAudit.nPC       = nAddress;
+	g_DebugCycleAudit.bPending  = true;
+}
+
+//===========================================================================
+static void CycleAuditStart ()
+{
+	if (!g_DebugCycleAudit.pEntries)
+		g_DebugCycleAudit.pEntries = new CycleAuditEntry_t[ CYCLE_AUDIT_NUM_ENTRIES ];
+
+	memset( g_DebugCycleAudit.pEntries, 0, CYCLE_AUDIT_NUM_ENTRIES * sizeof(CycleAuditEntry_t) );
+
+	g_DebugCycleAudit.bPending = false;
+	g_DebugCycleAudit.bEnabled = true;
+}
+
+// Keeps the results, so they can still be listed or saved
+//===========================================================================
+void CycleAuditStop ()
+{
+	g_DebugCycleAudit.bEnabled = false;
+	g_DebugCycleAudit.bPending = false;
+}
+
+
+// Reporting ______________________________________________________________________________________
+
+// Most mismatches first
+//===========================================================================
+static bool _CycleAuditCompare ( const CycleAuditLine_t & a, const CycleAuditLine_t & b )
+{
+	const CycleAuditEntry_t & entryA = g_DebugCycleAudit.pEntries[ a.iEntry ];
+	const CycleAuditEntry_t & entryB = g_DebugCycleAudit.pEntries[ b.iEntry ];
+	if (entryA.nMismatches != entryB.nMismatches)
+		return entryA.nMismatches > entryB.nMismatches;
+	return a.iEntry < b.iEntry;
+}
+
+// Returns the # of opcodes executed. nPaths_ = # of opcode/paths executed, nMismatches_ = # of opcodes charged the wrong cycles
+//===========================================================================
+static UINT _CycleAuditSort ( std::vector<CycleAuditLine_t> & vLines_, const bool bMismatchesOnly, UINT & nPaths_, UINT & nMismatches_ )
+{
+	UINT nTotal = 0;
+	nPaths_      = 0;
+	nMismatches_ = 0;
+
+	vLines_.clear();
+	for (UINT iEntry = 0; iEntry < CYCLE_AUDIT_NUM_ENTRIES; iEntry++)
+	{
+		const CycleAuditEntry_t & entry = g_DebugCycleAudit.pEntries[ iEntry ];
+		if (!entry.nCount)
+			continue;
+
+		nTotal       += entry.nCount;
+		nMismatches_ += entry.nMismatches;
+		nPaths_++;
+
+		if (bMismatchesOnly && !entry.nMismatches)
+			continue;
+
+		CycleAuditLine_t line;
+		line.iEntry    = iEntry;
+		line.nExpected = _CycleAuditGetExpected( iEntry );
+		vLines_.push_back( line );
+	}
+
+	std::sort( vLines_.begin(), vLines_.end(), _CycleAuditCompare );
+	return nTotal;
+}
+
+//===========================================================================
+static void _CycleAuditFormat ( std::vector<std::string> & vLines_, const bool bExport, const UINT nMaxLines )
+{
+	std::vector<CycleAuditLine_t> vEntries;
+	UINT nPaths, nMismatches;
+	const UINT nTotal = _CycleAuditSort( vEntries, !bExport, nPaths, nMismatches );
+
+	char sLine[ CONSOLE_WIDTH * 2 ];
+
+	vLines_.clear();
+
+	if (bExport)
+		sprintf( sLine, "Opcode\tMnemonic\tPath\tExpected\tCount\tMismatches\tCharged\tLastPC" );
+	else
+		sprintf( sLine, " Op Mnem Path         Exp      Count Mismatch Chg   PC" );
+	vLines_.push_back( sLine );
+
+	for (UINT iLine = 0; iLine < vEntries.size() && iLine < nMaxLines; iLine++)
+	{
+		const CycleAuditLine_t  & line  = vEntries[ iLine ];
+		const CycleAuditEntry_t & entry = g_DebugCycleAudit.pEntries[ line.iEntry ];
+		const BYTE nOpcode = line.iEntry / NUM_CYCLE_AUDIT_PATHS;
+
+		if (entry.nMismatches)
+			sprintf( sLine, bExport ? "$%02X\t%s\t%s\t%u\t%u\t%u\t%u\t$%04X"
+			                        : " %02X %-4.4s %-12.12s %3u %10u %8u %3u %04X"
+				, nOpcode, g_aOpcodes[ nOpcode ].sMnemonic, g_aCycleAuditPathNames[ line.iEntry % NUM_CYCLE_AUDIT_PATHS ]
+				, line.nExpected, entry.nCount, entry.nMismatches, entry.nLastCharged, entry.nLastPC
+			);
+		else
+			sprintf( sLine, bExport ? "$%02X\t%s\t%s\t%u\t%u\t0\t\t"
+			                        : " %02X %-4.4s %-12.12s %3u %10u"
+				, nOpcode, g_aOpcodes[ nOpcode ].sMnemonic, g_aCycleAuditPathNames[ line.iEntry % NUM_CYCLE_AUDIT_PATHS ]
+				, line.nExpected, entry.nCount
+			);
+		vLines_.push_back( sLine );
+	}
+
+	sprintf( sLine, bExport ? "Total\t\t%u\t\t%u\t%u"
+	                        : " Total: %u opcode paths, %u opcodes, %u mismatches"
+		, nPaths, nTotal, nMismatches );
+	vLines_.push_back( sLine );
+}
+
+//===========================================================================
+static bool _CycleAuditSave ( const std::string & sFileName )
+{
+	FILE *hFile = fopen( sFileName.c_str(), "wt" );
+	if (!hFile)
+		return false;
+
+	std::vector<std::string> vLines;
+	_CycleAuditFormat( vLines, true, CYCLE_AUDIT_NUM_ENTRIES );
+
+	for (size_t iLine = 0; iLine < vLines.size(); iLine++)
+		fprintf( hFile, "%s\n", vLines[ iLine ].c_str() );
+
+	fclose( hFile );
+	return true;
+}
+
+
+// Commands _______________________________________________________________________________________
+
+// CYCLEAUDIT [ON | OFF | RESET | LIST | SAVE ["file"]]
+//===========================================================================
+Update_t CmdCycleAudit (int nArgs)
+{
+	int iParam = PARAM_LIST;
+	if (nArgs >= 1)
+	{
+		int nFound = FindParam( g_aArgs[ 1 ].sArg, MATCH_EXACT, iParam, _PARAM_GENERAL_BEGIN, _PARAM_GENERAL_END );
+		if (!nFound)
+			return Help_Arg_1( CMD_CYCLEAUDIT );
+	}
+
+	switch (iParam)
+	{
+		case PARAM_ON:
+		case PARAM_RESET:
+			if (nArgs > 1)
+				return Help_Arg_1( CMD_CYCLEAUDIT );
+
+			CycleAuditStart();
+			ConsoleBufferPush( " Cycle audit started." );
+			break;
+
+		case PARAM_OFF:
+			CycleAuditStop();
+			ConsoleBufferPush( " Cycle audit stopped." );
+			break;
+
+		case PARAM_LIST:
+		{
+			if (nArgs > 1)
+				return Help_Arg_1( CMD_CYCLEAUDIT );
+
+			if (!g_DebugCycleAudit.pEntries)
+			{
+				ConsoleBufferPush( " No cycle audit. See: CYCLEAUDIT ON" );
+				break;
+			}
+
+			std::vector<std::string> vLines;
+			_CycleAuditFormat( vLines, false, CYCLE_AUDIT_LIST_LINES );
+
+			for (size_t iLine = 0; iLine < vLines.size(); iLine++)
+				ConsolePrint( vLines[ iLine ].c_str() );
+			break;
+		}
+
+		case PARAM_SAVE:
+		{
+			const bool bQuotedFile = (nArgs == 2) && (g_aArgs[ 2 ].bType & TYPE_QUOTED_2);
+			if (nArgs > 2 || (nArgs == 2 && !bQuotedFile))
+				return Help_Arg_1( CMD_CYCLEAUDIT );
+
+			if (!g_DebugCycleAudit.pEntries)
+			{
+				ConsoleBufferPush( " No cycle audit. See: CYCLEAUDIT ON" );
+				break;
+			}
+
+			char sText[ CONSOLE_WIDTH ];
+			const std::string sFileName = g_sProgramDir + (bQuotedFile ? g_aArgs[ 2 ].sArg : g_sFileNameCycleAudit);
+			if (_CycleAuditSave( sFileName ))
+				ConsoleBufferPushFormat( sText, " Saved: %s", sFileName.c_str() );
+			else
+				ConsoleBufferPush( " ERROR: Couldn't save file. (In use?)" );
+			break;
+		}
+
+		default:
+			return Help_Arg_1( CMD_CYCLEAUDIT );
+	}
+
+	return ConsoleUpdate();
+}
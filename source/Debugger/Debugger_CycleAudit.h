@@ -0,0 +1,41 @@
+#pragma once
+
+// Cycle Audit ____________________________________________________________________________________
+
+	// The debug CPU core (Cpu6502_debug, Cpu65C02_debug) works out each opcode's path before it's executed,
+	// then compares the cycles it charged with the expected (datasheet) cycles for that path,
+	// see CycleAudit_X() and CycleAudit_Charged() in cpu_heatmap.inl
+	// Each path flag adds one cycle to the opcode's base cycles. (A taken branch that crosses a page is +2)
+	enum
+	{
+		CYCLE_AUDIT_PAGE_CROSSED = (1 << 0), // indexed read, or taken branch, crossed a page
+		CYCLE_AUDIT_BRANCH_TAKEN = (1 << 1),
+		CYCLE_AUDIT_DECIMAL      = (1 << 2), // 65C02 ADC/SBC with D set
+		NUM_CYCLE_AUDIT_PATHS    = (1 << 3),
+
+		CYCLE_AUDIT_NUM_ENTRIES  = 0x100 * NUM_CYCLE_AUDIT_PATHS, // index = (opcode * NUM_CYCLE_AUDIT_PATHS) + path
+		CYCLE_AUDIT_LIST_LINES   = 16,
+	};
+
+	struct CycleAuditEntry_t
+	{
+		UINT nCount      ;
+		UINT nMismatches ;
+		BYTE nLastCharged; // of the last mismatch
+		WORD nLastPC     ;
+	};
+
+	struct DebugCycleAudit_t
+	{
+		bool               bEnabled ;
+		bool               bPending ; // set before the opcode is executed, cleared after
+		WORD               nPC      ;
+		BYTE               nExpected;
+		UINT               iEntry   ;
+		CycleAuditEntry_t *pEntries ; // [CYCLE_AUDIT_NUM_ENTRIES]
+	};
+
+	extern DebugCycleAudit_t g_DebugCycleAudit;
+
+	void CycleAuditStep ( const WORD nAddress );
+	void CycleAuditStop ();
@@ -159,6 +159,61 @@ void GetTargets_IgnoreDirectJSRJMP(const BYTE iOpcode, int& nTargetPointer)
 }
 
 
+// Indirect / Indexed target pointer and value
+// These depend on the registers and memory, not just the opcode bytes, so are refreshed for cached lines
+//===========================================================================
+static int _GetDisassemblyTargetPointer(WORD nBaseAddress, DisasmLine_t& line_, int bDisasmFormatFlags)
+{
+	int nTargetPartial;
+	int nTargetPartial2;
+	int nTargetPointer;
+	WORD nTargetValue = 0; // de-ref
+	_6502_GetTargets(nBaseAddress, &nTargetPartial, &nTargetPartial2, &nTargetPointer, NULL);
+	GetTargets_IgnoreDirectJSRJMP(line_.iOpcode, nTargetPointer);	// For *direct* JSR/JMP, don't show 'addr16:byte char'
+
+	if (nTargetPointer != NO_6502_TARGET)
+	{
+		bDisasmFormatFlags |= DISASM_FORMAT_TARGET_POINTER;
+
+		nTargetValue = *(mem + nTargetPointer) | (*(mem + ((nTargetPointer + 1) & 0xffff)) << 8);
+
+		//				if (((iOpmode >= AM_A) && (iOpmode <= AM_NZ)) && (iOpmode != AM_R))
+		//					sprintf( sTargetValue_, "%04X", nTargetValue ); // & 0xFFFF
+
+		if (g_iConfigDisasmTargets & DISASM_TARGET_ADDR)
+			sprintf(line_.sTargetPointer, "%04X", nTargetPointer & 0xFFFF);
+
+		if (line_.iOpcode != OPCODE_JMP_NA && line_.iOpcode != OPCODE_JMP_IAX)
+		{
+			bDisasmFormatFlags |= DISASM_FORMAT_TARGET_VALUE;
+			if (g_iConfigDisasmTargets & DISASM_TARGET_VAL)
+				sprintf(line_.sTargetValue, "%02X", nTargetValue & 0xFF);
+
+			bDisasmFormatFlags |= DISASM_FORMAT_CHAR;
+			line_.nImmediate = (BYTE)nTargetValue;
+
+			unsigned _char = FormatCharTxtCtrl(FormatCharTxtHigh(line_.nImmediate, NULL), NULL);
+			sprintf(line_.sImmediate, "%c", _char);
+
+			//					if (ConsoleColorIsEscapeMeta( nImmediate_ ))
+#if OLD_CONSOLE_COLOR
+			if (ConsoleColorIsEscapeMeta(_char))
+				sprintf(line_.sImmediate, "%c%c", _char, _char);
+			else
+				sprintf(line_.sImmediate, "%c", _char);
+#endif
+		}
+
+		//				if (iOpmode == AM_NA ) // Indirect Absolute
+		//					sprintf( sTargetValue_, "%04X", nTargetPointer & 0xFFFF );
+		//				else
+		// //					sprintf( sTargetValue_, "%02X", nTargetValue & 0xFF );
+		//					sprintf( sTargetValue_, "%04X:%02X", nTargetPointer & 0xFFFF, nTargetValue & 0xFF );
+	}
+
+	return bDisasmFormatFlags;
+}
+
 // Get the data needed to disassemble one line of opcodes. Fills in the DisasmLine info.
 // Disassembly formatting flags returned
 //	@parama sTargetValue_ indirect/indexed final value
@@ -339,52 +394,7 @@ int GetDisassemblyLine(WORD nBaseAddress, DisasmLine_t& line_)
 
 
 			// Indirect / Indexed
-			int nTargetPartial;
-			int nTargetPartial2;
-			int nTargetPointer;
-			WORD nTargetValue = 0; // de-ref
-			_6502_GetTargets(nBaseAddress, &nTargetPartial, &nTargetPartial2, &nTargetPointer, NULL);
-			GetTargets_IgnoreDirectJSRJMP(iOpcode, nTargetPointer);	// For *direct* JSR/JMP, don't show 'addr16:byte char'
-
-			if (nTargetPointer != NO_6502_TARGET)
-			{
-				bDisasmFormatFlags |= DISASM_FORMAT_TARGET_POINTER;
-
-				nTargetValue = *(mem + nTargetPointer) | (*(mem + ((nTargetPointer + 1) & 0xffff)) << 8);
-
-				//				if (((iOpmode >= AM_A) && (iOpmode <= AM_NZ)) && (iOpmode != AM_R))
-				//					sprintf( sTargetValue_, "%04X", nTargetValue ); // & 0xFFFF
-
-				if (g_iConfigDisasmTargets & DISASM_TARGET_ADDR)
-					sprintf(line_.sTargetPointer, "%04X", nTargetPointer & 0xFFFF);
-
-				if (iOpcode != OPCODE_JMP_NA && iOpcode != OPCODE_JMP_IAX)
-				{
-					bDisasmFormatFlags |= DISASM_FORMAT_TARGET_VALUE;
-					if (g_iConfigDisasmTargets & DISASM_TARGET_VAL)
-						sprintf(line_.sTargetValue, "%02X", nTargetValue & 0xFF);
-
-					bDisasmFormatFlags |= DISASM_FORMAT_CHAR;
-					line_.nImmediate = (BYTE)nTargetValue;
-
-					unsigned _char = FormatCharTxtCtrl(FormatCharTxtHigh(line_.nImmediate, NULL), NULL);
-					sprintf(line_.sImmediate, "%c", _char);
-
-					//					if (ConsoleColorIsEscapeMeta( nImmediate_ ))
-#if OLD_CONSOLE_COLOR
-					if (ConsoleColorIsEscapeMeta(_char))
-						sprintf(line_.sImmediate, "%c%c", _char, _char);
-					else
-						sprintf(line_.sImmediate, "%c", _char);
-#endif
-				}
-
-				//				if (iOpmode == AM_NA ) // Indirect Absolute
-				//					sprintf( sTargetValue_, "%04X", nTargetPointer & 0xFFFF );
-				//				else
-				// //					sprintf( sTargetValue_, "%02X", nTargetValue & 0xFF );
-				//					sprintf( sTargetValue_, "%04X:%02X", nTargetPointer & 0xFFFF, nTargetValue & 0xFF );
-			}
+			bDisasmFormatFlags = _GetDisassemblyTargetPointer(nBaseAddress, line_, bDisasmFormatFlags);
 		}
 		else
 			if (iOpmode == AM_M)
@@ -437,6 +447,95 @@ int GetDisassemblyLine(WORD nBaseAddress, DisasmLine_t& line_)
 	return bDisasmFormatFlags;
 }
 
+// Disassembly Line Cache _________________________________________________________________________
+
+	// DrawDisassemblyLine() is called for every visible line on every redraw (cursor movement, stepping, ...)
+	// but the symbol lookups and formatting only change when the code does.
+	// Lines are cached by address and validated against their opcode bytes, so memory writes and bank switches
+	// (which change what mem[] holds) don't need to be tracked separately.
+	// Symbols, data disassembly and the disasm config are covered by DisasmCacheInvalidate() and the config check.
+	enum
+	{
+		DISASM_CACHE_LINES = 256, // power of 2, direct mapped by address: more than the code window can span
+	};
+
+	struct DisasmCacheLine_t
+	{
+		bool         bValid;
+		WORD         nAddress;
+		BYTE         aOpcodes[ 3 ];
+		int          bDisasmFormatFlags;
+		DisasmLine_t line;
+	};
+
+	struct DisasmCache_t
+	{
+		const Opcodes_t  *pOpcodes    ; // 6502 or 65C02
+		bool              bOpcodeSpaces;
+		int               iBranchType  ;
+		int               iTargets     ;
+		DisasmCacheLine_t aLines[ DISASM_CACHE_LINES ];
+	};
+
+	static DisasmCache_t g_DisasmCache;
+
+//===========================================================================
+void DisasmCacheInvalidate()
+{
+	for (int iLine = 0; iLine < DISASM_CACHE_LINES; iLine++)
+		g_DisasmCache.aLines[iLine].bValid = false;
+}
+
+// Same as GetDisassemblyLine(), but only decodes and formats lines that changed since the last call
+//===========================================================================
+int GetDisassemblyLineCached(const WORD nBaseAddress, DisasmLine_t& line_)
+{
+	if ((g_DisasmCache.pOpcodes != g_aOpcodes)
+	|| (g_DisasmCache.bOpcodeSpaces != g_bConfigDisasmOpcodeSpaces)
+	|| (g_DisasmCache.iBranchType != g_iConfigDisasmBranchType)
+	|| (g_DisasmCache.iTargets != g_iConfigDisasmTargets))
+	{
+		DisasmCacheInvalidate();
+		g_DisasmCache.pOpcodes      = g_aOpcodes;
+		g_DisasmCache.bOpcodeSpaces = g_bConfigDisasmOpcodeSpaces;
+		g_DisasmCache.iBranchType   = g_iConfigDisasmBranchType;
+		g_DisasmCache.iTargets      = g_iConfigDisasmTargets;
+	}
+
+	DisasmCacheLine_t& entry = g_DisasmCache.aLines[nBaseAddress & (DISASM_CACHE_LINES - 1)];
+
+	if (entry.bValid && (entry.nAddress == nBaseAddress))
+	{
+		int iByte = 0;
+		for (; iByte < entry.line.nOpbyte; iByte++)
+			if (entry.aOpcodes[iByte] != mem[(nBaseAddress + iByte) & 0xFFFF])
+				break;
+
+		if (iByte == entry.line.nOpbyte)
+		{
+			line_ = entry.line;
+			if (entry.bDisasmFormatFlags & DISASM_FORMAT_TARGET_POINTER)
+				return _GetDisassemblyTargetPointer(nBaseAddress, line_, entry.bDisasmFormatFlags);
+			return entry.bDisasmFormatFlags;
+		}
+	}
+
+	int bDisasmFormatFlags = GetDisassemblyLine(nBaseAddress, line_);
+
+	// Data lines can be longer than an opcode, and may change with the data they point to
+	entry.bValid = (line_.pDisasmData == NULL) && (line_.nOpbyte <= 3);
+	if (entry.bValid)
+	{
+		entry.nAddress = nBaseAddress;
+		for (int iByte = 0; iByte < line_.nOpbyte; iByte++)
+			entry.aOpcodes[iByte] = mem[(nBaseAddress + iByte) & 0xFFFF];
+		entry.bDisasmFormatFlags = bDisasmFormatFlags;
+		entry.line = line_;
+	}
+
+	return bDisasmFormatFlags;
+}
+
 //===========================================================================
 void FormatOpcodeBytes(WORD nBaseAddress, DisasmLine_t& line_)
 {
@@ -636,10 +735,16 @@ void DisasmCalcTopFromCurAddress(bool bUpdateTop)
 
 	g_bDisasmCurBad = false;
 
+	// Each start address re-walks mostly the same instructions, so only decode each address once
+	// Index is the offset from the first iTop, 0 = not decoded yet (every opcode is at least 1 byte)
+	const int nOffsets = nLen * 2 + 1;
+	std::vector<int> aOpbytes(nOffsets, 0);
+
 	bool bFound = false;
 	while (iTop <= iCur)
 	{
 		WORD iAddress = iTop;
+		int  iOffset  = iTop - (g_nDisasmCurAddress - nLen);
 		//		int iOpcode;
 		int iOpmode;
 		int nOpbytes;
@@ -647,7 +752,14 @@ void DisasmCalcTopFromCurAddress(bool bUpdateTop)
 		for (int iLine = 0; iLine <= nLen; iLine++) // min 1 opcode/instruction
 		{
 			// a.
-			_6502_GetOpmodeOpbyte(iAddress, iOpmode, nOpbytes);
+			if ((iOffset < nOffsets) && aOpbytes[iOffset])
+				nOpbytes = aOpbytes[iOffset];
+			else
+			{
+				_6502_GetOpmodeOpbyte(iAddress, iOpmode, nOpbytes);
+				if (iOffset < nOffsets)
+					aOpbytes[iOffset] = nOpbytes;
+			}
 			// b.
 			//			_6502_GetOpcodeOpmodeOpbyte( iOpcode, iOpmode, nOpbytes );
 
@@ -662,8 +774,8 @@ void DisasmCalcTopFromCurAddress(bool bUpdateTop)
 				{
 					g_nDisasmTopAddress = iTop;
 					bFound = true;
-					break;
 				}
+				break; // later lines can't be on the cursor line
 			}
 
 			// .20 Fixed: DisasmCalcTopFromCurAddress()
@@ -674,6 +786,7 @@ void DisasmCalcTopFromCurAddress(bool bUpdateTop)
 			OutputDebugString(sText);
 #endif
 			iAddress += nOpbytes;
+			iOffset  += nOpbytes;
 		}
 		if (bFound)
 		{
@@ -513,6 +513,7 @@ DisasmData_t* Disassembly_IsDataAddress ( WORD nAddress )
 void Disassembly_AddData( DisasmData_t tData)
 {
 	g_aDisassemblerData.push_back( tData );
+	DisasmCacheInvalidate();
 }
 
 // DEPRECATED ! Inlined in _6502_GetOpmodeOpbyte() !
@@ -554,5 +555,6 @@ void Disassembly_DelData( DisasmData_t tData)
 		}
 		pData = NULL; // bIsNopCode = false
 	}
+	DisasmCacheInvalidate();
 }
 
@@ -89,15 +89,13 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	static LPBITMAPINFO  g_hConsoleFontFramebufferinfo = NULL;
 	static bgra_t* g_hConsoleFontFramebits;
 
-	char g_cConsoleBrushFG_r;
-	char g_cConsoleBrushFG_g;
-	char g_cConsoleBrushFG_b;
-	char g_cConsoleBrushBG_r;
-	char g_cConsoleBrushBG_g;
-	char g_cConsoleBrushBG_b;
+	// Current colors for PrintGlyph() and FillBackground(), no GDI brushes needed
+	static COLORREF g_nConsoleColorFG = 0;
+	static COLORREF g_nConsoleColorBG = 0;
 
-	static HBRUSH g_hConsoleBrushFG = NULL;
-	static HBRUSH g_hConsoleBrushBG = NULL;
+	static void BuildGlyphAtlas ();
+	static void DisplayCellsReset ();
+	static void ComposeDisplayCells ();
 
 	// NOTE: Keep in sync ConsoleColors_e g_anConsoleColor !
 	COLORREF g_anConsoleColor[ NUM_CONSOLE_COLORS ] =
@@ -539,6 +537,8 @@ HDC GetDebuggerMemDC(void)
 			(LPVOID*)&g_pDebuggerMemFramebits, 0, 0
 		);
 		SelectObject(g_hDebuggerMemDC, g_hDebuggerMemBM);
+
+		DisplayCellsReset();
 	}
 
 	_ASSERT(g_hDebuggerMemDC);	// TC: Could this be NULL?
@@ -605,6 +605,7 @@ HDC GetConsoleFontDC(void)
 		DeleteDC(tmpDC);
 		DeleteObject(tmpFont);
 
+		BuildGlyphAtlas();
 	}
 
 	_ASSERT(g_hConsoleFontDC);
@@ -624,11 +625,6 @@ void ReleaseConsoleFontDC(void)
 		g_hConsoleFontFramebufferinfo = NULL;
 		g_hConsoleFontFramebits = NULL;
 	}
-
-	DeleteObject( g_hConsoleBrushFG );
-	g_hConsoleBrushFG = NULL;
-	DeleteObject( g_hConsoleBrushBG );
-	g_hConsoleBrushBG = NULL;
 }
 
 
@@ -644,6 +640,8 @@ void StretchBltMemToFrameDC(void)
 	int wdest = nViewportCX;
 	int hdest = nViewportCY;
 
+	ComposeDisplayCells();
+
 	BOOL bRes = StretchBlt(
 		win32Frame.FrameGetDC(),			                // HDC hdcDest,
 		xdest, ydest,									    // int nXOriginDest, int nYOriginDest,
@@ -660,19 +658,7 @@ void StretchBltMemToFrameDC(void)
 void DebuggerSetColorFG( COLORREF nRGB )
 {
 #if USE_APPLE_FONT
-	if (g_hConsoleBrushFG)
-	{
-		SelectObject( GetDebuggerMemDC(), GetStockObject(NULL_BRUSH) );
-		DeleteObject( g_hConsoleBrushFG );
-		g_hConsoleBrushFG = NULL;
-	}
-
-	g_hConsoleBrushFG = CreateSolidBrush(nRGB);
-
-	g_cConsoleBrushFG_r = nRGB & 0xFF;
-	g_cConsoleBrushFG_g = (nRGB>>8) & 0xFF;
-	g_cConsoleBrushFG_b = (nRGB>>16) & 0xFF;
-
+	g_nConsoleColorFG = nRGB;
 #else
 	SetTextColor( GetDebuggerMemDC(), nRGB );
 #endif
@@ -682,37 +668,156 @@ void DebuggerSetColorFG( COLORREF nRGB )
 void DebuggerSetColorBG( COLORREF nRGB, bool bTransparent )
 {
 #if USE_APPLE_FONT
-	if (g_hConsoleBrushBG)
+	// Transparency seems to be never used...
+	g_nConsoleColorBG = nRGB;
+#else
+	SetBkColor( GetDebuggerMemDC(), nRGB );
+#endif
+}
+
+// Display Cells __________________________________________________________________________________
+
+	// The debugger view is composed into the 32-bit DIB (g_pDebuggerMemFramebits) from a glyph atlas.
+	// Drawing only records each 7x8 cell's glyph and colors; StretchBltMemToFrameDC() then composes
+	// the cells that differ from what was composed last time, so redrawing an unchanged view touches no pixels.
+	// Glyphs and fills that aren't cell aligned (eg. the soft switch column) are drawn straight away instead.
+	enum
+	{
+		DISPLAY_CELLS_X = DEBUG_VIRTUAL_TEXT_WIDTH,               // 560 / 7
+		DISPLAY_CELLS_Y = DISPLAY_HEIGHT / CONSOLE_FONT_HEIGHT,   // 384 / 8
+		NUM_FONT_GLYPHS = CONSOLE_FONT_NUM_CHARS_PER_ROW * CONSOLE_FONT_NUM_ROWS,
+
+		CELL_FILL    = NUM_FONT_GLYPHS    , // background color only
+		CELL_RAW     = NUM_FONT_GLYPHS + 1, // pixels were drawn directly, not tracked
+		CELL_UNKNOWN = NUM_FONT_GLYPHS + 2, // pixels don't match any cell state
+	};
+
+	struct DisplayCell_t
+	{
+		int      nGlyph;
+		COLORREF nFG;
+		COLORREF nBG;
+
+		bool operator == ( const DisplayCell_t & rhs ) const
+		{
+			return (nGlyph == rhs.nGlyph) && (nFG == rhs.nFG) && (nBG == rhs.nBG);
+		}
+		bool operator != ( const DisplayCell_t & rhs ) const
+		{
+			return !(*this == rhs);
+		}
+	};
+
+	static DisplayCell_t g_aDisplayCells   [ DISPLAY_CELLS_Y ][ DISPLAY_CELLS_X ]; // as drawn
+	static DisplayCell_t g_aDisplayComposed[ DISPLAY_CELLS_Y ][ DISPLAY_CELLS_X ]; // as in the DIB
+
+	// Font pixels (0x00 or 0xFF) of each glyph, top row first
+	static BYTE g_aGlyphAtlas[ NUM_FONT_GLYPHS ][ CONSOLE_FONT_GRID_Y ][ CONSOLE_FONT_GRID_X ];
+
+//===========================================================================
+static void BuildGlyphAtlas ()
+{
+	for (int iGlyph = 0; iGlyph < NUM_FONT_GLYPHS; iGlyph++)
 	{
-		SelectObject( GetDebuggerMemDC(), GetStockObject(NULL_BRUSH) );
-		DeleteObject( g_hConsoleBrushBG );
-		g_hConsoleBrushBG = NULL;
+		const int xSrc = (iGlyph % CONSOLE_FONT_NUM_CHARS_PER_ROW) * CONSOLE_FONT_GRID_X;
+		const int ySrc = (iGlyph / CONSOLE_FONT_NUM_CHARS_PER_ROW) * CONSOLE_FONT_GRID_Y;
+
+		for (int y = 0; y < CONSOLE_FONT_GRID_Y; y++)
+		{
+			// Font bitmap is bottom-up
+			const bgra_t *pSrc = g_hConsoleFontFramebits + (CONSOLE_FONT_BITMAP_HEIGHT - 1 - ySrc - y) * CONSOLE_FONT_BITMAP_WIDTH + xSrc;
+			for (int x = 0; x < CONSOLE_FONT_GRID_X; x++)
+				g_aGlyphAtlas[ iGlyph ][ y ][ x ] = pSrc[ x ].g; // Should be same for R/G/B anyway (greyscale)
+		}
 	}
+}
 
-	if (! bTransparent)
+//===========================================================================
+static void DisplayCellsReset ()
+{
+	for (int row = 0; row < DISPLAY_CELLS_Y; row++)
 	{
-		g_hConsoleBrushBG = CreateSolidBrush( nRGB );
+		for (int col = 0; col < DISPLAY_CELLS_X; col++)
+		{
+			g_aDisplayCells   [ row ][ col ].nGlyph = CELL_RAW;
+			g_aDisplayComposed[ row ][ col ].nGlyph = CELL_UNKNOWN;
+		}
 	}
+}
 
-	// Transparency seems to be never used...
-	g_cConsoleBrushBG_r = nRGB & 0xFF;
-	g_cConsoleBrushBG_g = (nRGB >> 8) & 0xFF;
-	g_cConsoleBrushBG_b = (nRGB >> 16) & 0xFF;
+// Blend one glyph (or just the background) into the DIB, at any pixel position
+//===========================================================================
+static void DrawGlyphPixels ( const int xDst, const int yDst, const int nGlyph, const COLORREF nFG, const COLORREF nBG )
+{
+	const BYTE fg_r = GetRValue( nFG ), fg_g = GetGValue( nFG ), fg_b = GetBValue( nFG );
+	const BYTE bg_r = GetRValue( nBG ), bg_g = GetGValue( nBG ), bg_b = GetBValue( nBG );
 
-#else
-	SetBkColor( GetDebuggerMemDC(), nRGB );
-#endif
+	// Manual print of character. A lot faster than BitBlt, which must be avoided.
+	bgra_t *pDst = g_pDebuggerMemFramebits + (DISPLAY_HEIGHT - 1 - yDst) * DISPLAY_WIDTH + xDst; // debugger bitmap is bottom-up
+	for (int y = 0; y < CONSOLE_FONT_GRID_Y; y++)
+	{
+		for (int x = 0; x < CONSOLE_FONT_GRID_X; x++)
+		{
+			const BYTE fontpx = (nGlyph < NUM_FONT_GLYPHS) ? g_aGlyphAtlas[ nGlyph ][ y ][ x ] : 0;
+			pDst[ x ].r = (bg_r & ~fontpx) | (fg_r & fontpx);
+			pDst[ x ].g = (bg_g & ~fontpx) | (fg_g & fontpx);
+			pDst[ x ].b = (bg_b & ~fontpx) | (fg_b & fontpx);
+		}
+		pDst -= DISPLAY_WIDTH;
+	}
+}
+
+//===========================================================================
+static void ComposeDisplayCell ( const int row, const int col )
+{
+	const DisplayCell_t & cell = g_aDisplayCells[ row ][ col ];
+	DrawGlyphPixels( col * CONSOLE_FONT_WIDTH, row * CONSOLE_FONT_HEIGHT, cell.nGlyph, cell.nFG, cell.nBG );
+	g_aDisplayComposed[ row ][ col ] = cell;
+}
+
+// Called before the DIB is copied to the frame
+//===========================================================================
+static void ComposeDisplayCells ()
+{
+	for (int row = 0; row < DISPLAY_CELLS_Y; row++)
+	{
+		for (int col = 0; col < DISPLAY_CELLS_X; col++)
+		{
+			const DisplayCell_t & cell = g_aDisplayCells[ row ][ col ];
+			if ((cell.nGlyph != CELL_RAW) && (cell != g_aDisplayComposed[ row ][ col ]))
+				ComposeDisplayCell( row, col );
+		}
+	}
+}
+
+// About to draw pixels directly over these cells: compose anything drawn earlier first, then stop tracking them
+//===========================================================================
+static void DisplayCellsMarkRaw ( long left, long top, long right, long bottom )
+{
+	const int col1 = MAX( 0, (int) left / CONSOLE_FONT_WIDTH );
+	const int col2 = MIN( DISPLAY_CELLS_X - 1, (int) (right - 1) / CONSOLE_FONT_WIDTH );
+	const int row1 = MAX( 0, (int) top / CONSOLE_FONT_HEIGHT );
+	const int row2 = MIN( DISPLAY_CELLS_Y - 1, (int) (bottom - 1) / CONSOLE_FONT_HEIGHT );
+
+	for (int row = row1; row <= row2; row++)
+	{
+		for (int col = col1; col <= col2; col++)
+		{
+			DisplayCell_t & cell = g_aDisplayCells[ row ][ col ];
+			if ((cell.nGlyph != CELL_RAW) && (cell != g_aDisplayComposed[ row ][ col ]))
+				ComposeDisplayCell( row, col );
+
+			cell.nGlyph = CELL_RAW;
+			g_aDisplayComposed[ row ][ col ].nGlyph = CELL_UNKNOWN;
+		}
+	}
 }
 
 // @param glyph Specifies a native glyph from the 16x16 chars Apple Font Texture.
 //===========================================================================
 static void PrintGlyph( const int xDst, const int yDst, const int glyph )
 {	
-	HDC hDstDC = GetDebuggerMemDC();
-
-	int xSrc = (glyph % CONSOLE_FONT_NUM_CHARS_PER_ROW) * CONSOLE_FONT_GRID_X;
-	int ySrc = (glyph / CONSOLE_FONT_NUM_CHARS_PER_ROW) * CONSOLE_FONT_GRID_Y;
-	_ASSERT(ySrc < CONSOLE_FONT_BITMAP_HEIGHT);
+	_ASSERT((glyph >= 0) && (glyph < NUM_FONT_GLYPHS));
 
 	// BUG #239 - (Debugger) Save debugger "text screen" to clipboard / file
 	//	if( g_bDebuggerVirtualTextCapture )
@@ -735,21 +840,20 @@ static void PrintGlyph( const int xDst, const int yDst, const int glyph )
 			g_aDebuggerVirtualTextScreen[ row ][ col ] = glyph;
 	}
 
-	// Manual print of character. A lot faster than BitBlt, which must be avoided.
-	int index_src = (CONSOLE_FONT_BITMAP_HEIGHT - 1 - ySrc) * CONSOLE_FONT_NUM_CHARS_PER_ROW * CONSOLE_FONT_GRID_X + xSrc;   // font bitmap
-	int index_dst = (DISPLAY_HEIGHT - 1 - yDst) * DEBUG_VIRTUAL_TEXT_WIDTH * CONSOLE_FONT_GRID_X + xDst;   // debugger bitmap
-	for (int yy = 0; yy < CONSOLE_FONT_GRID_Y; yy++)
+	const int col = xDst / CONSOLE_FONT_WIDTH;
+	const int row = yDst / CONSOLE_FONT_HEIGHT;
+
+	if ((xDst % CONSOLE_FONT_WIDTH) || (yDst % CONSOLE_FONT_HEIGHT) || (col >= DISPLAY_CELLS_X) || (row >= DISPLAY_CELLS_Y))
 	{
-		for (int xx = 0; xx < CONSOLE_FONT_GRID_X; xx++)
-		{
-			char fontpx = g_hConsoleFontFramebits[index_src + xx].g;   // Should be same for R/G/B anyway (greyscale)
-			g_pDebuggerMemFramebits[index_dst + xx].r = (g_cConsoleBrushBG_r & ~fontpx) | (g_cConsoleBrushFG_r & fontpx);
-			g_pDebuggerMemFramebits[index_dst + xx].g = (g_cConsoleBrushBG_g & ~fontpx) | (g_cConsoleBrushFG_g & fontpx);
-			g_pDebuggerMemFramebits[index_dst + xx].b = (g_cConsoleBrushBG_b & ~fontpx) | (g_cConsoleBrushFG_b & fontpx);
-		}
-		index_src -= CONSOLE_FONT_NUM_CHARS_PER_ROW * CONSOLE_FONT_GRID_X;
-		index_dst -= DEBUG_VIRTUAL_TEXT_WIDTH * CONSOLE_FONT_GRID_X;
+		DisplayCellsMarkRaw( xDst, yDst, xDst + CONSOLE_FONT_WIDTH, yDst + CONSOLE_FONT_HEIGHT );
+		DrawGlyphPixels( xDst, yDst, glyph, g_nConsoleColorFG, g_nConsoleColorBG );
+		return;
 	}
+
+	DisplayCell_t & cell = g_aDisplayCells[ row ][ col ];
+	cell.nGlyph = glyph;
+	cell.nFG    = g_nConsoleColorFG;
+	cell.nBG    = g_nConsoleColorBG;
 }
 
 
@@ -859,27 +963,52 @@ void PrintTextColor ( const conchar_t *pText, RECT & rRect )
 	DebuggerPrintColor( rRect.left, rRect.top, pText );
 }
 
+// Whole cells just record the background color, partial cells are filled straight away
 //===========================================================================
 void FillBackground(long left, long top, long right, long bottom)
 {
-	long index_dst = (384-bottom) * 80 * CONSOLE_FONT_GRID_X;
+	left   = MAX( left  , 0L );
+	top    = MAX( top   , 0L );
+	right  = MIN( right , (long) DISPLAY_WIDTH  );
+	bottom = MIN( bottom, (long) DISPLAY_HEIGHT );
+	if ((left >= right) || (top >= bottom))
+		return;
 
-	for (long x = left; x < right; x++)
-	{
-		g_pDebuggerMemFramebits[index_dst + x].r = g_cConsoleBrushBG_r;
-		g_pDebuggerMemFramebits[index_dst + x].g = g_cConsoleBrushBG_g;
-		g_pDebuggerMemFramebits[index_dst + x].b = g_cConsoleBrushBG_b;
-	}
+	const COLORREF nBG = g_nConsoleColorBG;
 
-	if (top != bottom)
+	for (int row = top / CONSOLE_FONT_HEIGHT; row <= (bottom - 1) / CONSOLE_FONT_HEIGHT; row++)
 	{
-		bgra_t* src = g_pDebuggerMemFramebits + (index_dst + left);
-		bgra_t* dst = src + (80 * CONSOLE_FONT_GRID_X);
-		size_t size = (right - left) * sizeof(bgra_t);
-		for (int i = 0; i < bottom - top - 1; i++)
+		const long nCellTop    = row * CONSOLE_FONT_HEIGHT;
+		const long nCellBottom = nCellTop + CONSOLE_FONT_HEIGHT;
+
+		for (int col = left / CONSOLE_FONT_WIDTH; col <= (right - 1) / CONSOLE_FONT_WIDTH; col++)
 		{
-			memcpy((void*)dst, (void*)src, size);
-			dst += 80 * CONSOLE_FONT_GRID_X ;
+			const long nCellLeft  = col * CONSOLE_FONT_WIDTH;
+			const long nCellRight = nCellLeft + CONSOLE_FONT_WIDTH;
+
+			if ((left <= nCellLeft) && (right >= nCellRight) && (top <= nCellTop) && (bottom >= nCellBottom))
+			{
+				DisplayCell_t & cell = g_aDisplayCells[ row ][ col ];
+				cell.nGlyph = CELL_FILL;
+				cell.nFG    = 0;
+				cell.nBG    = nBG;
+				continue;
+			}
+
+			DisplayCellsMarkRaw( nCellLeft, nCellTop, nCellRight, nCellBottom );
+
+			const long x1 = MAX( left, nCellLeft ), x2 = MIN( right , nCellRight  );
+			const long y1 = MAX( top , nCellTop  ), y2 = MIN( bottom, nCellBottom );
+			for (long y = y1; y < y2; y++)
+			{
+				bgra_t *pDst = g_pDebuggerMemFramebits + (DISPLAY_HEIGHT - 1 - y) * DISPLAY_WIDTH;
+				for (long x = x1; x < x2; x++)
+				{
+					pDst[ x ].r = GetRValue( nBG );
+					pDst[ x ].g = GetGValue( nBG );
+					pDst[ x ].b = GetBValue( nBG );
+				}
+			}
 		}
 	}
 }
@@ -1332,7 +1461,7 @@ WORD DrawDisassemblyLine ( int iLine, const WORD nBaseAddress )
 	const char* pMnemonic = NULL;
 
 	// Data Disassembler
-	int bDisasmFormatFlags = GetDisassemblyLine( nBaseAddress, line );
+	int bDisasmFormatFlags = GetDisassemblyLineCached( nBaseAddress, line );
 	const DisasmData_t *pData = line.pDisasmData;
 
 //	iOpcode = line.iOpcode;	
@@ -1527,7 +1656,7 @@ WORD DrawDisassemblyLine ( int iLine, const WORD nBaseAddress )
 			// Can't use PrintTextCursorX() as that clamps chars > 0x7F to Mouse Text
 			//    char bookmark_text[2] = { 0x7F + bAddressIsBookmark, 0 };
 			//    PrintTextCursorX( bookmark_text, linerect );
-			FillRect( GetDebuggerMemDC(), &linerect, g_hConsoleBrushBG );
+			FillBackground( linerect.left, linerect.top, linerect.right, linerect.bottom );
 			PrintGlyph( linerect.left, linerect.top, 0x7F + bAddressIsBookmark ); // Glyphs 0x80 .. 0x89 = Unicode U+24EA, U+2460 .. U+2468
 			linerect.left += g_aFontConfig[ FONT_DISASM_DEFAULT ]._nFontWidthAvg;
 
@@ -3537,7 +3666,7 @@ void DrawWindowBackground_Main( int g_iWindowThis )
 	DebuggerSetColorBG( DebuggerGetColor( BG_DISASM_1 )); // COLOR_BG_CODE
 	
 #if !DEBUG_FONT_NO_BACKGROUND_FILL_MAIN
-	FillRect( GetDebuggerMemDC(), &rect, g_hConsoleBrushBG );
+	FillBackground( rect.left, rect.top, rect.right, rect.bottom );
 #endif
 }
 
@@ -3554,7 +3683,7 @@ void DrawWindowBackground_Info( int g_iWindowThis )
 	DebuggerSetColorBG( DebuggerGetColor( BG_INFO )); // COLOR_BG_DATA
 
 #if !DEBUG_FONT_NO_BACKGROUND_FILL_INFO
-	FillRect( GetDebuggerMemDC(), &rect, g_hConsoleBrushBG );
+	FillBackground( rect.left, rect.top, rect.right, rect.bottom );
 #endif
 }
 
@@ -3575,17 +3704,14 @@ void UpdateDisplay (Update_t bUpdate)
 	if (g_iWindowThis == WINDOW_CONSOLE)
 		bUpdate |= UPDATE_BACKGROUND;
 
+#if !USE_APPLE_FONT
 	if (bUpdate & UPDATE_BACKGROUND)
 	{
-#if USE_APPLE_FONT
-		SetBkMode( GetDebuggerMemDC(), OPAQUE);
-		SetBkColor(GetDebuggerMemDC(), RGB(0,0,0));
-#else
 		SelectObject( GetDebuggerMemDC(), g_aFontConfig[ FONT_INFO ]._hFont ); // g_hFontDebugger
-#endif
 	}
 
 	SetTextAlign( GetDebuggerMemDC(), TA_TOP | TA_LEFT);
+#endif
 
 	if ((bUpdate & UPDATE_BREAKPOINTS)
 //		|| (bUpdate & UPDATE_DISASM)
@@ -0,0 +1,780 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Debugger GDB Remote Stub (GDB remote serial protocol over local TCP)
+ *
+ * Author: Various
+ */
+
+#include "StdAfx.h"
+
+#include "Debug.h"
+
+#include "../Core.h"
+#include "../CPU.h"
+#include "../Interface.h"
+#include "../Log.h"
+#include "../Memory.h"
+
+// GDB Remote Stub ________________________________________________________________________________
+
+	// Same as the debugger server: socket events are posted to the frame window (WSAAsyncSelect),
+	// so everything here runs on the main thread, in between emulation periods.
+	static SOCKET      g_hGdbListenSocket = INVALID_SOCKET;
+	static SOCKET      g_hGdbClientSocket = INVALID_SOCKET;
+
+	static std::string g_sGdbReceived  ; // not parsed yet
+	static std::string g_sGdbSend      ; // not sent yet, waiting for FD_WRITE
+	static std::string g_sGdbLastPacket; // resent if the client replies '-'
+
+	static std::queue<std::string> g_qGdbPackets;
+
+	static bool        g_bGdbNoAck       = false; // QStartNoAckMode
+	static bool        g_bGdbRunning     = false; // c or s sent, stop reply owed
+	static bool        g_bGdbInterrupted = false; // ^C received while running
+	static int         g_nGdbSignal      = 0    ; // last stop reply
+
+	static const UINT  GDB_MAX_REPLY_DATA = GDB_STUB_PACKET_SIZE - 4; // "$data#cs" must fit in the advertised PacketSize
+
+	enum GdbSignal_e
+	{
+		GDB_SIGINT  = 2,
+		GDB_SIGILL  = 4,
+		GDB_SIGTRAP = 5,
+	};
+
+
+// Packets ________________________________________________________________________________________
+
+//===========================================================================
+static int _GdbHexDigit ( const char c )
+{
+	if ((c >= '0') && (c <= '9')) return c - '0';
+	if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+	if ((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+	return -1;
+}
+
+// @return false if there are no hex digits at pText_
+//===========================================================================
+static bool _GdbParseHex ( const char * & pText_, UINT & nValue_ )
+{
+	nValue_ = 0;
+
+	const char *pStart = pText_;
+	int nDigit;
+	while ((nDigit = _GdbHexDigit( *pText_ )) >= 0)
+	{
+		nValue_ = (nValue_ << 4) | nDigit;
+		pText_++;
+	}
+
+	return pText_ != pStart;
+}
+
+// "addr,len" as used by m, M, Z, z and the batched memory packets
+//===========================================================================
+static bool _GdbParseAddressLength ( const char * & pText_, UINT & nAddress_, UINT & nLength_ )
+{
+	if (!_GdbParseHex( pText_, nAddress_ ) || (*pText_++ != ','))
+		return false;
+	if (!_GdbParseHex( pText_, nLength_ ))
+		return false;
+
+	return nAddress_ <= _6502_MEM_END;
+}
+
+//===========================================================================
+static void _GdbAppendByte ( std::string & sReply_, const BYTE nByte )
+{
+	static const char aHex[] = "0123456789abcdef";
+	sReply_ += aHex[ nByte >> 4  ];
+	sReply_ += aHex[ nByte & 0xF ];
+}
+
+// Reads past the end of memory, or more than fits in the reply packet, are cut short, which GDB accepts
+//===========================================================================
+static void _GdbAppendMemory ( std::string & sReply_, const UINT nAddress, const UINT nLength )
+{
+	const UINT nRoom = (sReply_.size() < GDB_MAX_REPLY_DATA) ? (UINT)(GDB_MAX_REPLY_DATA - sReply_.size()) / 2 : 0;
+	const UINT nEnd  = MIN( nAddress + MIN( nLength, nRoom ), (UINT) _6502_MEM_LEN );
+	for (UINT nByte = nAddress; nByte < nEnd; nByte++)
+		_GdbAppendByte( sReply_, *(mem + nByte) );
+}
+
+// Same as the debugger's memory edit: writes the paged in 64K, no I/O
+//===========================================================================
+static bool _GdbWriteMemory ( const char * & pText_, const UINT nAddress, const UINT nLength )
+{
+	if (nAddress + nLength > _6502_MEM_LEN)
+		return false;
+
+	for (UINT iChar = 0; iChar < nLength * 2; iChar++)
+		if (_GdbHexDigit( pText_[ iChar ] ) < 0)
+			return false;
+
+	for (UINT nByte = nAddress; nByte < nAddress + nLength; nByte++)
+	{
+		*(mem + nByte) = (BYTE)((_GdbHexDigit( pText_[0] ) << 4) | _GdbHexDigit( pText_[1] ));
+		*(memdirty + (nByte >> 8)) = 1;
+		pText_ += 2;
+	}
+
+	return true;
+}
+
+//===========================================================================
+static int _GdbRegisterSize ( const int iRegister )
+{
+	return (iRegister == GDB_REG_PC) ? 2 : 1;
+}
+
+//===========================================================================
+static UINT _GdbGetRegister ( const int iRegister )
+{
+	switch (iRegister)
+	{
+		case GDB_REG_A : return regs.a;
+		case GDB_REG_X : return regs.x;
+		case GDB_REG_Y : return regs.y;
+		case GDB_REG_P : return regs.ps;
+		case GDB_REG_SP: return regs.sp & 0xFF;
+		case GDB_REG_PC: return regs.pc;
+		default        : return 0;
+	}
+}
+
+//===========================================================================
+static void _GdbSetRegister ( const int iRegister, const UINT nValue )
+{
+	switch (iRegister)
+	{
+		case GDB_REG_A : regs.a  = (BYTE) nValue; break;
+		case GDB_REG_X : regs.x  = (BYTE) nValue; break;
+		case GDB_REG_Y : regs.y  = (BYTE) nValue; break;
+		case GDB_REG_P : regs.ps = (BYTE) nValue; break;
+		case GDB_REG_SP: regs.sp = 0x100 | (nValue & 0xFF); break;
+		case GDB_REG_PC: regs.pc = (WORD) nValue; break;
+		default        : break;
+	}
+}
+
+// Little-endian
+//===========================================================================
+static void _GdbAppendRegister ( std::string & sReply_, const int iRegister )
+{
+	const UINT nValue = _GdbGetRegister( iRegister );
+	for (int iByte = 0; iByte < _GdbRegisterSize( iRegister ); iByte++)
+		_GdbAppendByte( sReply_, (BYTE)(nValue >> (iByte * 8)) );
+}
+
+//===========================================================================
+static bool _GdbParseRegister ( const char * & pText_, const int iRegister, UINT & nValue_ )
+{
+	nValue_ = 0;
+	for (int iByte = 0; iByte < _GdbRegisterSize( iRegister ); iByte++)
+	{
+		const int nHi = _GdbHexDigit( pText_[0] );
+		const int nLo = (nHi < 0) ? -1 : _GdbHexDigit( pText_[1] );
+		if (nLo < 0)
+			return false;
+
+		nValue_ |= ((nHi << 4) | nLo) << (iByte * 8);
+		pText_ += 2;
+	}
+
+	return true;
+}
+
+//===========================================================================
+static void _GdbSendRaw ( const std::string & sData )
+{
+	if (g_hGdbClientSocket == INVALID_SOCKET)
+		return;
+
+	g_sGdbSend += sData;
+	GdbStubSend();
+}
+
+// Replies are plain ASCII, so nothing needs escaping
+//===========================================================================
+static void _GdbSendPacket ( const std::string & sData )
+{
+	BYTE nChecksum = 0;
+	for (size_t iChar = 0; iChar < sData.size(); iChar++)
+		nChecksum += (BYTE) sData[ iChar ];
+
+	g_sGdbLastPacket = "$";
+	g_sGdbLastPacket += sData;
+	g_sGdbLastPacket += '#';
+	_GdbAppendByte( g_sGdbLastPacket, nChecksum );
+
+	_GdbSendRaw( g_sGdbLastPacket );
+}
+
+// Packets are only executed in MODE_DEBUG, same as the debugger server
+//===========================================================================
+static void _GdbEnterDebugger ()
+{
+	switch (g_nAppMode)
+	{
+		case MODE_RUNNING:
+		case MODE_PAUSED:
+			DebugBegin();
+			GdbStubStopped( BP_HIT_NONE, 0 ); // DebugBegin() doesn't go via DebugContinueStepping()
+			break;
+		case MODE_STEPPING:
+			DebugStopStepping(); // Enters MODE_DEBUG on the next DebugContinueStepping()
+			break;
+		default:
+			break;
+	}
+}
+
+// Splits the received data into packets: $data#cs, acks, and ^C
+//===========================================================================
+static void _GdbParse ()
+{
+	size_t iPos = 0;
+	while (iPos < g_sGdbReceived.size())
+	{
+		const char c = g_sGdbReceived[ iPos ];
+		if (c == '$')
+		{
+			const size_t iEnd = g_sGdbReceived.find( '#', iPos );
+			if ((iEnd == std::string::npos) || (iEnd + 2 >= g_sGdbReceived.size()))
+				break; // Incomplete, wait for more
+
+			const std::string sData = g_sGdbReceived.substr( iPos + 1, iEnd - iPos - 1 );
+
+			BYTE nChecksum = 0;
+			for (size_t iChar = 0; iChar < sData.size(); iChar++)
+				nChecksum += (BYTE) sData[ iChar ];
+
+			const int nHi = _GdbHexDigit( g_sGdbReceived[ iEnd + 1 ] );
+			const int nLo = _GdbHexDigit( g_sGdbReceived[ iEnd + 2 ] );
+
+			if (g_bGdbNoAck || ((nHi >= 0) && (nLo >= 0) && (((nHi << 4) | nLo) == nChecksum)))
+			{
+				if (!g_bGdbNoAck)
+					_GdbSendRaw( "+" );
+				g_qGdbPackets.push( sData );
+			}
+			else
+			{
+				_GdbSendRaw( "-" );
+			}
+
+			iPos = iEnd + 3;
+		}
+		else
+		{
+			if (c == 0x03) // ^C
+			{
+				if (g_bGdbRunning)
+				{
+					g_bGdbInterrupted = true;
+					_GdbEnterDebugger();
+				}
+			}
+			else
+			if ((c == '-') && !g_bGdbNoAck)
+			{
+				_GdbSendRaw( g_sGdbLastPacket );
+			}
+
+			iPos++; // '+' or noise
+		}
+	}
+
+	g_sGdbReceived.erase( 0, iPos );
+}
+
+
+// Commands _______________________________________________________________________________________
+
+// Z/z type,addr,kind
+//===========================================================================
+static std::string _GdbBreakpoint ( const bool bAdd, const char *pText )
+{
+	UINT nType;
+	UINT nAddress;
+	UINT nLength;
+	if (!_GdbParseHex( pText, nType ) || (*pText++ != ',') || !_GdbParseAddressLength( pText, nAddress, nLength ))
+		return "E01";
+
+	BreakpointSource_t iSrc;
+	switch (nType)
+	{
+		case 0: // software
+		case 1: // hardware
+			iSrc    = BP_SRC_REG_PC;
+			nLength = 1;
+			break;
+		case 2: iSrc = BP_SRC_MEM_WRITE_ONLY; break;
+		case 3: iSrc = BP_SRC_MEM_READ_ONLY ; break;
+		case 4: iSrc = BP_SRC_MEM_RW        ; break;
+		default:
+			return ""; // Not supported
+	}
+
+	if (!nLength)
+		nLength = 1;
+
+	if (bAdd)
+		return (BreakpointAdd( iSrc, (WORD) nAddress, (int) nLength ) >= 0) ? "OK" : "E0E";
+
+	BreakpointRemove( iSrc, (WORD) nAddress, (int) nLength ); // Already gone is fine
+	return "OK";
+}
+
+// qAppleWin.MemRead:addr,len;addr,len;...
+//===========================================================================
+static std::string _GdbMemReadBatch ( const char *pText )
+{
+	std::string sReply;
+	while (*pText)
+	{
+		UINT nAddress;
+		UINT nLength;
+		if (!_GdbParseAddressLength( pText, nAddress, nLength ))
+			return "E01";
+
+		if (!sReply.empty())
+			sReply += ';';
+		_GdbAppendMemory( sReply, nAddress, nLength );
+
+		if (*pText == ';')
+			pText++;
+		else
+		if (*pText)
+			return "E01";
+	}
+	return sReply;
+}
+
+// QAppleWin.MemWrite:addr,len:hex;addr,len:hex;...
+//===========================================================================
+static std::string _GdbMemWriteBatch ( const char *pText )
+{
+	while (*pText)
+	{
+		UINT nAddress;
+		UINT nLength;
+		if (!_GdbParseAddressLength( pText, nAddress, nLength ) || (*pText++ != ':') || !_GdbWriteMemory( pText, nAddress, nLength ))
+			return "E01";
+
+		if (*pText == ';')
+			pText++;
+		else
+		if (*pText)
+			return "E01";
+	}
+	return "OK";
+}
+
+//===========================================================================
+static std::string _GdbQuery ( const std::string & sPacket )
+{
+	static const char sMemRead [] = "qAppleWin.MemRead:";
+	static const char sMemWrite[] = "QAppleWin.MemWrite:";
+
+	if (sPacket.compare( 0, 10, "qSupported" ) == 0)
+	{
+		char sReply[ 64 ];
+		sprintf( sReply, "PacketSize=%X;QStartNoAckMode+", GDB_STUB_PACKET_SIZE );
+		return sReply;
+	}
+	if (sPacket == "qAttached"   ) return "1";
+	if (sPacket == "qC"          ) return "QC1";
+	if (sPacket == "qfThreadInfo") return "m1";
+	if (sPacket == "qsThreadInfo") return "l";
+	if (sPacket.compare( 0, sizeof(sMemRead ) - 1, sMemRead  ) == 0) return _GdbMemReadBatch ( sPacket.c_str() + sizeof(sMemRead ) - 1 );
+	if (sPacket.compare( 0, sizeof(sMemWrite) - 1, sMemWrite ) == 0) return _GdbMemWriteBatch( sPacket.c_str() + sizeof(sMemWrite) - 1 );
+
+	return ""; // Not supported
+}
+
+// c [addr] or s [addr]
+//===========================================================================
+static void _GdbResume ( const char *pText, const bool bStep )
+{
+	UINT nAddress;
+	if (_GdbParseHex( pText, nAddress ))
+		regs.pc = (WORD) nAddress;
+
+	g_bGdbRunning     = true; // Before the command: a single step completes (and replies, via GdbStubStopped) before returning
+	g_bGdbInterrupted = false;
+
+	DebuggerProcessCommandText( bStep ? "T" : "G" );
+
+	// Still in MODE_DEBUG (eg. the command returned early), so no stop reply would ever be sent
+	if (g_bGdbRunning && (g_nAppMode != MODE_STEPPING) && (g_nAppMode != MODE_RUNNING))
+		GdbStubStopped( BP_HIT_NONE, 0 );
+}
+
+// @param bRefresh_ Set if the debugger display is out of date
+//===========================================================================
+static void _GdbExecute ( const std::string & sPacket, bool & bRefresh_ )
+{
+	const char *pText = sPacket.c_str() + 1;
+	std::string sReply;
+	char sTemp[ 16 ];
+
+	UINT nAddress;
+	UINT nLength;
+	UINT nValue;
+
+	switch (sPacket.empty() ? 0 : sPacket[0])
+	{
+		case '?':
+			sprintf( sTemp, "S%02X", g_nGdbSignal );
+			sReply = sTemp;
+			break;
+
+		case 'g':
+			for (int iRegister = 0; iRegister < NUM_GDB_REGS; iRegister++)
+				_GdbAppendRegister( sReply, iRegister );
+			break;
+
+		case 'G':
+		{
+			UINT aValues[ NUM_GDB_REGS ];
+			sReply = "OK";
+			for (int iRegister = 0; iRegister < NUM_GDB_REGS; iRegister++)
+				if (!_GdbParseRegister( pText, iRegister, aValues[ iRegister ] ))
+					sReply = "E01";
+
+			if (sReply == "OK")
+			{
+				for (int iRegister = 0; iRegister < NUM_GDB_REGS; iRegister++)
+					_GdbSetRegister( iRegister, aValues[ iRegister ] );
+				bRefresh_ = true;
+			}
+			break;
+		}
+
+		case 'p':
+			if (_GdbParseHex( pText, nValue ) && (nValue < NUM_GDB_REGS))
+				_GdbAppendRegister( sReply, nValue );
+			else
+				sReply = "E01";
+			break;
+
+		case 'P':
+		{
+			UINT iRegister;
+			if (_GdbParseHex( pText, iRegister ) && (iRegister < NUM_GDB_REGS) && (*pText++ == '=') && _GdbParseRegister( pText, iRegister, nValue ))
+			{
+				_GdbSetRegister( iRegister, nValue );
+				bRefresh_ = true;
+				sReply = "OK";
+			}
+			else
+				sReply = "E01";
+			break;
+		}
+
+		case 'm':
+			if (_GdbParseAddressLength( pText, nAddress, nLength ))
+				_GdbAppendMemory( sReply, nAddress, nLength );
+			else
+				sReply = "E01";
+			break;
+
+		case 'M':
+			if (_GdbParseAddressLength( pText, nAddress, nLength ) && (*pText++ == ':') && _GdbWriteMemory( pText, nAddress, nLength ))
+			{
+				bRefresh_ = true;
+				sReply = "OK";
+			}
+			else
+				sReply = "E01";
+			break;
+
+		case 'Z':
+		case 'z':
+			sReply = _GdbBreakpoint( sPacket[0] == 'Z', pText );
+			bRefresh_ = true;
+			break;
+
+		case 'c':
+		case 's':
+			_GdbResume( pText, sPacket[0] == 's' );
+			return; // Stop reply is sent once the debugger stops
+
+		case 'D':
+			_GdbSendPacket( "OK" );
+			DebugExitDebugger(); // GDB expects the target to run after detaching
+			GdbStubClose();      // NB. After resuming, as the next waiting client's attach stops the target again
+			return;
+
+		case 'k':
+			GdbStubClose();
+			return;
+
+		case 'H':
+			sReply = "OK"; // Only 1 thread
+			break;
+
+		case 'Q':
+			if (sPacket == "QStartNoAckMode")
+			{
+				_GdbSendPacket( "OK" ); // The client still acks this reply
+				g_bGdbNoAck = true;
+				return;
+			}
+			// fall through
+		case 'q':
+			sReply = _GdbQuery( sPacket );
+			break;
+
+		default:
+			break; // Empty reply: not supported
+	}
+
+	_GdbSendPacket( sReply );
+}
+
+
+// Socket _________________________________________________________________________________________
+
+//===========================================================================
+bool GdbStubStart ( UINT nPort )
+{
+	if (g_hGdbListenSocket != INVALID_SOCKET)
+		return true;
+
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) // Winsock 2.2
+		return false;
+
+	g_hGdbListenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (g_hGdbListenSocket == INVALID_SOCKET)
+	{
+		WSACleanup();
+		return false;
+	}
+
+	// Loopback only: the client can read and write all of memory
+	SOCKADDR_IN saAddress;
+	memset(&saAddress, 0, sizeof(SOCKADDR_IN));
+	saAddress.sin_family = AF_INET;
+	saAddress.sin_port = htons((u_short)nPort);
+	saAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if ((bind(g_hGdbListenSocket, (LPSOCKADDR)&saAddress, sizeof(saAddress)) == SOCKET_ERROR)
+	||  (listen(g_hGdbListenSocket, 1) == SOCKET_ERROR)
+	||  (WSAAsyncSelect(g_hGdbListenSocket, GetFrame().g_hFrameWindow, WM_USER_GDB_STUB, (FD_ACCEPT | FD_READ | FD_WRITE | FD_CLOSE)) != 0))
+	{
+		LogFileOutput("GDB Stub: failed to listen on port %u (%d)\n", nPort, WSAGetLastError());
+		closesocket(g_hGdbListenSocket);
+		g_hGdbListenSocket = INVALID_SOCKET;
+		WSACleanup();
+		return false;
+	}
+
+	LogFileOutput("GDB Stub: listening on port %u\n", nPort);
+	return true;
+}
+
+//===========================================================================
+void GdbStubStop ()
+{
+	if (g_hGdbListenSocket == INVALID_SOCKET)
+		return;
+
+	WSAAsyncSelect(g_hGdbListenSocket, GetFrame().g_hFrameWindow, 0, 0); // Stop event messages
+	closesocket(g_hGdbListenSocket);
+	g_hGdbListenSocket = INVALID_SOCKET;
+
+	GdbStubClose();
+
+	WSACleanup();
+}
+
+// One client at a time, further connections wait in the listen backlog
+// NB. FD_ACCEPT is only posted again after accept() is called, so GdbStubClose() accepts the next waiting client
+//===========================================================================
+void GdbStubAccept ()
+{
+	if ((g_hGdbListenSocket == INVALID_SOCKET) || (g_hGdbClientSocket != INVALID_SOCKET))
+		return;
+
+	g_hGdbClientSocket = accept(g_hGdbListenSocket, NULL, NULL);
+	if (g_hGdbClientSocket == INVALID_SOCKET)
+		return;
+
+	// Small request/reply packets: don't wait to coalesce them
+	BOOL bNoDelay = TRUE;
+	setsockopt(g_hGdbClientSocket, IPPROTO_TCP, TCP_NODELAY, (const char*)&bNoDelay, sizeof(bNoDelay));
+
+	g_bGdbNoAck       = false;
+	g_bGdbRunning     = false;
+	g_bGdbInterrupted = false;
+	g_nGdbSignal      = GDB_SIGTRAP;
+
+	_GdbEnterDebugger(); // Attaching stops the target
+}
+
+//===========================================================================
+void GdbStubClose ()
+{
+	if (g_hGdbClientSocket != INVALID_SOCKET)
+	{
+		shutdown(g_hGdbClientSocket, 2 /* SD_BOTH */);
+		closesocket(g_hGdbClientSocket);
+		g_hGdbClientSocket = INVALID_SOCKET;
+	}
+
+	g_sGdbReceived.clear();
+	g_sGdbSend.clear();
+	g_sGdbLastPacket.clear();
+	while (!g_qGdbPackets.empty())
+		g_qGdbPackets.pop();
+
+	g_bGdbRunning = false;
+
+	GdbStubAccept(); // Next client in the listen backlog (if any)
+}
+
+//===========================================================================
+void GdbStubReceive ()
+{
+	if (g_hGdbClientSocket == INVALID_SOCKET)
+		return;
+
+	char aData[ 0x400 ];
+	int nReceived = 0;
+	while ((nReceived = recv(g_hGdbClientSocket, aData, sizeof(aData), 0)) > 0)
+	{
+		g_sGdbReceived.append( aData, nReceived );
+		_GdbParse();
+
+		if (g_sGdbReceived.size() > 2 * GDB_STUB_PACKET_SIZE)
+		{
+			LogFileOutput("GDB Stub: packet too long, closing connection\n");
+			GdbStubClose();
+			return;
+		}
+	}
+
+	if (!g_qGdbPackets.empty())
+	{
+		_GdbEnterDebugger();
+		GdbStubUpdate();
+	}
+}
+
+// Called for FD_WRITE, when the socket can take more of the pending output
+//===========================================================================
+void GdbStubSend ()
+{
+	while ((g_hGdbClientSocket != INVALID_SOCKET) && !g_sGdbSend.empty())
+	{
+		const int nSent = send(g_hGdbClientSocket, g_sGdbSend.data(), (int)g_sGdbSend.size(), 0);
+		if (nSent == SOCKET_ERROR)
+		{
+			if (WSAGetLastError() != WSAEWOULDBLOCK)
+				GdbStubClose();
+			return;
+		}
+
+		g_sGdbSend.erase(0, nSent);
+	}
+}
+
+// Execute pending packets, until one of them resumes emulation
+//===========================================================================
+void GdbStubUpdate ()
+{
+	if (g_qGdbPackets.empty())
+		return;
+
+	if (g_nAppMode == MODE_LOGO)
+	{
+		while (!g_qGdbPackets.empty())
+		{
+			_GdbSendPacket( "E01" ); // Emulation not started
+			g_qGdbPackets.pop();
+		}
+		return;
+	}
+
+	bool bRefresh = false;
+	while (!g_qGdbPackets.empty() && (g_nAppMode == MODE_DEBUG) && !g_bGdbRunning)
+	{
+		const std::string sPacket = g_qGdbPackets.front();
+		g_qGdbPackets.pop();
+
+		_GdbExecute( sPacket, bRefresh );
+	}
+
+	if (bRefresh && (g_nAppMode == MODE_DEBUG))
+		DebugDisplay( TRUE );
+}
+
+// Called once the debugger stops (MODE_DEBUG), sends the stop reply for c/s/^C
+// T05 with PC and SP, plus the address for a memory breakpoint
+//===========================================================================
+void GdbStubStopped ( const int bBreakpointHit, const WORD nMemoryAddress )
+{
+	if ((g_hGdbClientSocket == INVALID_SOCKET) || !g_bGdbRunning)
+		return;
+
+	g_bGdbRunning = false;
+
+	g_nGdbSignal = GDB_SIGTRAP;
+	if (g_bGdbInterrupted)
+		g_nGdbSignal = GDB_SIGINT;
+	else
+	if (bBreakpointHit & BP_HIT_INVALID)
+		g_nGdbSignal = GDB_SIGILL;
+	g_bGdbInterrupted = false;
+
+	char sTemp[ 32 ];
+	sprintf( sTemp, "T%02X", g_nGdbSignal );
+	std::string sReply = sTemp;
+
+	const char *pWatch = (bBreakpointHit & BP_HIT_MEMW) ? "watch"
+	                   : (bBreakpointHit & BP_HIT_MEMR) ? "rwatch"
+	                   : (bBreakpointHit & BP_HIT_MEM ) ? "awatch"
+	                   : NULL;
+	if (pWatch)
+	{
+		sprintf( sTemp, "%s:%04x;", pWatch, nMemoryAddress );
+		sReply += sTemp;
+	}
+
+	// Expedite the registers an IDE needs first
+	const int aExpedite[] = { GDB_REG_PC, GDB_REG_SP };
+	for (int iExpedite = 0; iExpedite < 2; iExpedite++)
+	{
+		sprintf( sTemp, "%02x:", aExpedite[ iExpedite ] );
+		sReply += sTemp;
+		_GdbAppendRegister( sReply, aExpedite[ iExpedite ] );
+		sReply += ';';
+	}
+
+	_GdbSendPacket( sReply );
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// GDB Remote Stub ________________________________________________________________________________
+
+	// GDB remote serial protocol (all-stop), enabled with the command line: -gdb-server <port>
+	// Listens on the loopback interface only, and accepts one client at a time.
+	// Connecting, or any packet received while running, breaks into the debugger.
+	// Register numbers for g/G/p/P, values are little-endian hex:
+	//   0:A 1:X 2:Y 3:P 4:SP (low byte) 5:PC (2 bytes)
+	// Memory (m/M) is the 64K as currently paged in, same as the debugger's memory view; I/O isn't triggered.
+	// Breakpoints: Z0/Z1 = BPX, Z2 = BPMW, Z3 = BPMR, Z4 = BPM. z only removes breakpoints that Z set, not the user's own.
+	// Memory reads (m, qAppleWin.MemRead) are cut short to fit the PacketSize reported by qSupported.
+	// Batched memory, to refresh several views in one round trip:
+	//   qAppleWin.MemRead:addr,len;addr,len;...        -> hex;hex;...
+	//   QAppleWin.MemWrite:addr,len:hex;addr,len:hex;... -> OK
+	enum
+	{
+		GDB_STUB_PACKET_SIZE = 0x4000, // client is dropped if more than twice this is waiting to be parsed
+
+		GDB_REG_A = 0,
+		GDB_REG_X,
+		GDB_REG_Y,
+		GDB_REG_P,
+		GDB_REG_SP,
+		GDB_REG_PC,
+		NUM_GDB_REGS
+	};
+
+	bool GdbStubStart   ( UINT nPort );
+	void GdbStubStop    ();
+	void GdbStubAccept  ();
+	void GdbStubReceive ();
+	void GdbStubSend    ();
+	void GdbStubClose   ();
+	void GdbStubUpdate  ();
+	void GdbStubStopped ( const int bBreakpointHit, const WORD nMemoryAddress );
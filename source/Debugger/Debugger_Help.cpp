@@ -915,6 +915,59 @@ Update_t CmdHelpSpecific (int nArgs)
 				, g_aParameters[ PARAM_LIST  ].m_sName
 			);
 			ConsoleBufferPush( " No arguments resets the profile." );
+			ConsoleColorizePrintFormat( sTemp, sText, " Usage: %s [%s | %s | %s | %s | %s]"
+				, g_aParameters[ PARAM_CALLS ].m_sName
+				, g_aParameters[ PARAM_ON    ].m_sName
+				, g_aParameters[ PARAM_OFF   ].m_sName
+				, g_aParameters[ PARAM_RESET ].m_sName
+				, g_aParameters[ PARAM_LIST  ].m_sName
+				, g_aParameters[ PARAM_SAVE  ].m_sName
+			);
+			ConsoleBufferPush( "  Call profile: calls, inclusive and exclusive cycles per JSR/IRQ target." );
+			ConsoleBufferPush( "  No argument lists the top routines. SAVE writes all to CallProfile.txt" );
+			break;
+		case CMD_COVERAGE:
+			ConsoleColorizePrintFormat( sTemp, sText, " Usage: [%s | %s | %s | %s [\"file\"] | %s range [\"file\"]]"
+				, g_aParameters[ PARAM_ON    ].m_sName
+				, g_aParameters[ PARAM_OFF   ].m_sName
+				, g_aParameters[ PARAM_RESET ].m_sName
+				, g_aParameters[ PARAM_SAVE  ].m_sName
+				, g_aParameters[ PARAM_LIST  ].m_sName
+			);
+			ConsoleBufferPush( "  Executed opcodes and branch directions, per bank (main, aux, ROM)." );
+			ConsoleBufferPush( "  No argument shows a summary. SAVE writes Coverage.txt" );
+			ConsoleBufferPush( "  LIST writes annotated disassembly to CoverageListing.txt" );
+			ConsoleBufferPush( "  * = executed, T = branch taken, N = not taken, B = both" );
+			Help_Examples();
+			ConsolePrintFormat( sText, "%s   %s %s 800:BFF", CHC_EXAMPLE, pCommand->m_sName, g_aParameters[ PARAM_LIST ].m_sName );
+			break;
+		case CMD_IOSTATS:
+			ConsoleColorizePrintFormat( sTemp, sText, " Usage: [%s [n] | %s | %s [n] | %s | %s [\"file\"]]"
+				, g_aParameters[ PARAM_ON    ].m_sName
+				, g_aParameters[ PARAM_OFF   ].m_sName
+				, g_aParameters[ PARAM_RESET ].m_sName
+				, g_aParameters[ PARAM_LIST  ].m_sName
+				, g_aParameters[ PARAM_SAVE  ].m_sName
+			);
+			ConsoleBufferPush( "  Counts CPU reads/writes of each $C000..$CFFF address." );
+			ConsoleBufferPush( "  Timeline records the cycle of every n'th access (default 1)." );
+			ConsoleBufferPush( "  No argument lists the most accessed. SAVE writes IOStats.txt" );
+			Help_Examples();
+			ConsolePrintFormat( sText, "%s   %s %s 10", CHC_EXAMPLE, pCommand->m_sName, g_aParameters[ PARAM_ON ].m_sName );
+			break;
+		case CMD_CYCLEAUDIT:
+			ConsoleColorizePrintFormat( sTemp, sText, " Usage: [%s | %s | %s | %s | %s [\"file\"]]"
+				, g_aParameters[ PARAM_ON    ].m_sName
+				, g_aParameters[ PARAM_OFF   ].m_sName
+				, g_aParameters[ PARAM_RESET ].m_sName
+				, g_aParameters[ PARAM_LIST  ].m_sName
+				, g_aParameters[ PARAM_SAVE  ].m_sName
+			);
+			ConsoleBufferPush( "  Checks the cycles charged for each opcode against the datasheet," );
+			ConsoleBufferPush( "  per path: page crossed, branch taken, 65C02 decimal mode." );
+			ConsoleBufferPush( "  No argument lists mismatches. SAVE writes CycleAudit.txt" );
+			Help_Examples();
+			ConsolePrintFormat( sText, "%s   %s %s", CHC_EXAMPLE, pCommand->m_sName, g_aParameters[ PARAM_ON ].m_sName );
 			break;
 	// Registers
 		case CMD_REGISTER_SET:
@@ -953,9 +1006,38 @@ Update_t CmdHelpSpecific (int nArgs)
 			ConsoleBufferPush( "  JSR will be stepped into" );
 			ConsoleBufferPush( "  Hotkey: Shift-Space" );
 			break;
+		case CMD_TRACE_BUFFER:
+			ConsoleColorizePrint( sText, " Usage: [v]" );
+			ConsoleBufferPush( "  Records the last 1M instructions to a memory ring buffer." );
+			ConsoleBufferPush( "  Use TFD to decode the ring buffer to a text file." );
+			break;
 		case CMD_TRACE_FILE:
 			ConsoleColorizePrint( sText, " Usage: \"[filename]\" [v]" );
 			break;
+		case CMD_TRACE_FILE_BINARY:
+			ConsoleColorizePrint( sText, " Usage: \"[filename]\" [v]" );
+			ConsoleBufferPush( "  Much faster than TF. Use TFD to decode the file." );
+			break;
+		case CMD_TRACE_FILE_DECODE:
+			ConsoleColorizePrint( sText, " Usage: [\"binary filename\" [\"text filename\"]]" );
+			ConsoleBufferPush( "  Disassembles a binary trace file (or the TB ring buffer) with symbols." );
+			break;
+		case CMD_TRACE_REVERSE:
+			ConsoleColorizePrint( sText, " Usage: [#]" );
+			ConsoleBufferPush( "  Steps backwards, # times, to the previous instruction(s)" );
+			ConsoleBufferPush( "  Needs: HISTORY ON" );
+			break;
+		case CMD_GO_REVERSE:
+			ConsoleBufferPush( "  Steps backwards until a PC breakpoint, or an instruction" );
+			ConsoleBufferPush( "  that accessed memory with a memory breakpoint." );
+			ConsoleBufferPush( "  i.e. Find what last wrote to an address: BPMW addr, GR" );
+			ConsoleBufferPush( "  Needs: HISTORY ON" );
+			break;
+		case CMD_HISTORY:
+			ConsoleColorizePrint( sText, " Usage: [ON | OFF]" );
+			ConsoleBufferPush( "  Records registers, memory writes and I/O accesses of the last 64K instructions." );
+			ConsoleBufferPush( "  NB. Only the CPU and memory are reversed, not peripherals or cycles." );
+			break;
 		case CMD_TRACE_LINE:
 			ConsoleColorizePrint( sText, " Usage: [#]" );
 			ConsoleBufferPush( "  Traces into current instruction" );
@@ -1037,6 +1119,19 @@ Update_t CmdHelpSpecific (int nArgs)
 			ConsoleColorizePrint( sText, " Usage: [address]" );
 			ConsoleBufferPush( "  Sets a breakpoint at the current PC or at the specified address." );
 			break;
+		case CMD_BREAKPOINT_IF:
+			ConsoleColorizePrint( sText, " Usage: # [expression]" );
+			ConsoleBufferPush( "  Breakpoint # only breaks when the expression is non-zero." );
+			ConsoleBufferPush( "  No expression removes the condition." );
+			ConsoleBufferPush( "  Values: A X Y PC S P, C Z I D B R V N, OP, CYCLES, HITS, symbol, hex" );
+			ConsoleBufferPush( "  [addr] = byte, {addr} = word. Use $ for hex that is a name, ie. $C" );
+			ConsoleBufferPush( "  Operators (C): * / % + - << >> < <= > >= == != & ^ | && || ! ~ -" );
+			Help_Examples();
+			ConsolePrintFormat( sText, "%s   %s 0 A == 8D && [FE] != 0" , CHC_EXAMPLE, pCommand->m_sName );
+			ConsolePrintFormat( sText, "%s   %s 1 {3C} >= 2000 || C"    , CHC_EXAMPLE, pCommand->m_sName );
+			ConsolePrintFormat( sText, "%s   %s 2 HITS == 100"          , CHC_EXAMPLE, pCommand->m_sName );
+			ConsolePrintFormat( sText, "%s   %s 2"                      , CHC_EXAMPLE, pCommand->m_sName );
+			break;
 		case CMD_BREAKPOINT_CLEAR:
 			ConsoleColorizePrint( sText, " Usage: [# | *]" );
 			ConsoleBufferPush( "  Clears specified breakpoint, or all." );
@@ -1314,6 +1409,16 @@ Update_t CmdHelpSpecific (int nArgs)
 			ConsolePrintFormat( sText, "%s   %s F000:FFFF C030"   , CHC_EXAMPLE, pCommand->m_sName );
 			ConsolePrintFormat( sText, "%s   U @1 - 1"            , CHC_EXAMPLE                    );
 			break;
+		case CMD_MEMORY_SEARCH_ALL:
+			ConsoleColorizePrint( sText, " Usage: range <\"ASCII text\" | 'apple text' | hex>" );
+			Help_Range();
+			ConsoleBufferPush( "  Same as S, but searches main, aux, RamWorks and Language Card banks" );
+			ConsoleBufferPush( "  Results are shown as: #:R<bank>:$address or #:L<bank>:$address" );
+			ConsoleBufferPush( "  Language Card banks are $C000..$FFFF; $C000..$CFFF is $D000 bank 2" );
+			Help_Examples();
+			ConsolePrintFormat( sText, "%s   %s 0:FFFF 'PRODOS'", CHC_EXAMPLE, pCommand->m_sName );
+			ConsolePrintFormat( sText, "%s   %s D000:FFFF 20 ? BF", CHC_EXAMPLE, pCommand->m_sName );
+			break;
 //		case CMD_MEMORY_SEARCH_APPLE:
 //			ConsoleBufferPushFormat( sText,   TEXT("Deprecated.  Use: %s" ), g_aCommands[ CMD_MEMORY_SEARCH ].m_sName );
 //			break;
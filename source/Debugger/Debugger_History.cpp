@@ -0,0 +1,125 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Debugger Execution History (reverse stepping)
+ *
+ * Author: Various
+ */
+
+#include "StdAfx.h"
+
+#include "Debug.h"
+
+#include "../CPU.h"
+#include "../Memory.h"
+
+// Execution History ______________________________________________________________________________
+
+	DebugHistory_t g_DebugHistory;
+
+//===========================================================================
+void HistoryReset ()
+{
+	g_DebugHistory.nSteps    = 0;
+	g_DebugHistory.nAccesses = 0;
+	g_DebugHistory.nValid    = 0;
+}
+
+//===========================================================================
+void HistoryStart ()
+{
+	if (!g_DebugHistory.pSteps)
+	{
+		g_DebugHistory.pSteps    = new HistoryStep_t  [ HISTORY_NUM_STEPS    ];
+		g_DebugHistory.pAccesses = new HistoryAccess_t[ HISTORY_NUM_ACCESSES ];
+	}
+
+	HistoryReset();
+	g_DebugHistory.bEnabled = true;
+}
+
+//===========================================================================
+void HistoryStop ()
+{
+	g_DebugHistory.bEnabled = false;
+	HistoryReset();
+}
+
+// Restore the state before the last recorded step
+// Returns NULL if there is no more history
+// Post: [iAccessBegin_,iAccessEnd_) are the accesses made by the step, still valid until the next step is recorded
+//===========================================================================
+const HistoryStep_t* HistoryUndoStep ( UINT & iAccessBegin_, UINT & iAccessEnd_ )
+{
+	if (!g_DebugHistory.nValid)
+		return NULL;
+
+	const HistoryStep_t *pStep = &g_DebugHistory.pSteps[ (g_DebugHistory.nSteps - 1) & (HISTORY_NUM_STEPS - 1) ];
+
+	// Accesses were overwritten by newer steps?
+	if ((g_DebugHistory.nAccesses - pStep->iAccess) > HISTORY_NUM_ACCESSES)
+	{
+		g_DebugHistory.nValid = 0;
+		return NULL;
+	}
+
+	g_DebugHistory.nSteps--;
+	g_DebugHistory.nValid--;
+
+	// Restore the memory mode first, so that writes to 'mem' are undone to the same bank
+	if (GetMemMode() != pStep->nMemMode)
+	{
+		SetMemMode( pStep->nMemMode );
+		MemUpdatePaging( FALSE );
+	}
+
+	iAccessBegin_ = pStep->iAccess;
+	iAccessEnd_   = g_DebugHistory.nAccesses;
+
+	for (UINT iAccess = iAccessEnd_; iAccess != iAccessBegin_; )
+	{
+		iAccess--;
+		const HistoryAccess_t & access = g_DebugHistory.pAccesses[ iAccess & (HISTORY_NUM_ACCESSES - 1) ];
+
+		if (access.eAccess == HISTORY_MEM_WRITE)
+		{
+			*access.pMem = access.nValue;
+			memdirty[ access.nAddress >> 8 ] = 0xFF;
+		}
+	}
+
+	for (int iByte = 0; iByte < HISTORY_STACK_BYTES; iByte++)
+		*(mem + (0x100 | ((pStep->nSP - iByte) & 0xFF))) = pStep->aStack[ iByte ];
+	memdirty[ 0x01 ] = 0xFF;
+
+	g_DebugHistory.nAccesses = pStep->iAccess;
+
+	regs.pc = pStep->nPC;
+	regs.sp = pStep->nSP;
+	regs.a  = pStep->nA;
+	regs.x  = pStep->nX;
+	regs.y  = pStep->nY;
+	regs.ps = pStep->nP;
+
+	return pStep;
+}
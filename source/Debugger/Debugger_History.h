@@ -0,0 +1,59 @@
+#pragma once
+
+// Execution History ______________________________________________________________________________
+
+	// The debug CPU core (Cpu6502_debug, Cpu65C02_debug) records a step before each opcode is executed,
+	// and an access for every memory write and I/O read/write, see History_X() in cpu_heatmap.inl
+	// Stepping backwards restores the registers and memory mode, and undoes the memory writes.
+	// NB. Peripheral state (disk, 6522s, etc) and the cycle counter are not reversed.
+	enum HistoryAccess_e
+	{
+		HISTORY_MEM_WRITE, // nValue = old value, undone
+		HISTORY_IO_READ  , // nValue = value read
+		HISTORY_IO_WRITE , // nValue = value written
+	};
+
+	enum
+	{
+		HISTORY_NUM_STEPS    = (1 << 16), // must be power of 2
+		HISTORY_NUM_ACCESSES = (1 << 18), // must be power of 2
+		HISTORY_STACK_BYTES  = 6        , // PUSH writes to mem directly: up to 3 for BRK/JSR + 3 for IRQ/NMI
+	};
+
+	struct HistoryStep_t
+	{
+		WORD  nPC     ;
+		WORD  nSP     ;
+		BYTE  nA      ;
+		BYTE  nX      ;
+		BYTE  nY      ;
+		BYTE  nP      ;
+		DWORD nMemMode;
+		UINT  iAccess ; // 1st access of this step
+		BYTE  aStack[ HISTORY_STACK_BYTES ]; // [$0100 + (SP-n)], before any PUSH
+	};
+
+	struct HistoryAccess_t
+	{
+		BYTE *pMem    ; // HISTORY_MEM_WRITE: byte written, NULL otherwise
+		WORD  nAddress;
+		BYTE  nValue  ;
+		BYTE  eAccess ; // HistoryAccess_e
+	};
+
+	struct DebugHistory_t
+	{
+		bool             bEnabled ;
+		UINT             nSteps   ; // total steps recorded, wraps
+		UINT             nAccesses; // total accesses recorded, wraps
+		UINT             nValid   ; // steps that can be undone
+		HistoryStep_t   *pSteps   ; // [HISTORY_NUM_STEPS]
+		HistoryAccess_t *pAccesses; // [HISTORY_NUM_ACCESSES]
+	};
+
+	extern DebugHistory_t g_DebugHistory;
+
+	void HistoryStart ();
+	void HistoryStop ();
+	void HistoryReset ();
+	const HistoryStep_t* HistoryUndoStep ( UINT & iAccessBegin_, UINT & iAccessEnd_ );
@@ -0,0 +1,292 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Debugger I/O Statistics (soft switch and slot I/O access histogram, timeline)
+ *
+ * Author: Various
+ */
+
+#include "StdAfx.h"
+
+#include "Debug.h"
+
+#include "../Core.h"
+#include "../CPU.h"
+
+// I/O Statistics _________________________________________________________________________________
+
+	DebugIoStats_t g_DebugIoStats;
+
+	static const char g_sFileNameIoStats[] = "IOStats.txt";
+
+	struct IoStatsLine_t
+	{
+		WORD           nAddress;
+		IoStatsCount_t count;
+	};
+
+
+// Recording ______________________________________________________________________________________
+
+//===========================================================================
+static void IoStatsStart ( const UINT nSampleRate )
+{
+	if (!g_DebugIoStats.pCounts)
+		g_DebugIoStats.pCounts = new IoStatsCount_t[ IOSTATS_NUM_ADDRESSES ];
+	if (!g_DebugIoStats.pSamples)
+		g_DebugIoStats.pSamples = new IoStatsSample_t[ IOSTATS_RING_SIZE ];
+
+	memset( g_DebugIoStats.pCounts, 0, IOSTATS_NUM_ADDRESSES * sizeof(IoStatsCount_t) );
+
+	g_DebugIoStats.nSampleRate      = nSampleRate;
+	g_DebugIoStats.nSampleCountdown = nSampleRate;
+	g_DebugIoStats.nCycleStart      = g_nCumulativeCycles;
+	g_DebugIoStats.nSamples         = 0;
+	g_DebugIoStats.nOpcodePC        = regs.pc;
+	g_DebugIoStats.bEnabled         = true;
+}
+
+// Keeps the counts and timeline, so they can still be listed or saved
+//===========================================================================
+void IoStatsStop ()
+{
+	g_DebugIoStats.bEnabled = false;
+}
+
+
+// Reporting ______________________________________________________________________________________
+
+// Symbol (eg. TXTPAGE1) if there is one, else the slot the address belongs to
+//===========================================================================
+static const char* _IoStatsName ( const WORD nAddress, char sName_[ 16 ] )
+{
+	const char *pSymbol = FindSymbolFromAddress( nAddress );
+	if (pSymbol)
+		return pSymbol;
+
+	sName_[0] = 0;
+	if ((nAddress >= 0xC080) && (nAddress <= 0xC0FF))
+		sprintf( sName_, "Slot %d I/O", (nAddress >> 4) & 7 );
+	else
+	if ((nAddress >= 0xC100) && (nAddress <= 0xC7FF))
+		sprintf( sName_, "Slot %d ROM", (nAddress >> 8) & 7 );
+	else
+	if (nAddress >= 0xC800)
+		strcpy( sName_, "Expansion ROM" );
+
+	return sName_;
+}
+
+// Most accessed first
+//===========================================================================
+static bool _IoStatsCompare ( const IoStatsLine_t & a, const IoStatsLine_t & b )
+{
+	const UINT nTotalA = a.count.nReads + a.count.nWrites;
+	const UINT nTotalB = b.count.nReads + b.count.nWrites;
+	if (nTotalA != nTotalB)
+		return nTotalA > nTotalB;
+	return a.nAddress < b.nAddress;
+}
+
+//===========================================================================
+static UINT _IoStatsSort ( std::vector<IoStatsLine_t> & vLines_ )
+{
+	UINT nTotal = 0;
+
+	vLines_.clear();
+	for (UINT iAddress = 0; iAddress < IOSTATS_NUM_ADDRESSES; iAddress++)
+	{
+		const IoStatsCount_t & count = g_DebugIoStats.pCounts[ iAddress ];
+		if (!count.nReads && !count.nWrites)
+			continue;
+
+		IoStatsLine_t line;
+		line.nAddress = 0xC000 + iAddress;
+		line.count    = count;
+		vLines_.push_back( line );
+
+		nTotal += count.nReads + count.nWrites;
+	}
+
+	std::sort( vLines_.begin(), vLines_.end(), _IoStatsCompare );
+	return nTotal;
+}
+
+// Rate is per emulated second, eg. ~60/s for a once per frame access
+//===========================================================================
+static void _IoStatsFormat ( std::vector<std::string> & vLines_, const bool bExport, const UINT nMaxLines )
+{
+	std::vector<IoStatsLine_t> vAddresses;
+	const UINT nTotal = _IoStatsSort( vAddresses );
+
+	const unsigned __int64 nCycles = g_nCumulativeCycles - g_DebugIoStats.nCycleStart;
+	const double fSeconds = nCycles ? (double) nCycles / g_fCurrentCLK6502 : 1.0;
+	const double fTotal   = nTotal  ? (double) nTotal : 1.0;
+
+	char sLine[ CONSOLE_WIDTH * 2 ];
+	char sName[ 16 ];
+
+	vLines_.clear();
+
+	if (bExport)
+		sprintf( sLine, "Address\tName\tReads\tWrites\t%%\tPerSecond" );
+	else
+		sprintf( sLine, " Addr Name              Reads   Writes     %%   /second" );
+	vLines_.push_back( sLine );
+
+	for (UINT iLine = 0; iLine < vAddresses.size() && iLine < nMaxLines; iLine++)
+	{
+		const IoStatsLine_t & line = vAddresses[ iLine ];
+		const UINT nAccesses = line.count.nReads + line.count.nWrites;
+
+		sprintf( sLine, bExport ? "$%04X\t%s\t%u\t%u\t%.2f\t%.0f"
+		                        : " %04X %-16.16s %7u %8u %5.1f %9.0f"
+			, line.nAddress, _IoStatsName( line.nAddress, sName )
+			, line.count.nReads, line.count.nWrites
+			, 100.0 * nAccesses / fTotal, nAccesses / fSeconds
+		);
+		vLines_.push_back( sLine );
+	}
+
+	sprintf( sLine, bExport ? "Total\t\t%u\t\tCycles\t%llu"
+	                        : " Total: %u accesses in %llu cycles"
+		, nTotal, (unsigned long long) nCycles );
+	vLines_.push_back( sLine );
+}
+
+// Histogram of all accessed addresses, then the timeline, oldest first
+//===========================================================================
+static bool _IoStatsSave ( const std::string & sFileName )
+{
+	FILE *hFile = fopen( sFileName.c_str(), "wt" );
+	if (!hFile)
+		return false;
+
+	std::vector<std::string> vLines;
+	_IoStatsFormat( vLines, true, IOSTATS_NUM_ADDRESSES );
+
+	for (size_t iLine = 0; iLine < vLines.size(); iLine++)
+		fprintf( hFile, "%s\n", vLines[ iLine ].c_str() );
+
+	const UINT nSamples = MIN( g_DebugIoStats.nSamples, (UINT) IOSTATS_RING_SIZE );
+	fprintf( hFile, "\nTimeline: last %u of %u samples, every %u access(es)\n", nSamples, g_DebugIoStats.nSamples, g_DebugIoStats.nSampleRate );
+	fprintf( hFile, "Cycle\tPC\tAddress\tAccess\tValue\tName\n" );
+
+	char sName[ 16 ];
+	for (UINT iSample = g_DebugIoStats.nSamples - nSamples; iSample != g_DebugIoStats.nSamples; iSample++)
+	{
+		const IoStatsSample_t & sample = g_DebugIoStats.pSamples[ iSample & (IOSTATS_RING_SIZE - 1) ];
+		fprintf( hFile, "%llu\t$%04X\t$%04X\t%s\t$%02X\t%s\n"
+			, (unsigned long long) sample.nCycles, sample.nPC, sample.nAddress
+			, sample.bWrite ? "W" : "R", sample.nValue
+			, _IoStatsName( sample.nAddress, sName ) );
+	}
+
+	fclose( hFile );
+	return true;
+}
+
+
+// Commands _______________________________________________________________________________________
+
+// IOSTATS [ON [n] | OFF | RESET [n] | LIST | SAVE ["file"]]
+//===========================================================================
+Update_t CmdIoStats (int nArgs)
+{
+	char sText[ CONSOLE_WIDTH ];
+
+	int iParam = PARAM_LIST;
+	if (nArgs >= 1)
+	{
+		int nFound = FindParam( g_aArgs[ 1 ].sArg, MATCH_EXACT, iParam, _PARAM_GENERAL_BEGIN, _PARAM_GENERAL_END );
+		if (!nFound)
+			return Help_Arg_1( CMD_IOSTATS );
+	}
+
+	switch (iParam)
+	{
+		case PARAM_ON:
+		case PARAM_RESET:
+		{
+			if (nArgs > 2)
+				return Help_Arg_1( CMD_IOSTATS );
+
+			const UINT nSampleRate = (nArgs == 2) ? g_aArgs[ 2 ].nValue : 1;
+			if (!nSampleRate)
+				return Help_Arg_1( CMD_IOSTATS );
+
+			IoStatsStart( nSampleRate );
+			ConsoleBufferPushFormat( sText, " I/O statistics started, timeline records every %u access(es).", nSampleRate );
+			break;
+		}
+
+		case PARAM_OFF:
+			IoStatsStop();
+			ConsoleBufferPush( " I/O statistics stopped." );
+			break;
+
+		case PARAM_LIST:
+		{
+			if (nArgs > 1)
+				return Help_Arg_1( CMD_IOSTATS );
+
+			if (!g_DebugIoStats.pCounts)
+			{
+				ConsoleBufferPush( " No I/O statistics. See: IOSTATS ON" );
+				break;
+			}
+
+			std::vector<std::string> vLines;
+			_IoStatsFormat( vLines, false, IOSTATS_LIST_LINES );
+
+			for (size_t iLine = 0; iLine < vLines.size(); iLine++)
+				ConsolePrint( vLines[ iLine ].c_str() );
+			break;
+		}
+
+		case PARAM_SAVE:
+		{
+			const bool bQuotedFile = (nArgs == 2) && (g_aArgs[ 2 ].bType & TYPE_QUOTED_2);
+			if (nArgs > 2 || (nArgs == 2 && !bQuotedFile))
+				return Help_Arg_1( CMD_IOSTATS );
+
+			if (!g_DebugIoStats.pCounts)
+			{
+				ConsoleBufferPush( " No I/O statistics. See: IOSTATS ON" );
+				break;
+			}
+
+			const std::string sFileName = g_sProgramDir + (bQuotedFile ? g_aArgs[ 2 ].sArg : g_sFileNameIoStats);
+			if (_IoStatsSave( sFileName ))
+				ConsoleBufferPushFormat( sText, " Saved: %s", sFileName.c_str() );
+			else
+				ConsoleBufferPush( " ERROR: Couldn't save file. (In use?)" );
+			break;
+		}
+
+		default:
+			return Help_Arg_1( CMD_IOSTATS );
+	}
+
+	return ConsoleUpdate();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// I/O Statistics _________________________________________________________________________________
+
+	// The debug CPU core (Cpu6502_debug, Cpu65C02_debug) counts each CPU read or write of $C000..$CFFF,
+	// see IoStats_Access() in cpu_heatmap.inl
+	// Counts are exact; every Nth access is also recorded, with its cycle, into a ring buffer (timeline).
+	enum
+	{
+		IOSTATS_NUM_ADDRESSES = 0x1000, // $C000..$CFFF
+		IOSTATS_RING_SIZE     = 0x10000, // must be a power of 2
+		IOSTATS_LIST_LINES    = 16,
+	};
+
+	struct IoStatsCount_t
+	{
+		UINT nReads ;
+		UINT nWrites;
+	};
+
+	struct IoStatsSample_t
+	{
+		unsigned __int64 nCycles ;
+		WORD             nPC     ; // opcode that accessed I/O
+		WORD             nAddress;
+		BYTE             nValue  ;
+		bool             bWrite  ;
+	};
+
+	struct DebugIoStats_t
+	{
+		bool             bEnabled        ;
+		UINT             nSampleRate     ; // record every Nth access
+		UINT             nSampleCountdown;
+		unsigned __int64 nCycleStart     ;
+		UINT             nSamples        ; // total recorded, ring index = nSamples & (IOSTATS_RING_SIZE-1)
+		WORD             nOpcodePC       ; // opcode being executed, see Heatmap_X() (regs.pc is already past its operand)
+		IoStatsCount_t  *pCounts         ; // [IOSTATS_NUM_ADDRESSES]
+		IoStatsSample_t *pSamples        ; // [IOSTATS_RING_SIZE]
+	};
+
+	extern DebugIoStats_t g_DebugIoStats;
+
+	void IoStatsStop ();
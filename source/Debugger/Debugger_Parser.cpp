@@ -666,7 +666,7 @@ int ArgsCook ( const int nArgs )
 					if ((nPointers) &&
 						(nAddressRHS < nPointers))
 					{
-						pArg->nValue   = g_vMemorySearchResults.at( nAddressRHS );
+						pArg->nValue   = g_vMemorySearchResults.at( nAddressRHS ) & MEM_SEARCH_BANK_MASK;
 						pArg->bType   = TYPE_VALUE | TYPE_ADDRESS | TYPE_NO_REG | TYPE_NO_SYM;
 					}
 					nParamLen = 0;
@@ -0,0 +1,374 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Debugger Server (headless command channel, JSON results)
+ *
+ * Author: Various
+ */
+
+#include "StdAfx.h"
+
+#include "Debug.h"
+
+#include "../Core.h"
+#include "../CPU.h"
+#include "../Interface.h"
+#include "../Log.h"
+
+// Debugger Server ________________________________________________________________________________
+
+	// Same as the SSC's TCP serial port: socket events are posted to the frame window (WSAAsyncSelect),
+	// so everything here runs on the main thread, in between emulation periods.
+	static SOCKET      g_hServerListenSocket = INVALID_SOCKET;
+	static SOCKET      g_hServerClientSocket = INVALID_SOCKET;
+
+	static std::string g_sServerReceived; // partial line
+	static std::string g_sServerSend    ; // not sent yet, waiting for FD_WRITE
+
+	static std::queue<std::string> g_qServerCommands;
+	static UINT        g_nServerCommandId = 0;
+
+//===========================================================================
+static void _ServerAppendString ( std::string & sJson_, const char *pText )
+{
+	sJson_ += '"';
+	for (const char *pSrc = pText; *pSrc; pSrc++)
+	{
+		const unsigned char c = *pSrc;
+		switch (c)
+		{
+			case '"' : sJson_ += "\\\""; break;
+			case '\\': sJson_ += "\\\\"; break;
+			case '\n': sJson_ += "\\n" ; break;
+			case '\r': sJson_ += "\\r" ; break;
+			case '\t': sJson_ += "\\t" ; break;
+			default:
+				if ((c < 0x20) || (c > 0x7E))
+				{
+					char sHex[ 8 ];
+					sprintf( sHex, "\\u%04X", c );
+					sJson_ += sHex;
+				}
+				else
+					sJson_ += c;
+				break;
+		}
+	}
+	sJson_ += '"';
+}
+
+//===========================================================================
+static const char* _ServerModeName ()
+{
+	switch (g_nAppMode)
+	{
+		case MODE_LOGO     : return "logo"     ;
+		case MODE_PAUSED   : return "paused"   ;
+		case MODE_RUNNING  : return "running"  ;
+		case MODE_DEBUG    : return "debug"    ;
+		case MODE_STEPPING : return "stepping" ;
+		case MODE_BENCHMARK: return "benchmark";
+		default            : return "unknown"  ;
+	}
+}
+
+// "mode":"debug","pc":"0300"
+//===========================================================================
+static void _ServerAppendState ( std::string & sJson_ )
+{
+	char sPC[ 8 ];
+	sprintf( sPC, "%04X", regs.pc );
+
+	sJson_ += "\"mode\":";
+	_ServerAppendString( sJson_, _ServerModeName() );
+	sJson_ += ",\"pc\":";
+	_ServerAppendString( sJson_, sPC );
+}
+
+//===========================================================================
+static void _ServerWrite ( const std::string & sJson )
+{
+	if (g_hServerClientSocket == INVALID_SOCKET)
+		return;
+
+	g_sServerSend += sJson;
+	g_sServerSend += '\n';
+	DebuggerServerSend();
+}
+
+// Commands are only executed in MODE_DEBUG, same as typed into the console
+//===========================================================================
+static void _ServerEnterDebugger ()
+{
+	switch (g_nAppMode)
+	{
+		case MODE_RUNNING:
+		case MODE_PAUSED:
+			DebugBegin();
+			break;
+		case MODE_STEPPING:
+			DebugStopStepping(); // Enters MODE_DEBUG on the next DebugContinueStepping()
+			break;
+		default:
+			break;
+	}
+}
+
+//===========================================================================
+static void _ServerExecute ( const std::string & sCommand )
+{
+	std::vector<std::string> vOutput;
+
+	ConsoleFlush(); // Don't send output that was already waiting for the interactive console
+
+	g_pConsoleCapture = &vOutput;
+	DebuggerProcessCommandText( sCommand.c_str() );
+	g_pConsoleCapture = NULL;
+
+	char sId[ 16 ];
+	sprintf( sId, "%u", ++g_nServerCommandId );
+
+	std::string sJson = "{\"type\":\"result\",\"id\":";
+	sJson += sId;
+	sJson += ",\"command\":";
+	_ServerAppendString( sJson, sCommand.c_str() );
+	sJson += ",\"output\":[";
+	for (size_t iLine = 0; iLine < vOutput.size(); iLine++)
+	{
+		if (iLine)
+			sJson += ',';
+		_ServerAppendString( sJson, vOutput[ iLine ].c_str() );
+	}
+	sJson += "],";
+	_ServerAppendState( sJson );
+	sJson += '}';
+
+	_ServerWrite( sJson );
+}
+
+//===========================================================================
+static void _ServerReject ( const std::string & sCommand, const char *pError )
+{
+	std::string sJson = "{\"type\":\"result\",\"command\":";
+	_ServerAppendString( sJson, sCommand.c_str() );
+	sJson += ",\"error\":";
+	_ServerAppendString( sJson, pError );
+	sJson += ',';
+	_ServerAppendState( sJson );
+	sJson += '}';
+
+	_ServerWrite( sJson );
+}
+
+//===========================================================================
+bool DebuggerServerStart ( UINT nPort )
+{
+	if (g_hServerListenSocket != INVALID_SOCKET)
+		return true;
+
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) // Winsock 2.2
+		return false;
+
+	g_hServerListenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (g_hServerListenSocket == INVALID_SOCKET)
+	{
+		WSACleanup();
+		return false;
+	}
+
+	// Loopback only: commands can read and write all of memory
+	SOCKADDR_IN saAddress;
+	memset(&saAddress, 0, sizeof(SOCKADDR_IN));
+	saAddress.sin_family = AF_INET;
+	saAddress.sin_port = htons((u_short)nPort);
+	saAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	if ((bind(g_hServerListenSocket, (LPSOCKADDR)&saAddress, sizeof(saAddress)) == SOCKET_ERROR)
+	||  (listen(g_hServerListenSocket, 1) == SOCKET_ERROR)
+	||  (WSAAsyncSelect(g_hServerListenSocket, GetFrame().g_hFrameWindow, WM_USER_DEBUGGER_SERVER, (FD_ACCEPT | FD_READ | FD_WRITE | FD_CLOSE)) != 0))
+	{
+		LogFileOutput("Debugger Server: failed to listen on port %u (%d)\n", nPort, WSAGetLastError());
+		closesocket(g_hServerListenSocket);
+		g_hServerListenSocket = INVALID_SOCKET;
+		WSACleanup();
+		return false;
+	}
+
+	LogFileOutput("Debugger Server: listening on port %u\n", nPort);
+	return true;
+}
+
+//===========================================================================
+void DebuggerServerStop ()
+{
+	if (g_hServerListenSocket == INVALID_SOCKET)
+		return;
+
+	WSAAsyncSelect(g_hServerListenSocket, GetFrame().g_hFrameWindow, 0, 0); // Stop event messages
+	closesocket(g_hServerListenSocket);
+	g_hServerListenSocket = INVALID_SOCKET;
+
+	DebuggerServerClose();
+
+	WSACleanup();
+}
+
+// One client at a time, further connections wait in the listen backlog
+// NB. FD_ACCEPT is only posted again after accept() is called, so DebuggerServerClose() accepts the next waiting client
+//===========================================================================
+void DebuggerServerAccept ()
+{
+	if ((g_hServerListenSocket != INVALID_SOCKET) && (g_hServerClientSocket == INVALID_SOCKET))
+	{
+		g_hServerClientSocket = accept(g_hServerListenSocket, NULL, NULL); // INVALID_SOCKET (WSAEWOULDBLOCK) if none waiting
+		g_nServerCommandId = 0;
+	}
+}
+
+//===========================================================================
+void DebuggerServerClose ()
+{
+	if (g_hServerClientSocket != INVALID_SOCKET)
+	{
+		shutdown(g_hServerClientSocket, 2 /* SD_BOTH */);
+		closesocket(g_hServerClientSocket);
+		g_hServerClientSocket = INVALID_SOCKET;
+	}
+
+	g_sServerReceived.clear();
+	g_sServerSend.clear();
+	while (!g_qServerCommands.empty())
+		g_qServerCommands.pop();
+
+	DebuggerServerAccept(); // Next client in the listen backlog (if any)
+}
+
+//===========================================================================
+void DebuggerServerReceive ()
+{
+	if (g_hServerClientSocket == INVALID_SOCKET)
+		return;
+
+	char aData[ 0x400 ];
+	int nReceived = 0;
+	while ((nReceived = recv(g_hServerClientSocket, aData, sizeof(aData), 0)) > 0)
+	{
+		for (int iData = 0; iData < nReceived; iData++)
+		{
+			const char c = aData[ iData ];
+			if (c == '\n')
+			{
+				if (!g_sServerReceived.empty())
+					g_qServerCommands.push( g_sServerReceived );
+				g_sServerReceived.clear();
+			}
+			else if (c != '\r')
+			{
+				g_sServerReceived += c;
+			}
+		}
+
+		if (g_sServerReceived.size() > DEBUGGER_SERVER_MAX_LINE)
+		{
+			LogFileOutput("Debugger Server: line too long, closing connection\n");
+			DebuggerServerClose();
+			return;
+		}
+	}
+
+	if (!g_qServerCommands.empty())
+	{
+		_ServerEnterDebugger();
+		DebuggerServerUpdate();
+	}
+}
+
+// Called for FD_WRITE, when the socket can take more of the pending output
+//===========================================================================
+void DebuggerServerSend ()
+{
+	while ((g_hServerClientSocket != INVALID_SOCKET) && !g_sServerSend.empty())
+	{
+		const int nSent = send(g_hServerClientSocket, g_sServerSend.data(), (int)g_sServerSend.size(), 0);
+		if (nSent == SOCKET_ERROR)
+		{
+			if (WSAGetLastError() != WSAEWOULDBLOCK)
+				DebuggerServerClose();
+			return;
+		}
+
+		g_sServerSend.erase(0, nSent);
+	}
+}
+
+// Execute pending commands, until one of them resumes emulation
+//===========================================================================
+void DebuggerServerUpdate ()
+{
+	if (g_qServerCommands.empty())
+		return;
+
+	if (g_nAppMode == MODE_LOGO)
+	{
+		while (!g_qServerCommands.empty())
+		{
+			_ServerReject( g_qServerCommands.front(), "Emulation not started" );
+			g_qServerCommands.pop();
+		}
+		return;
+	}
+
+	while (!g_qServerCommands.empty() && (g_nAppMode == MODE_DEBUG))
+	{
+		const std::string sCommand = g_qServerCommands.front();
+		g_qServerCommands.pop();
+
+		if (sCommand.size() > CONSOLE_WIDTH - 2) // See: DebuggerProcessCommandText()
+			_ServerReject( sCommand, "Command too long" );
+		else
+			_ServerExecute( sCommand );
+	}
+}
+
+//===========================================================================
+void DebuggerServerEvent ( const char *pEvent, const char *pReason )
+{
+	if (g_hServerClientSocket == INVALID_SOCKET)
+		return;
+
+	char sCycles[ 24 ];
+	sprintf( sCycles, "%llu", (unsigned long long) g_nCumulativeCycles );
+
+	std::string sJson = "{\"type\":\"event\",\"event\":";
+	_ServerAppendString( sJson, pEvent );
+	sJson += ",\"reason\":";
+	_ServerAppendString( sJson, pReason );
+	sJson += ',';
+	_ServerAppendState( sJson );
+	sJson += ",\"cycles\":";
+	sJson += sCycles;
+	sJson += '}';
+
+	_ServerWrite( sJson );
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+// Debugger Server ________________________________________________________________________________
+
+	// Headless command channel, enabled with the command line: -debugger-server <port>
+	// Listens on the loopback interface only, and accepts one client at a time.
+	// Commands longer than the console input line (CONSOLE_WIDTH - 2) are rejected with an "error".
+	// Each line received is a debugger command, answered with one JSON object per line:
+	//   {"type":"result","id":1,"command":"R A 0","output":[...],"mode":"debug","pc":"0300"}
+	// When the debugger stops (breakpoint hit, 'Go until' address, etc.) an event is streamed:
+	//   {"type":"event","event":"break","reason":"Register matches value","pc":"0300","cycles":123456}
+	// Commands received while the emulator is running or stepping break into the debugger first.
+	// Commands after one that resumes emulation (eg. G) wait until the debugger is entered again.
+	enum
+	{
+		DEBUGGER_SERVER_MAX_LINE = 1024, // client is dropped if a line is longer than this
+	};
+
+	bool DebuggerServerStart   ( UINT nPort );
+	void DebuggerServerStop    ();
+	void DebuggerServerAccept  ();
+	void DebuggerServerReceive ();
+	void DebuggerServerSend    ();
+	void DebuggerServerClose   ();
+	void DebuggerServerUpdate  ();
+	void DebuggerServerEvent   ( const char *pEvent, const char *pReason );
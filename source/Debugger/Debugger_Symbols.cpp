@@ -28,6 +28,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include "StdAfx.h"
 
+#include <functional>
+#include <unordered_map>
+
 #include "Debug.h"
 
 #include "../Windows/AppleWin.h"
@@ -73,6 +76,20 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 	SymbolTable_t g_aSymbols[ NUM_SYMBOL_TABLES ];
 	int           g_nSymbolsLoaded = 0;  // on Last Load
 
+	// All active symbol tables merged into one lookup, so the disassembler doesn't search every table per operand
+	// g_aSymbols[] is still the master copy, the lookup is rebuilt on the next find after a change
+	// See: SymbolsLookupInvalidate()
+	struct SymbolLookup_t
+	{
+		bool                                   bValid;
+		std::vector<char>                      vPool;    // interned symbol names, NUL terminated
+		UINT                                   aName [ 0x10000 ]; // offset+1 into vPool, 0 = no symbol
+		BYTE                                   aTable[ 0x10000 ];
+		std::unordered_map<std::string, DWORD> mapName;  // upper case name -> (iTable << 16) | nAddress
+	};
+
+	static SymbolLookup_t g_SymbolLookup;
+
 // Utils _ ________________________________________________________________________________________
 
 	void      _CmdSymbolsInfoHeader( int iTable, char * pText, int nDisplaySize = 0 );
@@ -140,63 +157,102 @@ int GetSymbolTableFromCommand()
 	return (g_iCommand - CMD_SYMBOLS_ROM);
 }
 
+// Call after g_aSymbols[] or g_bDisplaySymbolTables is changed
 //===========================================================================
-const char* FindSymbolFromAddress (WORD nAddress, int * iTable_ )
+void SymbolsLookupInvalidate ()
 {
-	// Bugfix/User feature: User symbols should be searched first
-	int iTable = NUM_SYMBOL_TABLES;
-	while (iTable-- > 0)
-	{
-		if (! g_aSymbols[iTable].size())
-			continue;
-
-		if (! (g_bDisplaySymbolTables & (1 << iTable)))
-			continue;
+	g_SymbolLookup.bValid = false;
+	DisasmCacheInvalidate();
+}
 
-		std::map<WORD, std::string>::iterator iSymbols = g_aSymbols[iTable].find(nAddress);
-		if(g_aSymbols[iTable].find(nAddress) != g_aSymbols[iTable].end())
-		{
-			if (iTable_)
-			{
-				*iTable_ = iTable;
-			}
-			return iSymbols->second.c_str();
-		}
-	}	
-	return NULL;	
+//===========================================================================
+static std::string _SymbolLookupKey ( const char* pSymbol )
+{
+	std::string sKey( pSymbol );
+	for (size_t iChar = 0; iChar < sKey.size(); iChar++)
+		sKey[ iChar ] = toupper( (unsigned char) sKey[ iChar ] );
+	return sKey;
 }
 
 //===========================================================================
-bool FindAddressFromSymbol ( const char* pSymbol, WORD * pAddress_, int * iTable_ )
+static void _SymbolLookupBuild ()
 {
+	memset( g_SymbolLookup.aName , 0, sizeof( g_SymbolLookup.aName  ) );
+	memset( g_SymbolLookup.aTable, 0, sizeof( g_SymbolLookup.aTable ) );
+	g_SymbolLookup.vPool.clear();
+	g_SymbolLookup.mapName.clear();
+
+	std::unordered_map<std::string, UINT> mapPool; // name -> offset+1
+
 	// Bugfix/User feature: User symbols should be searched first
 	for (int iTable = NUM_SYMBOL_TABLES; iTable-- > 0; )
 	{
-		if (! g_aSymbols[iTable].size())
-			continue;
-
 		if (! (g_bDisplaySymbolTables & (1 << iTable)))
 			continue;
 
 		SymbolTable_t :: iterator  iSymbol = g_aSymbols[iTable].begin();
-		while (iSymbol != g_aSymbols[iTable].end())
+		for ( ; iSymbol != g_aSymbols[iTable].end(); iSymbol++)
 		{
-			if (!_tcsicmp( iSymbol->second.c_str(), pSymbol))
+			const WORD nAddress = iSymbol->first;
+
+			// First (highest) table wins, same as searching each table in turn
+			g_SymbolLookup.mapName.insert( std::make_pair( _SymbolLookupKey( iSymbol->second.c_str() ), (DWORD)((iTable << 16) | nAddress) ) );
+
+			if (g_SymbolLookup.aName[ nAddress ])
+				continue;
+
+			UINT & nName = mapPool[ iSymbol->second ];
+			if (! nName)
 			{
-				if (pAddress_)
-				{
-					*pAddress_ = iSymbol->first;
-				}
-				if (iTable_)
-				{
-					*iTable_ = iTable;
-				}
-				return true;
+				nName = (UINT) g_SymbolLookup.vPool.size() + 1;
+				g_SymbolLookup.vPool.insert( g_SymbolLookup.vPool.end(), iSymbol->second.begin(), iSymbol->second.end() );
+				g_SymbolLookup.vPool.push_back( 0 );
 			}
-			iSymbol++;
+
+			g_SymbolLookup.aName [ nAddress ] = nName;
+			g_SymbolLookup.aTable[ nAddress ] = (BYTE) iTable;
 		}
 	}
-	return false;
+
+	g_SymbolLookup.bValid = true;
+}
+
+//===========================================================================
+const char* FindSymbolFromAddress (WORD nAddress, int * iTable_ )
+{
+	if (! g_SymbolLookup.bValid)
+		_SymbolLookupBuild();
+
+	const UINT nName = g_SymbolLookup.aName[ nAddress ];
+	if (! nName)
+		return NULL;
+
+	if (iTable_)
+	{
+		*iTable_ = g_SymbolLookup.aTable[ nAddress ];
+	}
+	return &g_SymbolLookup.vPool[ nName - 1 ];
+}
+
+//===========================================================================
+bool FindAddressFromSymbol ( const char* pSymbol, WORD * pAddress_, int * iTable_ )
+{
+	if (! g_SymbolLookup.bValid)
+		_SymbolLookupBuild();
+
+	std::unordered_map<std::string, DWORD>::const_iterator iSymbol = g_SymbolLookup.mapName.find( _SymbolLookupKey( pSymbol ) );
+	if (iSymbol == g_SymbolLookup.mapName.end())
+		return false;
+
+	if (pAddress_)
+	{
+		*pAddress_ = (WORD) (iSymbol->second & 0xFFFF);
+	}
+	if (iTable_)
+	{
+		*iTable_ = (int) (iSymbol->second >> 16);
+	}
+	return true;
 }
 
 
@@ -551,6 +607,295 @@ Update_t _CmdSymbolsListTables (int nArgs, int bSymbolTables )
 }
 
 
+// Symbol File Loading ____________________________________________________________________________
+
+	// Symbol files are mapped into memory and split into chunks which are parsed in parallel.
+	// The parsed symbols of large files are cached in the user's temp folder, and loaded from there while the file is unchanged.
+	// (Small files, eg. the bundled APPLE2E.SYM, parse faster than the cache loads, so aren't cached.)
+	// Messages and updating the symbol tables are done afterwards, in file order, on the caller's thread.
+	enum
+	{
+		SYMBOL_CACHE_VERSION   = 1,
+		SYMBOL_LOAD_MIN_CHUNK  = 64 * 1024, // bytes, don't start a thread for less
+		SYMBOL_LOAD_MAX_CHUNKS = 16,
+	};
+
+#pragma pack(push,1)
+	struct SymbolLoadEntry_t
+	{
+		DWORD nAddress; // before SymbolOffset
+		char  sName[ MAX_SYMBOLS_LEN+1 ];
+	};
+
+	struct SymbolCacheHeader_t
+	{
+		char     sMagic[8]; // "AWSYMC"
+		uint32_t nVersion ;
+		uint32_t nSymbols ;
+		uint64_t nFileSize;
+		uint64_t nModTime ;
+	};
+#pragma pack(pop)
+
+	struct SymbolLoadChunk_t
+	{
+		const char *pBegin;
+		const char *pEnd  ;
+		std::vector<SymbolLoadEntry_t> vSymbols;
+	};
+
+// Support 2 types of symbols files:
+// 1) AppleWin:
+//    . 0000 SYMBOL
+//    . FFFF SYMBOL
+// 2) ACME:
+//    . SYMBOL  =$0000; Comment
+//    . SYMBOL  =$FFFF; Comment
+// Returns false if the line has no symbol
+//===========================================================================
+static bool _ParseSymbolLine ( char *szLine, SymbolLoadEntry_t & symbol_ )
+{
+	symbol_.nAddress = _6502_MEM_END + 1; // default to invalid address
+	symbol_.sName[0] = 0;
+
+	if(strstr(szLine, "$") == NULL)
+	{
+		sscanf(szLine, "%x %31s", &symbol_.nAddress, symbol_.sName); // MAGIC NUMBER: MAX_SYMBOLS_LEN
+	}
+	else
+	{
+		char* p = strstr(szLine, "=");	// Optional
+		if(p) *p = ' ';
+		p = strstr(szLine, "$");
+		if(p) *p = ' ';
+		p = strstr(szLine, ";");		// Optional
+		if(p) *p = 0;
+		p = strstr(szLine, " ");		// 1st space between name & value
+		if (p)
+		{
+			int nLen = p - szLine;
+			if (nLen > MAX_SYMBOLS_LEN)
+			{
+				memset(&szLine[MAX_SYMBOLS_LEN], ' ', nLen - MAX_SYMBOLS_LEN);	// sscanf fails for nAddress if string too long
+			}
+		}
+		sscanf(szLine, "%31s %x", symbol_.sName, &symbol_.nAddress); // MAGIC NUMBER: MAX_SYMBOLS_LEN
+	}
+
+	return (symbol_.sName[0] != 0);
+}
+
+//===========================================================================
+static DWORD WINAPI _ParseSymbolChunk ( LPVOID pParam )
+{
+	SymbolLoadChunk_t *pChunk = (SymbolLoadChunk_t*) pParam;
+
+	const int MAX_LINE = 256;
+	char  szLine[ MAX_LINE ];
+
+	SymbolLoadEntry_t symbol;
+
+	const char *pSrc = pChunk->pBegin;
+	while (pSrc < pChunk->pEnd)
+	{
+		const char *pEOL = (const char*) memchr( pSrc, CHAR_LF, pChunk->pEnd - pSrc );
+		if (!pEOL)
+			pEOL = pChunk->pEnd;
+
+		size_t nLen = pEOL - pSrc;
+		if (nLen > MAX_LINE-2) // same limit as fgets(szLine, MAX_LINE-1)
+			nLen = MAX_LINE-2;
+
+		memcpy( szLine, pSrc, nLen );
+		szLine[ nLen ] = 0;
+
+		if (_ParseSymbolLine( szLine, symbol ))
+			pChunk->vSymbols.push_back( symbol );
+
+		pSrc = pEOL + 1;
+	}
+
+	return 0;
+}
+
+//===========================================================================
+static void _ParseSymbolFile ( const MemoryMappedFile_t & file, std::vector<SymbolLoadEntry_t> & vSymbols_ )
+{
+	const char  *pData = file.GetData();
+	const size_t nSize = file.GetSize();
+
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+
+	size_t nChunks = nSize / SYMBOL_LOAD_MIN_CHUNK;
+	nChunks = MIN( nChunks, (size_t) info.dwNumberOfProcessors );
+	nChunks = MIN( nChunks, (size_t) SYMBOL_LOAD_MAX_CHUNKS );
+	if (nChunks < 1)
+		nChunks = 1;
+
+	// Split on line boundaries
+	SymbolLoadChunk_t aChunks[ SYMBOL_LOAD_MAX_CHUNKS ];
+	const char *pBegin = pData;
+	for (size_t iChunk = 0; iChunk < nChunks; iChunk++)
+	{
+		const char *pEnd = pData + nSize;
+		if (iChunk < nChunks - 1)
+		{
+			const char *pSplit = pData + (nSize * (iChunk + 1)) / nChunks;
+			if (pSplit < pBegin)
+				pSplit = pBegin;
+
+			const char *pEOL = (const char*) memchr( pSplit, CHAR_LF, pEnd - pSplit );
+			if (pEOL)
+				pEnd = pEOL + 1;
+		}
+
+		aChunks[ iChunk ].pBegin = pBegin;
+		aChunks[ iChunk ].pEnd   = pEnd;
+		aChunks[ iChunk ].vSymbols.reserve( (pEnd - pBegin) / 24 ); // guess: average line length
+		pBegin = pEnd;
+	}
+
+	// 1st chunk is parsed on this thread
+	HANDLE aThreads[ SYMBOL_LOAD_MAX_CHUNKS ] = { NULL };
+	for (size_t iChunk = 1; iChunk < nChunks; iChunk++)
+		aThreads[ iChunk ] = CreateThread( NULL, 0, _ParseSymbolChunk, &aChunks[ iChunk ], 0, NULL );
+
+	_ParseSymbolChunk( &aChunks[ 0 ] );
+
+	for (size_t iChunk = 1; iChunk < nChunks; iChunk++)
+	{
+		if (aThreads[ iChunk ])
+		{
+			WaitForSingleObject( aThreads[ iChunk ], INFINITE );
+			CloseHandle( aThreads[ iChunk ] );
+		}
+		else
+		{
+			_ParseSymbolChunk( &aChunks[ iChunk ] ); // Couldn't create thread
+		}
+	}
+
+	size_t nSymbols = 0;
+	for (size_t iChunk = 0; iChunk < nChunks; iChunk++)
+		nSymbols += aChunks[ iChunk ].vSymbols.size();
+
+	vSymbols_.clear();
+	vSymbols_.reserve( nSymbols );
+	for (size_t iChunk = 0; iChunk < nChunks; iChunk++)
+		vSymbols_.insert( vSymbols_.end(), aChunks[ iChunk ].vSymbols.begin(), aChunks[ iChunk ].vSymbols.end() );
+}
+
+// Cache file in the user's temp folder, named after the symbol file's full path (so the install folder isn't written to)
+//===========================================================================
+static std::string _GetSymbolCacheFileName ( const std::string & sPathFileName )
+{
+	char sTempPath[ MAX_PATH ];
+	const DWORD nLen = GetTempPath( MAX_PATH, sTempPath );
+	if (!nLen || nLen >= MAX_PATH)
+		return std::string();
+
+	const size_t iName = sPathFileName.find_last_of( "\\/" );
+	const std::string sName = (iName == std::string::npos) ? sPathFileName : sPathFileName.substr( iName + 1 );
+
+	char sHash[ 32 ];
+	sprintf( sHash, "%08X", (unsigned int) std::hash<std::string>()( sPathFileName ) );
+
+	return std::string( sTempPath ) + "AppleWin_" + sName + "_" + sHash + ".cache";
+}
+
+//===========================================================================
+static bool _LoadSymbolCache ( const std::string & sCacheFileName, const MemoryMappedFile_t & file, std::vector<SymbolLoadEntry_t> & vSymbols_ )
+{
+	FILE *hFile = fopen( sCacheFileName.c_str(), "rb" );
+	if (!hFile)
+		return false;
+
+	bool bValid = false;
+
+	SymbolCacheHeader_t header;
+	if ((fread( &header, sizeof(header), 1, hFile ) == 1)
+	&& (strcmp( header.sMagic, "AWSYMC" ) == 0)
+	&& (header.nVersion  == SYMBOL_CACHE_VERSION)
+	&& (header.nFileSize == file.GetSize())
+	&& (header.nModTime  == file.GetModTime()))
+	{
+		vSymbols_.resize( header.nSymbols );
+		bValid = !header.nSymbols
+			|| (fread( &vSymbols_[0], sizeof(SymbolLoadEntry_t), header.nSymbols, hFile ) == header.nSymbols);
+	}
+
+	fclose( hFile );
+
+	if (!bValid)
+		vSymbols_.clear();
+
+	return bValid;
+}
+
+//===========================================================================
+static void _SaveSymbolCache ( const std::string & sCacheFileName, const MemoryMappedFile_t & file, const std::vector<SymbolLoadEntry_t> & vSymbols )
+{
+	FILE *hFile = fopen( sCacheFileName.c_str(), "wb" );
+	if (!hFile)
+		return; // Not an error, ie. read-only folder
+
+	SymbolCacheHeader_t header;
+	memset( &header, 0, sizeof(header) );
+	strcpy( header.sMagic, "AWSYMC" );
+	header.nVersion  = SYMBOL_CACHE_VERSION;
+	header.nSymbols  = (uint32_t) vSymbols.size();
+	header.nFileSize = file.GetSize();
+	header.nModTime  = file.GetModTime();
+
+	bool bOK = (fwrite( &header, sizeof(header), 1, hFile ) == 1);
+	if (bOK && header.nSymbols)
+		bOK = (fwrite( &vSymbols[0], sizeof(SymbolLoadEntry_t), vSymbols.size(), hFile ) == vSymbols.size());
+
+	fclose( hFile );
+
+	if (!bOK)
+		remove( sCacheFileName.c_str() );
+}
+
+// Symbols loaded so far from this file aren't in the lookup yet, as it is only rebuilt once the whole file is merged
+//===========================================================================
+static const char* _FindLoadedSymbolFromAddress ( WORD nAddress, int * iTable_, SymbolTable_Index_e eSymbolTableWrite, const std::vector<const char*> & vLoaded )
+{
+	int iTable;
+	const char *pSymbol = FindSymbolFromAddress( nAddress, &iTable );
+
+	if (vLoaded[ nAddress ] && (!pSymbol || (iTable <= eSymbolTableWrite)))
+	{
+		*iTable_ = eSymbolTableWrite;
+		return vLoaded[ nAddress ];
+	}
+
+	*iTable_ = iTable;
+	return pSymbol;
+}
+
+//===========================================================================
+static bool _FindLoadedAddressFromSymbol ( const char* pSymbol, WORD * pAddress_, int * iTable_, SymbolTable_Index_e eSymbolTableWrite, const std::unordered_map<std::string, WORD> & mapLoaded )
+{
+	int  iTable;
+	bool bFound = FindAddressFromSymbol( pSymbol, pAddress_, &iTable );
+
+	if (!bFound || (iTable <= eSymbolTableWrite))
+	{
+		std::unordered_map<std::string, WORD>::const_iterator iLoaded = mapLoaded.find( _SymbolLookupKey( pSymbol ) );
+		if (iLoaded != mapLoaded.end())
+		{
+			*pAddress_ = iLoaded->second;
+			*iTable_   = eSymbolTableWrite;
+			return true;
+		}
+	}
+
+	*iTable_ = iTable;
+	return bFound;
+}
+
 //===========================================================================
 int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSymbolTableWrite, int nSymbolOffset )
 {
@@ -564,20 +909,10 @@ int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSym
 	if (pPathFileName.empty())
 		return nSymbolsLoaded;
 
-//#if _UNICODE
-//	TCHAR sFormat1[ MAX_SYMBOLS_LEN ];
-//	TCHAR sFormat2[ MAX_SYMBOLS_LEN ];
-//	wsprintf( sFormat1, "%%x %%%ds", MAX_SYMBOLS_LEN ); // i.e. "%x %13s"
-//	wsprintf( sFormat2, "%%%ds %%x", MAX_SYMBOLS_LEN ); // i.e. "%13s %x"
-// ascii
-	char sFormat1[ MAX_SYMBOLS_LEN ];
-	char sFormat2[ MAX_SYMBOLS_LEN ];
-	sprintf( sFormat1, "%%x %%%ds", MAX_SYMBOLS_LEN ); // i.e. "%x %13s"
-	sprintf( sFormat2, "%%%ds %%x", MAX_SYMBOLS_LEN ); // i.e. "%13s %x"
+	MemoryMappedFile_t file;
+	bool bFileOpen = file.Open( pPathFileName );
 
-	FILE *hFile = fopen( pPathFileName.c_str(), "rt" );
-
-	if( !hFile && g_bSymbolsDisplayMissingFile )
+	if( !bFileOpen && g_bSymbolsDisplayMissingFile )
 	{
 		// TODO: print filename! Bug #242 Help file (.chm) description for "Symbols" #242
 		ConsoleDisplayError( "Symbol File not found:" );
@@ -586,56 +921,34 @@ int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSym
 	}
 	
 	bool bDupSymbolHeader = false;
-	if( hFile )
+	if( bFileOpen )
 	{
-		while( !feof(hFile) )
+		std::vector<SymbolLoadEntry_t> vSymbols;
+
+		const std::string sCacheFileName = (file.GetSize() >= SYMBOL_LOAD_MIN_CHUNK)
+			? _GetSymbolCacheFileName( pPathFileName )
+			: std::string();
+
+		if (sCacheFileName.empty() || !_LoadSymbolCache( sCacheFileName, file, vSymbols ))
 		{
-			// Support 2 types of symbols files:
-			// 1) AppleWin:
-			//    . 0000 SYMBOL
-			//    . FFFF SYMBOL
-			// 2) ACME:
-			//    . SYMBOL  =$0000; Comment
-			//    . SYMBOL  =$FFFF; Comment
-			//
-			DWORD nAddress = _6502_MEM_END + 1; // default to invalid address
-			char  sName[ MAX_SYMBOLS_LEN+1 ]  = "";
-
-			const int MAX_LINE = 256;
-			char  szLine[ MAX_LINE ] = "";
-
-			if( !fgets(szLine, MAX_LINE-1, hFile) )	// Get next line
-			{
-				//ConsolePrint("<<EOF");
-				break;
-			}
+			_ParseSymbolFile( file, vSymbols );
+			if (!sCacheFileName.empty())
+				_SaveSymbolCache( sCacheFileName, file, vSymbols );
+		}
 
-			if(strstr(szLine, "$") == NULL)
-			{
-				sscanf(szLine, sFormat1, &nAddress, sName);
-			}
-			else
-			{
-				char* p = strstr(szLine, "=");	// Optional
-				if(p) *p = ' ';
-				p = strstr(szLine, "$");
-				if(p) *p = ' ';
-				p = strstr(szLine, ";");		// Optional
-				if(p) *p = 0;
-				p = strstr(szLine, " ");		// 1st space between name & value
-				if (p)
-				{
-					int nLen = p - szLine;
-					if (nLen > MAX_SYMBOLS_LEN)
-					{
-						memset(&szLine[MAX_SYMBOLS_LEN], ' ', nLen - MAX_SYMBOLS_LEN);	// sscanf fails for nAddress if string too long
-					}
-				}
-				sscanf(szLine, sFormat2, sName, &nAddress);
-			}
+		file.Close();
+
+		// Symbols merged so far, only searched if this table is active, same as FindSymbolFromAddress()
+		const bool bTableActive = (g_bDisplaySymbolTables & (1 << eSymbolTableWrite)) != 0;
+		std::vector<const char*>              vLoadedName( _6502_MEM_LEN, (const char*) NULL );
+		std::unordered_map<std::string, WORD> mapLoadedAddress;
+
+		for (size_t iSymbol = 0; iSymbol < vSymbols.size(); iSymbol++)
+		{
+			const char *sName = vSymbols[ iSymbol ].sName;
 
 			// SymbolOffset
-			nAddress += nSymbolOffset;
+			DWORD nAddress = vSymbols[ iSymbol ].nAddress + nSymbolOffset;
 
 			if( (nAddress > _6502_MEM_END) || (sName[0] == 0) )
 				continue;
@@ -659,7 +972,7 @@ int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSym
 			}
 
 			// 2.8.0.5 Bug #244 (Debugger) Duplicate symbols for identical memory addresses in APPLE2E.SYM
-			const char *pSymbolPrev = FindSymbolFromAddress( (WORD)nAddress, &iTable ); // don't care which table it is in
+			const char *pSymbolPrev = _FindLoadedSymbolFromAddress( (WORD)nAddress, &iTable, eSymbolTableWrite, vLoadedName ); // don't care which table it is in
 			if( pSymbolPrev )
 			{
 				if( !bFileDisplayed )
@@ -713,7 +1026,7 @@ int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSym
 */
 			}
 
-			bool bExists  = FindAddressFromSymbol( sName, &nAddressPrev, &iTable );
+			bool bExists  = _FindLoadedAddressFromSymbol( sName, &nAddressPrev, &iTable, eSymbolTableWrite, mapLoadedAddress );
 			if( bExists )
 			{
 				if( !bDupSymbolHeader )
@@ -743,8 +1056,15 @@ int ParseSymbolTable(const std::string & pPathFileName, SymbolTable_Index_e eSym
 
 			g_aSymbols[ eSymbolTableWrite ] [ (WORD) nAddress ] = sName;
 			nSymbolsLoaded++; // TODO: FIXME: BUG: This is the total symbols read, not added
+
+			if (bTableActive)
+			{
+				vLoadedName[ nAddress ] = sName;
+				mapLoadedAddress[ _SymbolLookupKey( sName ) ] = (WORD) nAddress;
+			}
 		}
-		fclose(hFile);
+
+		SymbolsLookupInvalidate();
 	}
 
 	return nSymbolsLoaded;
@@ -827,6 +1147,7 @@ Update_t CmdSymbolsLoad (int nArgs)
 Update_t _CmdSymbolsClear( SymbolTable_Index_e eSymbolTable )
 {
 	g_aSymbols[ eSymbolTable ].clear();
+	SymbolsLookupInvalidate();
 	
 	return UPDATE_SYMBOLS;
 }
@@ -854,6 +1175,7 @@ void SymbolUpdate( SymbolTable_Index_e eSymbolTable, const char *pSymbolName, WO
 				}
 
 				g_aSymbols[ eSymbolTable ].erase( nAddressPrev );
+				SymbolsLookupInvalidate();
 
 				if (bUpdateSymbol)
 				{
@@ -886,6 +1208,7 @@ void SymbolUpdate( SymbolTable_Index_e eSymbolTable, const char *pSymbolName, WO
 			}
 #endif
 			g_aSymbols[ eSymbolTable ][ nAddress ] = pSymbolName;
+			SymbolsLookupInvalidate();
 
 			// Tell user symbol was added
 			char sText[ CONSOLE_WIDTH * 2 ];
@@ -1003,6 +1326,7 @@ Update_t _CmdSymbolsCommon ( int nArgs, int bSymbolTables )
 			if (iParam == PARAM_ON)
 			{
 				g_bDisplaySymbolTables |= bSymbolTables;
+				SymbolsLookupInvalidate();
 				int iTable = _GetSymbolTableFromFlag( bSymbolTables );
 				if (iTable != NUM_SYMBOL_TABLES)
 				{
@@ -1015,6 +1339,7 @@ Update_t _CmdSymbolsCommon ( int nArgs, int bSymbolTables )
 			if (iParam == PARAM_OFF)
 			{
 				g_bDisplaySymbolTables &= ~bSymbolTables;
+				SymbolsLookupInvalidate();
 				int iTable = _GetSymbolTableFromFlag( bSymbolTables );
 				if (iTable != NUM_SYMBOL_TABLES)
 				{
@@ -20,4 +20,5 @@
 	WORD GetAddressFromSymbol(const char* symbol); // HACK: returns 0 if symbol not found
 	void SymbolUpdate(SymbolTable_Index_e eSymbolTable, const char* pSymbolName, WORD nAddrss, bool bRemoveSymbol, bool bUpdateSymbol);
 	const char* FindSymbolFromAddress(WORD nAdress, int* iTable_ = NULL);
+	void SymbolsLookupInvalidate();
 	const char* GetSymbol(WORD nAddress, int nBytes);
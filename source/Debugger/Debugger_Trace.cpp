@@ -0,0 +1,440 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2021, Tom Charlesworth, Michael Pohoreski
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Debugger Binary Trace
+ *
+ * Author: Various
+ */
+
+#include "StdAfx.h"
+
+#include "Debug.h"
+
+#include "../Core.h"
+#include "../CPU.h"
+
+// Binary Trace ___________________________________________________________________________________
+
+	DebugTrace_t g_DebugTrace;
+
+	static const char g_sTraceMagic[8] = "AWTRACE";
+
+	static char g_sFileNameTraceBinary [] = "Trace.bin";
+	static char g_sFileNameTraceDecoded[] = "TraceDecoded.txt";
+
+
+// Recording ______________________________________________________________________________________
+
+// Called by Trace_X() when the last record of the ring buffer has been written
+//===========================================================================
+void DebugTraceWrap ()
+{
+	if (g_DebugTrace.hFile)
+		fwrite( g_DebugTrace.pRecords, sizeof( TraceRecord_t ), TRACE_RING_SIZE, g_DebugTrace.hFile );
+	else
+		g_DebugTrace.bWrapped = true;
+
+	g_DebugTrace.nHead = 0;
+}
+
+//===========================================================================
+static bool DebugTraceStart ( const bool bVideo, FILE *hFile )
+{
+	if (!g_DebugTrace.pRecords)
+		g_DebugTrace.pRecords = new TraceRecord_t[ TRACE_RING_SIZE ];
+
+	g_DebugTrace.bVideo      = bVideo;
+	g_DebugTrace.bWrapped    = false;
+	g_DebugTrace.hFile       = hFile;
+	g_DebugTrace.nHead       = 0;
+	g_DebugTrace.nCycleStart = g_nCumulativeCycles;
+	g_DebugTrace.nCycleLast  = g_nCumulativeCycles;
+
+	if (hFile)
+	{
+		TraceFileHeader_t header;
+		memset( &header, 0, sizeof( header ) );
+		memcpy( header.sMagic, g_sTraceMagic, sizeof( header.sMagic ) );
+		header.nVersion    = TRACE_FILE_VERSION;
+		header.nFlags      = bVideo ? TRACE_FLAG_VIDEO : 0;
+		header.nRecordSize = sizeof( TraceRecord_t );
+		header.eCpu        = GetMainCpu();	// Records are always 6502 (not Z80, even if the SoftCard is active)
+		header.nCycleStart = g_DebugTrace.nCycleStart;
+
+		if (fwrite( &header, sizeof( header ), 1, hFile ) != 1)
+			return false;
+	}
+
+	g_DebugTrace.bEnabled = true;
+	return true;
+}
+
+// Stop recording, flushing any records to the trace file
+// The ring buffer is kept, so it can still be decoded
+//===========================================================================
+void DebugTraceStop ()
+{
+	if (!g_DebugTrace.bEnabled)
+		return;
+
+	g_DebugTrace.bEnabled = false;
+
+	if (g_DebugTrace.hFile)
+	{
+		fwrite( g_DebugTrace.pRecords, sizeof( TraceRecord_t ), g_DebugTrace.nHead, g_DebugTrace.hFile );
+		fclose( g_DebugTrace.hFile );
+		g_DebugTrace.hFile = NULL;
+
+		g_DebugTrace.nHead = 0; // Nothing left in the ring buffer to decode
+		g_DebugTrace.bWrapped = false;
+	}
+}
+
+
+// Decoding _______________________________________________________________________________________
+
+// Same as GetDisassemblyLine(), but uses the recorded opcode bytes instead of memory
+//===========================================================================
+static void _TraceGetDisassemblyLine ( const TraceRecord_t & record, DisasmLine_t & line_ )
+{
+	line_.Clear();
+
+	const int iOpcode = record.aOpcode[0];
+	const int iOpmode = g_aOpcodes[ iOpcode ].nAddressMode;
+	const int nOpbyte = g_aOpmodes[ iOpmode ].m_nBytes;
+
+	line_.iOpcode = iOpcode;
+	line_.iOpmode = iOpmode;
+	line_.nOpbyte = nOpbyte;
+
+	if (iOpmode == AM_M)
+		line_.bTargetImmediate = true;
+
+	if ((iOpmode >= AM_IZX) && (iOpmode <= AM_NA))
+		line_.bTargetIndirect = true; // ()
+
+	if (((iOpmode >= AM_A) && (iOpmode <= AM_ZY)) || line_.bTargetIndirect)
+		line_.bTargetValue = true; // #$
+
+	int nTarget = record.aOpcode[1] | (record.aOpcode[2] << 8);
+	if (nOpbyte == 2)
+		nTarget &= 0xFF;
+
+	if (iOpmode == AM_R)
+	{
+		line_.bTargetRelative = true;
+		nTarget = (record.nPC + 2 + (int)(signed char)nTarget) & _6502_MEM_END;
+		sprintf( line_.sTargetValue, "%04X", nTarget );
+	}
+	else
+	if (iOpmode == AM_M)
+	{
+		sprintf( line_.sTarget, "%02X", (unsigned) nTarget );
+	}
+
+	line_.nTarget = nTarget;
+
+	sprintf( line_.sAddress, "%04X", record.nPC );
+
+	char *pDst = line_.sOpCodes;
+	for (int iByte = 0; iByte < nOpbyte && iByte < MAX_OPCODES; iByte++)
+		pDst += sprintf( pDst, g_bConfigDisasmOpcodeSpaces ? "%02X " : "%02X", record.aOpcode[ iByte ] );
+
+	const int nMinBytesLen = (MAX_OPCODES * (2 + g_bConfigDisasmOpcodeSpaces));
+	while (pDst < line_.sOpCodes + nMinBytesLen)
+		*pDst++ = ' ';
+	*pDst = 0;
+
+	strcpy( line_.sMnemonic, g_aOpcodes[ iOpcode ].sMnemonic );
+}
+
+// Output is the same format as CmdTraceFile(), with symbols
+//===========================================================================
+static void _TraceDecodeRecord ( FILE *hOut, const TraceRecord_t & record, const uint64_t nCycle, const bool bVideo )
+{
+	const char *pSymbol = FindSymbolFromAddress( record.nPC );
+	if (pSymbol)
+		fprintf( hOut, "%s:\n", pSymbol );
+
+	DisasmLine_t line;
+	_TraceGetDisassemblyLine( record, line );
+
+	char sDisassembly[ CONSOLE_WIDTH ];
+	FormatDisassemblyLine( line, sDisassembly, CONSOLE_WIDTH );
+
+	char sFlags[] = "........";
+	WORD nRegFlags = record.nP;
+	int nFlag = _6502_NUM_FLAGS;
+	while (nFlag--)
+	{
+		int iFlag = (_6502_NUM_FLAGS - nFlag - 1);
+		bool bSet = (nRegFlags & 1);
+		if (bSet)
+			sFlags[nFlag] = g_aBreakpointSource[BP_SRC_FLAG_C + iFlag][0];
+		nRegFlags >>= 1;
+	}
+
+	const char *pTarget = NULL;
+	if (line.bTargetValue || line.bTargetRelative)
+		pTarget = FindSymbolFromAddress( line.nTarget );
+
+	if (bVideo)
+	{
+		fprintf( hOut,
+			"%04X %04X %02X %02X %02X %04X %s  %-30s%s%s\n",
+			record.nVideo >> 7,
+			record.nVideo & 0x7F,
+			(unsigned)record.nA,
+			(unsigned)record.nX,
+			(unsigned)record.nY,
+			(unsigned)(0x100 | record.nSP),
+			sFlags,
+			sDisassembly,
+			pTarget ? "; " : "",
+			pTarget ? pTarget : ""
+		);
+	}
+	else
+	{
+		fprintf( hOut,
+			"%08X %02X %02X %02X %04X %s  %-30s%s%s\n",
+			(UINT) nCycle,
+			(unsigned)record.nA,
+			(unsigned)record.nX,
+			(unsigned)record.nY,
+			(unsigned)(0x100 | record.nSP),
+			sFlags,
+			sDisassembly,
+			pTarget ? "; " : "",
+			pTarget ? pTarget : ""
+		);
+	}
+}
+
+//===========================================================================
+static void _TraceDecodeHeader ( FILE *hOut, const bool bVideo )
+{
+	if (bVideo)
+		fprintf( hOut, "Vert Horz A: X: Y: SP:  Flags     Addr:Opcode    Mnemonic\n" );
+	else
+		fprintf( hOut, "Cycles   A: X: Y: SP:  Flags     Addr:Opcode    Mnemonic\n" );
+}
+
+// Decode the ring buffer, oldest record first
+// Returns number of records decoded
+//===========================================================================
+static UINT _TraceDecodeRing ( FILE *hOut )
+{
+	const UINT nRecords = g_DebugTrace.bWrapped ? TRACE_RING_SIZE : g_DebugTrace.nHead;
+	const UINT iOldest  = g_DebugTrace.bWrapped ? g_DebugTrace.nHead : 0;
+
+	if (!nRecords)
+		return 0;
+
+	// Only the newest cycle is known, so work back to the oldest record
+	uint64_t nCycle = g_DebugTrace.nCycleLast;
+	for (UINT iRecord = 1; iRecord < nRecords; iRecord++)
+		nCycle -= g_DebugTrace.pRecords[ (iOldest + iRecord) % TRACE_RING_SIZE ].nCycles;
+
+	_TraceDecodeHeader( hOut, g_DebugTrace.bVideo );
+
+	for (UINT iRecord = 0; iRecord < nRecords; iRecord++)
+	{
+		const TraceRecord_t & record = g_DebugTrace.pRecords[ (iOldest + iRecord) % TRACE_RING_SIZE ];
+		if (iRecord)
+			nCycle += record.nCycles;
+
+		_TraceDecodeRecord( hOut, record, nCycle, g_DebugTrace.bVideo );
+	}
+
+	return nRecords;
+}
+
+// Returns number of records decoded, or -1 if not a valid trace file
+//===========================================================================
+static int _TraceDecodeFile ( FILE *hIn, FILE *hOut )
+{
+	TraceFileHeader_t header;
+	if (fread( &header, sizeof( header ), 1, hIn ) != 1)
+		return -1;
+
+	if (memcmp( header.sMagic, g_sTraceMagic, sizeof( header.sMagic ) ) != 0
+	||  header.nVersion    != TRACE_FILE_VERSION
+	||  header.nRecordSize != sizeof( TraceRecord_t ))
+		return -1;
+
+	const bool bVideo = (header.nFlags & TRACE_FLAG_VIDEO) != 0;
+
+	// Trace may have been recorded with a different CPU
+	const Opcodes_t *pOpcodes = g_aOpcodes;
+	g_aOpcodes = (header.eCpu == CPU_6502) ? g_aOpcodes6502 : g_aOpcodes65C02;
+
+	_TraceDecodeHeader( hOut, bVideo );
+
+	const UINT nBlock = 4096;
+	std::vector<TraceRecord_t> vRecords( nBlock );
+
+	uint64_t nCycle   = header.nCycleStart;
+	int      nRecords = 0;
+	size_t   nRead;
+
+	while ((nRead = fread( &vRecords[0], sizeof( TraceRecord_t ), nBlock, hIn )) > 0)
+	{
+		for (size_t iRecord = 0; iRecord < nRead; iRecord++)
+		{
+			nCycle += vRecords[ iRecord ].nCycles;
+			_TraceDecodeRecord( hOut, vRecords[ iRecord ], nCycle, bVideo );
+		}
+		nRecords += (int) nRead;
+	}
+
+	g_aOpcodes = pOpcodes;
+
+	return nRecords;
+}
+
+
+// Commands _______________________________________________________________________________________
+
+//===========================================================================
+Update_t CmdTraceBuffer (int nArgs)
+{
+	char sText[ CONSOLE_WIDTH ] = "";
+
+	if (g_DebugTrace.bEnabled)
+	{
+		DebugTraceStop();
+		ConsoleBufferPush( "Trace stopped." );
+	}
+	else
+	{
+		const bool bVideo = (nArgs >= 1);
+		DebugTraceStart( bVideo, NULL );
+
+		ConsoleBufferPushFormat( sText, bVideo ? "Trace (with video info) started: %d instruction ring buffer"
+		                                       : "Trace started: %d instruction ring buffer", TRACE_RING_SIZE );
+	}
+
+	ConsoleBufferToDisplay();
+
+	return UPDATE_ALL;
+}
+
+//===========================================================================
+Update_t CmdTraceFileBinary (int nArgs)
+{
+	char sText[ CONSOLE_WIDTH ] = "";
+
+	if (g_DebugTrace.bEnabled)
+	{
+		DebugTraceStop();
+		ConsoleBufferPush( "Trace stopped." );
+	}
+	else
+	{
+		std::string sFileName;
+
+		if (nArgs)
+			sFileName = g_aArgs[1].sArg;
+		else
+			sFileName = g_sFileNameTraceBinary;
+
+		const bool bVideo = (nArgs >= 2);
+
+		const std::string sFilePath = g_sCurrentDir + sFileName;
+
+		FILE *hFile = fopen( sFilePath.c_str(), "wb" );
+
+		if (hFile && DebugTraceStart( bVideo, hFile ))
+		{
+			const char* pTextHdr = bVideo ? "Trace (with video info) started: %s"
+			                              : "Trace started: %s";
+			ConsoleBufferPushFormat( sText, pTextHdr, sFilePath.c_str() );
+		}
+		else
+		{
+			if (hFile)
+				fclose( hFile );
+
+			g_DebugTrace.hFile = NULL;
+			ConsoleBufferPushFormat( sText, "Trace ERROR: %s", sFilePath.c_str() );
+		}
+	}
+
+	ConsoleBufferToDisplay();
+
+	return UPDATE_ALL;
+}
+
+//===========================================================================
+Update_t CmdTraceFileDecode (int nArgs)
+{
+	char sText[ CONSOLE_WIDTH ] = "";
+
+	const std::string sFileOut = g_sCurrentDir + ((nArgs >= 2) ? g_aArgs[2].sArg : g_sFileNameTraceDecoded);
+
+	FILE *hIn = NULL;
+	std::string sFileIn;
+
+	if (nArgs)
+	{
+		sFileIn = g_sCurrentDir + g_aArgs[1].sArg;
+		hIn = fopen( sFileIn.c_str(), "rb" );
+		if (!hIn)
+		{
+			ConsoleBufferPushFormat( sText, "Trace ERROR: %s", sFileIn.c_str() );
+			return ConsoleUpdate();
+		}
+	}
+	else
+	if (g_DebugTrace.bEnabled && g_DebugTrace.hFile)
+	{
+		ConsoleBufferPush( "Trace ERROR: Stop tracing to file first." );
+		return ConsoleUpdate();
+	}
+
+	FILE *hOut = fopen( sFileOut.c_str(), "wt" );
+	if (!hOut)
+	{
+		if (hIn)
+			fclose( hIn );
+
+		ConsoleBufferPushFormat( sText, "Trace ERROR: %s", sFileOut.c_str() );
+		return ConsoleUpdate();
+	}
+
+	const int nRecords = hIn
+		? _TraceDecodeFile( hIn, hOut )
+		: (int) _TraceDecodeRing( hOut );
+
+	fclose( hOut );
+	if (hIn)
+		fclose( hIn );
+
+	if (nRecords < 0)
+		ConsoleBufferPushFormat( sText, "Trace ERROR: Not a binary trace file: %s", sFileIn.c_str() );
+	else
+		ConsoleBufferPushFormat( sText, "Decoded %d instructions: %s", nRecords, sFileOut.c_str() );
+
+	return ConsoleUpdate();
+}
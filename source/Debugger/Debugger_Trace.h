@@ -0,0 +1,59 @@
+#pragma once
+
+// Binary Trace ___________________________________________________________________________________
+
+	// Records are written by the debug CPU core (Cpu6502_debug, Cpu65C02_debug) before each opcode
+	// is executed, see TRACE_X() in CPU.cpp and Trace_X() in cpu_heatmap.inl
+	// Disassembly and symbol lookup is deferred until the trace is decoded, see CmdTraceFileDecode()
+	enum TraceFlags_e
+	{
+		TRACE_FLAG_VIDEO = (1 << 0), // TraceRecord_t.nVideo is valid
+	};
+
+	enum
+	{
+		TRACE_FILE_VERSION = 1,
+		TRACE_RING_SIZE    = (1 << 20), // records, 16 MB
+	};
+
+#pragma pack(push,1)
+	struct TraceRecord_t // 16 bytes
+	{
+		uint32_t nCycles   ; // delta since previous record (saturated)
+		uint16_t nPC       ;
+		BYTE     aOpcode[3];
+		BYTE     nA        ;
+		BYTE     nX        ;
+		BYTE     nY        ;
+		BYTE     nP        ;
+		BYTE     nSP       ; // $01xx
+		uint16_t nVideo    ; // (g_nVideoClockVert << 7) | g_nVideoClockHorz
+	};
+
+	struct TraceFileHeader_t
+	{
+		char     sMagic[8]  ; // "AWTRACE"
+		uint32_t nVersion   ;
+		uint32_t nFlags     ; // TraceFlags_e
+		uint32_t nRecordSize; // sizeof(TraceRecord_t)
+		uint32_t eCpu       ; // eCpuType
+		uint64_t nCycleStart; // g_nCumulativeCycles before 1st record
+	};
+#pragma pack(pop)
+
+	struct DebugTrace_t
+	{
+		bool           bEnabled   ;
+		bool           bVideo     ;
+		bool           bWrapped   ; // ring buffer has overwritten old records
+		FILE          *hFile      ; // NULL = ring buffer only
+		UINT           nHead      ; // next record to write
+		uint64_t       nCycleStart;
+		uint64_t       nCycleLast ;
+		TraceRecord_t *pRecords   ; // [TRACE_RING_SIZE]
+	};
+
+	extern DebugTrace_t g_DebugTrace;
+
+	void DebugTraceWrap ();
+	void DebugTraceStop ();
@@ -0,0 +1,33 @@
+#pragma once
+
+// Breakpoint Traps _______________________________________________________________________________
+
+	// Breakpoints are compiled into lookup tables so that the debug CPU core (Cpu6502_debug, Cpu65C02_debug)
+	// can execute a whole execution period, and only return to the debugger when a trap fires.
+	// All tables are conservative filters: a set entry means "check this exactly", see CheckBreakpointsReg()
+	//
+	// . PC     : 1 bit per address
+	// . Opcode : BRK / Invalid opcodes / BRKOP, and JMP (abs) / JMP (abs,X) if there are memory breakpoints
+	// . Memory : Read/Write flags per 256 byte page (not zero page or stack, as pointers & stack aren't accessed via READ/WRITE)
+	//
+	// See: BreakpointTrapsBuild(), BreakpointTrap_X() in cpu_heatmap.inl
+	enum BreakpointTrapAccess_e
+	{
+		BP_TRAP_MEM_READ  = (1 << 0),
+		BP_TRAP_MEM_WRITE = (1 << 1),
+	};
+
+	struct BreakpointTraps_t
+	{
+		bool bArmed ; // DebugContinueStepping() is running the CPU for a full execution period
+		bool bHit   ; // A memory trap matched a breakpoint during the last opcode
+		bool bOpcode; // aOpcode[] has at least one entry
+		BYTE aPC    [ 0x10000 / 8 ];
+		BYTE aOpcode[ 256 ];
+		BYTE aMem   [ 256 ];
+	};
+
+	extern BreakpointTraps_t g_BreakpointTraps;
+
+	void BreakpointTrapMem ( WORD nAddress, BYTE nAccess );
+	bool IsDebugBreakpointTrapsArmed (void);
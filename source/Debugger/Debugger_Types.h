@@ -214,6 +214,8 @@
 		bool                 bSet    ; // used to be called enabled pre 2.0
 		bool                 bEnabled;
 		bool                 bTemp;    // If true then remove BP when hit or stepping cancelled (eg. G xxxx)
+		bool                 bExternal; // Set by BreakpointAdd() (eg. GDB stub), so BreakpointRemove() leaves the user's own BPs alone
+		UINT                 nHits ;   // Times hit (and condition evaluated) since added, see BPIF
 	};
 
 	typedef Breakpoint_t Bookmark_t;
@@ -290,13 +292,18 @@
 		, CMD_CURSOR_SET_PC  // Ctrl
 		, CMD_GO_NORMAL_SPEED
 		, CMD_GO_FULL_SPEED
+		, CMD_GO_REVERSE
 		, CMD_IN
 		, CMD_INPUT_KEY
 		, CMD_JSR
 		, CMD_NOP
 		, CMD_OUT
 // CPU - Meta Info
+		, CMD_HISTORY
 		, CMD_PROFILE
+		, CMD_COVERAGE
+		, CMD_IOSTATS
+		, CMD_CYCLEAUDIT
 		, CMD_REGISTER_SET
 // CPU - Stack
 //		, CMD_STACK_LIST
@@ -308,8 +315,12 @@
 		, CMD_STEP_OUT
 // CPU - Meta Info
 		, CMD_TRACE
+		, CMD_TRACE_BUFFER
 		, CMD_TRACE_FILE
+		, CMD_TRACE_FILE_BINARY
+		, CMD_TRACE_FILE_DECODE
 		, CMD_TRACE_LINE
+		, CMD_TRACE_REVERSE
 		, CMD_UNASSEMBLE
 // Bookmarks
 		, CMD_BOOKMARK
@@ -329,6 +340,7 @@
 //		,	CMD_BREAKPOINT_SET  = CMD_BREAKPOINT_ADD_ADDR // alias
 //		,	CMD_BREAKPOINT_EXEC = CMD_BREAKPOINT_ADD_ADDR // alias
 		, CMD_BREAKPOINT_ADD_IO  // break on: [$C000-$C7FF] Load/Store 
+		, CMD_BREAKPOINT_IF      // condition: expression evaluated when hit
 		, CMD_BREAKPOINT_ADD_MEM // break on: [$0000-$FFFF], excluding IO
 		, CMD_BREAKPOINT_ADD_MEMR // break on read on: [$0000-$FFFF], excluding IO
 		, CMD_BREAKPOINT_ADD_MEMW // break on write on: [$0000-$FFFF], excluding IO
@@ -455,6 +467,7 @@
 //		, CMD_MEMORY_SEARCH_ASCII   // Ascii Text
 //		, CMD_MEMORY_SEARCH_APPLE   // Flashing Chars, Hi-Bit Set
 		, CMD_MEMORY_SEARCH_HEX
+		, CMD_MEMORY_SEARCH_ALL
 		, CMD_MEMORY_FILL
 		, CMD_NTSC
 		, CMD_TEXT_SAVE
@@ -600,6 +613,8 @@
 	Update_t CmdBreakOpcode        (int nArgs); // Breakpoint IFF Full-speed!
 	Update_t CmdGoNormalSpeed      (int nArgs);
 	Update_t CmdGoFullSpeed        (int nArgs);
+	Update_t CmdGoReverse          (int nArgs);
+	Update_t CmdHistory            (int nArgs);
 	Update_t CmdIn                 (int nArgs);
 	Update_t CmdKey                (int nArgs);
 	Update_t CmdJSR                (int nArgs);
@@ -608,8 +623,12 @@
 	Update_t CmdStepOver           (int nArgs);
 	Update_t CmdStepOut            (int nArgs);
 	Update_t CmdTrace              (int nArgs);  // alias for CmdStepIn
+	Update_t CmdTraceBuffer        (int nArgs);
 	Update_t CmdTraceFile          (int nArgs);
+	Update_t CmdTraceFileBinary    (int nArgs);
+	Update_t CmdTraceFileDecode    (int nArgs);
 	Update_t CmdTraceLine          (int nArgs);
+	Update_t CmdTraceReverse       (int nArgs);
 	Update_t CmdUnassemble         (int nArgs); // code dump, aka, Unassemble
 // Bookmarks
 	Update_t CmdBookmark           (int nArgs);
@@ -625,6 +644,7 @@
 	Update_t CmdBreakpointAddReg   (int nArgs);
 	Update_t CmdBreakpointAddPC    (int nArgs);
 	Update_t CmdBreakpointAddIO    (int nArgs);
+	Update_t CmdBreakpointIf       (int nArgs);
 	Update_t CmdBreakpointAddMem   (int nArgs, BreakpointSource_t bpSrc = BP_SRC_MEM_RW);
 	Update_t CmdBreakpointAddMemA  (int nArgs);
 	Update_t CmdBreakpointAddMemR  (int nArgs);
@@ -641,6 +661,10 @@
 	Update_t CmdBenchmarkStart     (int nArgs); //Update_t CmdSetupBenchmark (int nArgs);
 	Update_t CmdBenchmarkStop      (int nArgs); //Update_t CmdExtBenchmark (int nArgs);
 	Update_t CmdProfile            (int nArgs);
+	Update_t CmdCoverage           (int nArgs);
+	Update_t CmdIoStats            (int nArgs);
+	Update_t CmdCycleAudit         (int nArgs);
+	Update_t CmdProfileCalls       (int nArgs); // PROFILE CALLS
 	Update_t CmdProfileStart       (int nArgs);
 	Update_t CmdProfileStop        (int nArgs);
 // Config
@@ -711,6 +735,7 @@
 	Update_t CmdMemorySearchAscii  (int nArgs);
 	Update_t CmdMemorySearchApple  (int nArgs);
 	Update_t CmdMemorySearchHex    (int nArgs);
+	Update_t CmdMemorySearchAll    (int nArgs);
 // Output/Scripts
 	Update_t CmdOutputCalc         (int nArgs);
 	Update_t CmdOutputEcho         (int nArgs);
@@ -1082,6 +1107,7 @@ const	DisasmData_t* pDisasmData; // If != NULL then bytes are marked up as data
 		OPCODE_RTS     = 0x60,
 		OPCODE_JMP_NA  = 0x6C, // Indirect Absolute
 		OPCODE_JMP_IAX = 0x7C, // Indexed (Absolute Indirect, X)
+		OPCODE_TXS     = 0x9A,
 		OPCODE_LDA_A   = 0xAD, // Absolute
 
 		OPCODE_NOP     = 0xEA, // No operation
@@ -1204,7 +1230,17 @@ const	DisasmData_t* pDisasmData; // If != NULL then bytes are marked up as data
 	};
 
 	typedef std::vector<MemorySearch_t> MemorySearchValues_t;
-	typedef std::vector<int>            MemorySearchResults_t;
+	typedef std::vector<int>            MemorySearchResults_t; // (MemorySearchBank_e << MEM_SEARCH_BANK_SHIFT) | address
+
+	enum MemorySearchBank_e
+	{
+		MEM_SEARCH_BANK_SHIFT = 16,
+		MEM_SEARCH_BANK_MASK  = (1 << MEM_SEARCH_BANK_SHIFT) - 1,
+
+		MEM_SEARCH_BANK_NONE  = 0x000, // current 64K, ie. mem[]
+		MEM_SEARCH_BANK_RAM   = 0x001, // + bank, see MemGetBankPtr(): 0 = main, 1 = aux, 1..n = RamWorks
+		MEM_SEARCH_BANK_LC    = 0x100, // + Language Card / Saturn 16K bank, addresses are $C000..$FFFF
+	};
 
 // Parameters _____________________________________________________________________________________
 
@@ -1381,6 +1417,7 @@ const	DisasmData_t* pDisasmData; // If != NULL then bytes are marked up as data
 	, _PARAM_GENERAL_BEGIN = _PARAM_FONT_END // Daisy Chain
 		, PARAM_FIND = _PARAM_GENERAL_BEGIN
 		, PARAM_BRANCH
+		, PARAM_CALLS
 		, PARAM_CATEGORY
 		, PARAM_CLEAR
 		, PARAM_LOAD
@@ -26,6 +26,64 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Util_Text.h"
 #include "Util_MemoryTextFile.h"
 
+// MemoryMappedFile _______________________________________________________________________________
+
+//===========================================================================
+bool MemoryMappedFile_t::Open( const std::string & pFileName )
+{
+	Close();
+
+	m_hFile = CreateFile( pFileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+	if (m_hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER nSize;
+	FILETIME      tModified;
+	if (!GetFileSizeEx( m_hFile, &nSize ) || !GetFileTime( m_hFile, NULL, NULL, &tModified ))
+	{
+		Close();
+		return false;
+	}
+
+	m_nSize    = (size_t) nSize.QuadPart;
+	m_nModTime = ((uint64_t)tModified.dwHighDateTime << 32) | tModified.dwLowDateTime;
+
+	if (!m_nSize)
+		return true; // Can't map an empty file
+
+	m_hMap = CreateFileMapping( m_hFile, NULL, PAGE_READONLY, 0, 0, NULL );
+	if (m_hMap)
+		m_pData = (const char*) MapViewOfFile( m_hMap, FILE_MAP_READ, 0, 0, 0 );
+
+	if (!m_pData)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+//===========================================================================
+void MemoryMappedFile_t::Close()
+{
+	if (m_pData)
+		UnmapViewOfFile( m_pData );
+
+	if (m_hMap)
+		CloseHandle( m_hMap );
+
+	if (m_hFile != INVALID_HANDLE_VALUE)
+		CloseHandle( m_hFile );
+
+	m_hFile    = INVALID_HANDLE_VALUE;
+	m_hMap     = NULL;
+	m_pData    = NULL;
+	m_nSize    = 0;
+	m_nModTime = 0;
+}
+
+
 // MemoryTextFile _________________________________________________________________________________
 
 const int EOL_NULL = 0;
@@ -33,29 +91,22 @@ const int EOL_NULL = 0;
 //===========================================================================
 bool MemoryTextFile_t::Read( const std::string & pFileName )
 {
-	bool bStatus = false;
-	FILE *hFile = fopen( pFileName.c_str(), "rb" );
+	MemoryMappedFile_t file;
+	if (!file.Open( pFileName ))
+		return false;
 
-	if (hFile)
-	{
-		fseek( hFile, 0, SEEK_END );
-		long nSize = ftell( hFile );
-		fseek( hFile, 0, SEEK_SET );
+	const char *pData = file.GetData();
+	const size_t nSize = file.GetSize();
 
-		m_vBuffer.reserve( nSize + 1 );
-		m_vBuffer.insert( m_vBuffer.begin(), nSize+1, 0 ); // NOTE: Can NOT m_vBuffer.clear(); MUST insert() _before_ using at()
+	m_vBuffer.assign( pData, pData + nSize );
+	m_vBuffer.push_back( EOL_NULL );
 
-		char *pBuffer = & m_vBuffer.at(0);
-		fread( (void*)pBuffer, nSize, 1, hFile );
-		fclose(hFile);
+	m_vLines.reserve( nSize / 32 ); // guess: average source line length
 
-		m_bDirty = true;
-		GetLinePointers();
-
-		bStatus = true;
-	}
+	m_bDirty = true;
+	GetLinePointers();
 
-	return bStatus;
+	return true;
 }
 
 
@@ -1,5 +1,39 @@
 #pragma once
 
+// Memory Mapped File _______________________________________________________
+
+	// Read-only view of a whole file
+	class MemoryMappedFile_t
+	{
+		HANDLE      m_hFile   ;
+		HANDLE      m_hMap    ;
+		const char *m_pData   ;
+		size_t      m_nSize   ;
+		uint64_t    m_nModTime; // FILETIME of last write
+
+	public:
+		MemoryMappedFile_t()
+		: m_hFile( INVALID_HANDLE_VALUE )
+		, m_hMap( NULL )
+		, m_pData( NULL )
+		, m_nSize( 0 )
+		, m_nModTime( 0 )
+		{
+		}
+
+		~MemoryMappedFile_t()
+		{
+			Close();
+		}
+
+		bool Open( const std::string & pFileName );
+		void Close();
+
+inline	const char *GetData   () const { return m_pData   ; } // NULL if file is empty
+inline	size_t      GetSize   () const { return m_nSize   ; }
+inline	uint64_t    GetModTime() const { return m_nModTime; }
+	};
+
 // Memory Text File _________________________________________________________
 
 	class MemoryTextFile_t
@@ -18,6 +18,8 @@ public:
 	virtual void InitializeIO(void);
 	virtual void SetMemorySize(UINT banks) {}		// No-op for //e and slot-0 16K LC
 	virtual UINT GetActiveBank(void) { return 0; }	// Always 0 as only 1x 16K bank
+	virtual UINT GetNumBanks(void) { return 0; }		// //e LC RAM is in main/aux memory, see MemGetBankPtr()
+	virtual LPBYTE GetBankMemory(UINT bank) { return NULL; }
 	virtual void SaveSnapshot(class YamlSaveHelper& yamlSaveHelper) { _ASSERT(0); } // Not used for //e
 	virtual bool LoadSnapshot(class YamlLoadHelper& yamlLoadHelper, UINT slot, UINT version) { _ASSERT(0); return false; } // Not used for //e
 
@@ -47,6 +49,8 @@ public:
 
 	virtual void SaveSnapshot(class YamlSaveHelper& yamlSaveHelper);
 	virtual bool LoadSnapshot(class YamlLoadHelper& yamlLoadHelper, UINT slot, UINT version);
+	virtual UINT GetNumBanks(void) { return 1; }
+	virtual LPBYTE GetBankMemory(UINT bank) { return bank == 0 ? m_pMemory : NULL; }	// 16K: $C000 offset ($D000 bank 2 is at +$0000, $D000 bank 1 at +$1000)
 
 	static const UINT kMemBankSize = 16*1024;
 	static std::string GetSnapshotCardName(void);
@@ -76,6 +80,8 @@ public:
 	virtual UINT GetActiveBank(void);
 	virtual void SaveSnapshot(class YamlSaveHelper& yamlSaveHelper);
 	virtual bool LoadSnapshot(class YamlLoadHelper& yamlLoadHelper, UINT slot, UINT version);
+	virtual UINT GetNumBanks(void) { return m_uSaturnTotalBanks; }
+	virtual LPBYTE GetBankMemory(UINT bank) { return bank < m_uSaturnTotalBanks ? m_aSaturnBanks[bank] : NULL; }
 
 	static BYTE __stdcall IO(WORD PC, WORD uAddr, BYTE bWrite, BYTE uValue, ULONG nExecutedCycles);
 
@@ -53,6 +53,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "Speaker.h"
 #include "Tape.h"
 #include "RGBMonitor.h"
+#include "Uthernet2.h"
 
 #include "z80emu.h"
 #include "Z80VICE/z80.h"
@@ -1765,6 +1766,12 @@ void MemInitializeIO(void)
 
 	if (GetCardMgr().QuerySlot(SLOT7) == CT_GenericHDD)
 		HD_Load_Rom(pCxRomPeripheral, SLOT7);			// $C700 : HDD f/w
+
+	for (UINT slot = SLOT1; slot < NUM_SLOTS; slot++)
+	{
+		if (GetCardMgr().QuerySlot(slot) == CT_Uthernet2)
+			dynamic_cast<Uthernet2&>(GetCardMgr().GetRef(slot)).InitializeIO(pCxRomPeripheral);	// $C0n4-$C0n7 : W5100 (no ROM)
+	}
 }
 
 // Called by:
@@ -47,6 +47,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "SerialComms.h"
 #include "Speaker.h"
 #include "Speech.h"
+#include "Uthernet2.h"
 #include "z80emu.h"
 
 #include "Configuration/Config.h"
@@ -337,6 +338,12 @@ static void ParseSlots(YamlLoadHelper& yamlLoadHelper, UINT unitVersion)
 			GetCardMgr().Insert(slot, type);
 			bRes = dynamic_cast<CMouseInterface&>(GetCardMgr().GetRef(slot)).LoadSnapshot(yamlLoadHelper, slot, cardVersion);
 		}
+		else if (card == Uthernet2::GetSnapshotCardName())
+		{
+			type = CT_Uthernet2;
+			GetCardMgr().Insert(slot, type);
+			bRes = dynamic_cast<Uthernet2&>(GetCardMgr().GetRef(slot)).LoadSnapshot(yamlLoadHelper, slot, cardVersion);
+		}
 		else if (card == Z80_GetSnapshotCardName())
 		{
 			bRes = Z80_LoadSnapshot(yamlLoadHelper, slot, cardVersion);
@@ -486,6 +493,12 @@ static void Snapshot_LoadState_v2(void)
 		if (GetCardMgr().QuerySlot(SLOT5) == CT_Disk2)
 			GetCardMgr().Remove(SLOT5);		// Remove Disk2 card from slot-5
 
+		for (UINT slot = SLOT1; slot < NUM_SLOTS; slot++)
+		{
+			if (GetCardMgr().QuerySlot(slot) == CT_Uthernet2)
+				GetCardMgr().Remove(slot);	// Remove Uthernet II cards (re-inserted if in the snapshot)
+		}
+
 		GetCardMgr().GetDisk2CardMgr().Reset(false);
 
 		HD_Reset();
@@ -635,6 +648,12 @@ void Snapshot_SaveState(void)
 
 			if (GetCardMgr().QuerySlot(SLOT7) == CT_GenericHDD)
 				HD_SaveSnapshot(yamlSaveHelper);
+
+			for (UINT slot = SLOT1; slot < NUM_SLOTS; slot++)
+			{
+				if (GetCardMgr().QuerySlot(slot) == CT_Uthernet2)
+					dynamic_cast<Uthernet2&>(GetCardMgr().GetRef(slot)).SaveSnapshot(yamlSaveHelper);
+			}
 		}
 
 		// Miscellaneous
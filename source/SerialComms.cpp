@@ -36,6 +36,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "StdAfx.h"
 
 #include "SerialComms.h"
+#include "CardManager.h"
+#include "Core.h"	// g_SynchronousEventMgr
 #include "CPU.h"
 #include "Interface.h"
 #include "Log.h"
@@ -45,6 +47,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include "../resource/resource.h"
 
 #define TCP_SERIAL_PORT 1977
+#define TCP_SERIAL_THREAD_POLL_MS 50	// How often CommTcpThread checks whether it should exit
+
+#define SSC_SYNC_EVENT_ID_RX 0x100	// + slot#, to keep it unique (Mockingboard uses 0-7, Mousecard uses slot#)
+#define SSC_SYNC_EVENT_ID_TX 0x110	// + slot#
 
 // Default: 9600-8-N-1
 SSC_DIPSW CSuperSerialCard::m_DIPSWDefault =
@@ -69,7 +75,10 @@ CSuperSerialCard::CSuperSerialCard(UINT slot) :
 	m_aySerialPortChoices(NULL),
 	m_uTCPChoiceItemIdx(0),
 	m_bCfgSupportDCD(false),
-	m_pExpansionRom(NULL)
+	m_bCfgTcpSerialTurbo(false),
+	m_pExpansionRom(NULL),
+	m_syncEventRx(SSC_SYNC_EVENT_ID_RX + slot, 0, SyncEventCallbackRx),
+	m_syncEventTx(SSC_SYNC_EVENT_ID_TX + slot, 0, SyncEventCallbackTx)
 {
 	m_ayCurrentSerialPortName.clear();
 	m_dwSerialPortItem = 0;
@@ -79,6 +88,8 @@ CSuperSerialCard::CSuperSerialCard(UINT slot) :
 	m_hCommAcceptSocket = INVALID_SOCKET;
 
 	m_hCommThread = NULL;
+	m_hCommTcpThread = NULL;
+	m_vbCommTcpThreadQuit = false;
 
 	for (UINT i=0; i<COMMEVT_MAX; i++)
 		m_hCommEvent[i] = NULL;
@@ -106,7 +117,14 @@ void CSuperSerialCard::InternalReset()
 	m_vuRxCurrBuffer = 0;
 	m_qComSerialBuffer[0].clear();
 	m_qComSerialBuffer[1].clear();
-	m_qTcpSerialBuffer.clear();
+
+	m_uTcpSerialRxHead = 0;		// NB. CommTcpThread isn't running
+	m_uTcpSerialRxTail = 0;
+	m_uTcpSerialRxReadyCycle = 0;
+	if (m_syncEventRx.m_active)
+		g_SynchronousEventMgr.Remove(m_syncEventRx.m_id);
+	if (m_syncEventTx.m_active)
+		g_SynchronousEventMgr.Remove(m_syncEventTx.m_id);
 
 	m_uDTR = DTR_CONTROL_DISABLE;
 	m_uRTS = RTS_CONTROL_DISABLE;
@@ -116,6 +134,11 @@ void CSuperSerialCard::InternalReset()
 CSuperSerialCard::~CSuperSerialCard()
 {
 	delete [] m_aySerialPortChoices;
+
+	if (m_syncEventRx.m_active)
+		g_SynchronousEventMgr.Remove(m_syncEventRx.m_id);
+	if (m_syncEventTx.m_active)
+		g_SynchronousEventMgr.Remove(m_syncEventTx.m_id);
 }
 
 //===========================================================================
@@ -240,13 +263,10 @@ bool CSuperSerialCard::CheckComm()
 				return false;
 			}
 
-			// now send async events to our app's message handler
-			if (WSAAsyncSelect(
-					/* SOCKET s */ m_hCommListenSocket,
-					/* HWND hWnd */ GetFrame().g_hFrameWindow,
-					/* unsigned int wMsg */ WM_USER_TCP_SERIAL,
-					/* long lEvent */ (FD_ACCEPT | FD_CONNECT | FD_READ | FD_CLOSE)) != 0)
+			// now accept & receive on a dedicated thread (rather than via the message pump)
+			if (!CommTcpThInit())
 			{
+				closesocket(m_hCommListenSocket);
 				m_hCommListenSocket = INVALID_SOCKET;
 				WSACleanup();
 				return false;
@@ -315,11 +335,13 @@ void CSuperSerialCard::CommTcpSerialCleanup()
 {
 	if (m_hCommListenSocket != INVALID_SOCKET)
 	{
-		WSAAsyncSelect(m_hCommListenSocket, GetFrame().g_hFrameWindow, 0, 0); // Stop event messages
+		CommTcpThUninit();	// Kill CommTcpThread before closing its sockets
+
 		closesocket(m_hCommListenSocket);
 		m_hCommListenSocket = INVALID_SOCKET;
 
 		CommTcpSerialClose();
+		DeleteCriticalSection(&m_TcpCriticalSection);
 
 		WSACleanup();
 	}
@@ -327,8 +349,12 @@ void CSuperSerialCard::CommTcpSerialCleanup()
 
 //===========================================================================
 
+// Called by CommTcpThread when the client disconnects, or by CommTcpSerialCleanup() once CommTcpThread has exited
+// . NB. Any bytes still in the Rx ring can still be read (like bytes already received by a real UART)
 void CSuperSerialCard::CommTcpSerialClose()
 {
+	EnterCriticalSection(&m_TcpCriticalSection);
+
 	if (m_hCommAcceptSocket != INVALID_SOCKET)
 	{
 		shutdown(m_hCommAcceptSocket, 2 /* SD_BOTH */); // In case the client is waiting for data
@@ -336,49 +362,195 @@ void CSuperSerialCard::CommTcpSerialClose()
 		m_hCommAcceptSocket = INVALID_SOCKET;
 	}
 
-	m_qTcpSerialBuffer.clear();
+	LeaveCriticalSection(&m_TcpCriticalSection);
 }
 
 //===========================================================================
 
+// Called by CommTcpThread when the listener socket has a connection
 void CSuperSerialCard::CommTcpSerialAccept()
 {
-	// Valid listener socket and invalid accept socket?
-	if ((m_hCommListenSocket != INVALID_SOCKET) && (m_hCommAcceptSocket == INVALID_SOCKET))
+	SOCKET hSocket = accept(m_hCommListenSocket, NULL, NULL);
+	if (hSocket == INVALID_SOCKET)
+		return;
+
+	u_long nonBlocking = 1;		// So CommTransmit() never stalls the emulation
+	ioctlsocket(hSocket, FIONBIO, &nonBlocking);
+
+	EnterCriticalSection(&m_TcpCriticalSection);
+	m_hCommAcceptSocket = hSocket;
+	LeaveCriticalSection(&m_TcpCriticalSection);
+}
+
+//===========================================================================
+
+// Called by CommTcpThread when the accepted socket has data (or has closed)
+// . recv() goes straight into the Rx ring's free space, so no per-byte copying or locking
+void CSuperSerialCard::CommTcpSerialReceive()
+{
+	const UINT uHead = m_uTcpSerialRxHead.load(std::memory_order_relaxed);
+	const UINT uTail = m_uTcpSerialRxTail.load(std::memory_order_acquire);
+	const UINT uOffset = uHead & (kTcpSerialRxRingSize-1);
+	const UINT uFree = kTcpSerialRxRingSize - (uHead - uTail);
+	const UINT uContiguousFree = (uFree < kTcpSerialRxRingSize - uOffset) ? uFree : kTcpSerialRxRingSize - uOffset;
+
+	const int nReceived = recv(m_hCommAcceptSocket, (char*)&m_aTcpSerialRxRing[uOffset], uContiguousFree, 0);
+	if (nReceived == 0 || (nReceived == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK))
 	{
-		// Y: accept the connection
-		m_hCommAcceptSocket = accept(m_hCommListenSocket, NULL, NULL);
+		CommTcpSerialClose();	// Client has disconnected (or connection is broken)
+		return;
+	}
+	if (nReceived == SOCKET_ERROR)
+		return;
+
+	m_uTcpSerialRxHead.store(uHead + nReceived, std::memory_order_release);
+
+	// Was empty (and the IRQ for the next byte is raised by CommReceive())
+	// . NB. when not turbo, the IRQ is raised by m_syncEventRx once the byte is ready (see SyncEventCallbackRx())
+	if (uHead == uTail && m_bRxIrqEnabled && m_bCfgTcpSerialTurbo)
+	{
+		CpuIrqAssert(IS_SSC);
+		m_vbRxIrqPending = true;
 	}
 }
 
 //===========================================================================
 
-// Called when there's a TCP event via the message pump
-// . Because it's via the message pump, then this call is synchronous to CommReceive(), so there's no need for a critical section
-void CSuperSerialCard::CommTcpSerialReceive()
+DWORD WINAPI CSuperSerialCard::CommTcpThread(LPVOID lpParameter)
 {
-	if (m_hCommAcceptSocket != INVALID_SOCKET)
+	CSuperSerialCard* pSSC = (CSuperSerialCard*) lpParameter;
+
+	while (!pSSC->m_vbCommTcpThreadQuit)
 	{
-		char Data[0x80];
-		int nReceived = 0;
-		while ((nReceived = recv(m_hCommAcceptSocket, Data, sizeof(Data), 0)) > 0)
-		{
-			for (int i = 0; i < nReceived; i++)
-			{
-				m_qTcpSerialBuffer.push_back(Data[i]);
-			}
-		}
+		const SOCKET hAcceptSocket = pSSC->m_hCommAcceptSocket;
+		SOCKET hSocket = INVALID_SOCKET;
 
-		if (m_bRxIrqEnabled && !m_qTcpSerialBuffer.empty())
+		if (hAcceptSocket == INVALID_SOCKET)
+			hSocket = pSSC->m_hCommListenSocket;	// Wait for a connection
+		else if (pSSC->m_uTcpSerialRxHead - pSSC->m_uTcpSerialRxTail < kTcpSerialRxRingSize)
+			hSocket = hAcceptSocket;				// Wait for data (but if the ring is full, then leave it in the socket, so TCP flow-control throttles the client)
+
+		if (hSocket == INVALID_SOCKET)
 		{
-			CpuIrqAssert(IS_SSC);
-			m_vbRxIrqPending = true;
+			Sleep(1);
+			continue;
 		}
+
+		fd_set readSet;
+		FD_ZERO(&readSet);
+		FD_SET(hSocket, &readSet);
+		timeval timeout = { 0, TCP_SERIAL_THREAD_POLL_MS * 1000 };
+
+		if (select(0, &readSet, NULL, NULL, &timeout) <= 0)
+			continue;	// Timeout (or error)
+
+		if (hSocket == hAcceptSocket)
+			pSSC->CommTcpSerialReceive();
+		else
+			pSSC->CommTcpSerialAccept();
+	}
+
+	return 0;
+}
+
+bool CSuperSerialCard::CommTcpThInit()
+{
+	_ASSERT(m_hCommTcpThread == NULL);
+
+	InitializeCriticalSection(&m_TcpCriticalSection);
+	m_vbCommTcpThreadQuit = false;
+
+	DWORD dwThreadId;
+	m_hCommTcpThread = CreateThread(NULL,			// lpThreadAttributes
+									0,				// dwStackSize
+									(LPTHREAD_START_ROUTINE) &CSuperSerialCard::CommTcpThread,
+									this,			// lpParameter
+									0,				// dwCreationFlags : 0 = Run immediately
+									&dwThreadId);	// lpThreadId
+
+	if (m_hCommTcpThread == NULL)
+	{
+		DeleteCriticalSection(&m_TcpCriticalSection);
+		return false;
+	}
+
+	return true;
+}
+
+void CSuperSerialCard::CommTcpThUninit()
+{
+	if (m_hCommTcpThread)
+	{
+		m_vbCommTcpThreadQuit = true;	// Thread will see this within TCP_SERIAL_THREAD_POLL_MS
+		WaitForSingleObject(m_hCommTcpThread, INFINITE);
+
+		CloseHandle(m_hCommTcpThread);
+		m_hCommTcpThread = NULL;
 	}
 }
 
 //===========================================================================
 
+bool CSuperSerialCard::IsTcpSerialRxEmpty(void)
+{
+	return m_uTcpSerialRxHead.load(std::memory_order_acquire) == m_uTcpSerialRxTail.load(std::memory_order_relaxed);
+}
+
+// Is the next received TCP byte available to the 6551 yet?
+// . turbo: as soon as it's in the Rx ring
+// . otherwise: one byte per character-time at the programmed baud rate (as a real serial line would deliver them)
+bool CSuperSerialCard::IsTcpSerialRxReady(ULONG nExecutedCycles)
+{
+	if (IsTcpSerialRxEmpty())
+		return false;
+
+	if (m_bCfgTcpSerialTurbo)
+		return true;
+
+	CpuCalcCycles(nExecutedCycles);
+	return g_nCumulativeCycles >= m_uTcpSerialRxReadyCycle;
+}
+
+// Cycles to transfer one character: start bit + data bits + parity bit + stop bit(s)
+// . NB. Use the 6551's actual rate, not m_uBaudRate (which is rounded to a rate that the host's COM port supports)
+UINT CSuperSerialCard::GetCyclesPerChar(void)
+{
+	static const double kBaudRate[16] =	// Indexed by Control register b3:0
+	{
+		115200.0,	// Internal clk: undoc'd 115.2K (or 16x external clock)
+		50.0, 75.0, 109.92, 134.58, 150.0, 300.0, 600.0,
+		1200.0, 1800.0, 2400.0, 3600.0, 4800.0, 7200.0, 9600.0, 19200.0
+	};
+
+	UINT uHalfBits = 2 * (1 + m_uByteSize + (m_uParity != NOPARITY ? 1 : 0));
+	uHalfBits += (m_uStopBits == ONESTOPBIT) ? 2 : (m_uStopBits == ONE5STOPBITS) ? 3 : 4;
+
+	return (UINT) (uHalfBits * g_fCurrentCLK6502 / (2.0 * kBaudRate[m_uControlByte & 0x0F]));
+}
+
+int CSuperSerialCard::SyncEventCallbackRx(int id, int cycles, ULONG uExecutedCycles)
+{
+	CSuperSerialCard* pSSC = GetCardMgr().GetSSC();
+
+	if (!pSSC->m_bRxIrqEnabled || pSSC->m_hCommListenSocket == INVALID_SOCKET)
+		return 0;	// Don't repeat (restarted when the Rx IRQ is enabled - see UpdateCommandReg())
+
+	if (pSSC->IsTcpSerialRxEmpty())
+		return pSSC->GetCyclesPerChar();	// Poll for the next byte (CommTcpSerialReceive() doesn't raise the IRQ when not turbo)
+
+	CpuIrqAssert(IS_SSC);
+	pSSC->m_vbRxIrqPending = true;
+	return 0;	// Don't repeat (restarted when the byte is read - see CommReceive())
+}
+
+int CSuperSerialCard::SyncEventCallbackTx(int id, int cycles, ULONG uExecutedCycles)
+{
+	GetCardMgr().GetSSC()->TransmitDone();	// Last stop bit has been shifted out
+	return 0;	// Don't repeat
+}
+
+//===========================================================================
+
 BYTE __stdcall CSuperSerialCard::SSC_IORead(WORD PC, WORD uAddr, BYTE bWrite, BYTE uValue, ULONG nExecutedCycles)
 {
 	UINT uSlot = ((uAddr & 0xff) >> 4) - 8;
@@ -536,6 +708,13 @@ void CSuperSerialCard::UpdateCommandReg(BYTE command)
 
 	// Data Terminal Ready (DTR) setting (0=set DTR high (indicates 'not ready')) (GH#386)
 	m_uDTR = (m_uCommandByte & CMD_DTR) ? DTR_CONTROL_ENABLE : DTR_CONTROL_DISABLE;
+
+	// TCP Rx when not turbo: the Rx IRQ is only raised by m_syncEventRx, which polls while the Rx ring is empty
+	if (m_bRxIrqEnabled && !m_bCfgTcpSerialTurbo && m_hCommListenSocket != INVALID_SOCKET && !m_syncEventRx.m_active)
+	{
+		m_syncEventRx.SetCycles(GetCyclesPerChar());
+		g_SynchronousEventMgr.Insert(&m_syncEventRx);
+	}
 }
 
 BYTE __stdcall CSuperSerialCard::CommCommand(WORD, WORD, BYTE write, BYTE value, ULONG)
@@ -631,29 +810,50 @@ BYTE __stdcall CSuperSerialCard::CommControl(WORD, WORD, BYTE write, BYTE value,
 
 //===========================================================================
 
-BYTE __stdcall CSuperSerialCard::CommReceive(WORD, WORD, BYTE, BYTE, ULONG)
+BYTE __stdcall CSuperSerialCard::CommReceive(WORD, WORD uAddr, BYTE, BYTE, ULONG nExecutedCycles)
 {
 	if (!CheckComm())
 		return 0;
 
 	BYTE result = 0;
 
-	if (!m_qTcpSerialBuffer.empty())
+	if (!IsTcpSerialRxEmpty())
 	{
-		// NB. See CommTcpSerialReceive() above, for a note explaining why there's no need for a critical section here
+		// NB. The Rx ring is lock-free (see CommTcpSerialReceive()), so there's no need for a critical section here
 
 		// If receiver is disabled then transmitting device should not send data
 		// . For COM serial connection this is handled by DTR/DTS flow-control (which enables the receiver)
 		if ((m_uCommandByte & CMD_DTR) == 0)	// Receiver disable, so prevent receiving data
 			return 0;
 
-		result = m_qTcpSerialBuffer.front();
-		m_qTcpSerialBuffer.pop_front();
+		if (!IsTcpSerialRxReady(nExecutedCycles))	// Next byte is still "on the line"
+			return 0;
+
+		const UINT uTail = m_uTcpSerialRxTail.load(std::memory_order_relaxed);
+		result = m_aTcpSerialRxRing[uTail & (kTcpSerialRxRingSize-1)];
+		m_uTcpSerialRxTail.store(uTail + 1, std::memory_order_release);
 
-		if (m_bRxIrqEnabled && !m_qTcpSerialBuffer.empty())
+		if (m_bCfgTcpSerialTurbo)
 		{
-			CpuIrqAssert(IS_SSC);
-			m_vbRxIrqPending = true;
+			if (m_bRxIrqEnabled && !IsTcpSerialRxEmpty())
+			{
+				CpuIrqAssert(IS_SSC);
+				m_vbRxIrqPending = true;
+			}
+		}
+		else
+		{
+			// Next byte is available (and its IRQ is raised) one character-time from now
+			const UINT uCyclesPerChar = GetCyclesPerChar();
+			m_uTcpSerialRxReadyCycle = g_nCumulativeCycles + uCyclesPerChar;
+
+			// NB. This adjustment gets subtracted when this current opcode completes (see Mockingboard's SetTimerSyncEvent())
+			const UINT opcodeCycleAdjust = GetOpcodeCyclesForRead(uAddr & 0xf);
+
+			if (m_syncEventRx.m_active)
+				g_SynchronousEventMgr.Remove(m_syncEventRx.m_id);
+			m_syncEventRx.SetCycles(uCyclesPerChar + opcodeCycleAdjust);
+			g_SynchronousEventMgr.Insert(&m_syncEventRx);
 		}
 	}
 	else if (m_hCommHandle != INVALID_HANDLE_VALUE)
@@ -715,7 +915,7 @@ void CSuperSerialCard::TransmitDone(void)
 	}
 }
 
-BYTE __stdcall CSuperSerialCard::CommTransmit(WORD, WORD, BYTE, BYTE value, ULONG)
+BYTE __stdcall CSuperSerialCard::CommTransmit(WORD, WORD uAddr, BYTE, BYTE value, ULONG)
 {
 	if (!CheckComm())
 		return 0;
@@ -731,13 +931,31 @@ BYTE __stdcall CSuperSerialCard::CommTransmit(WORD, WORD, BYTE, BYTE value, ULON
 		{
 			data &= ~(1 << m_uByteSize);
 		}
-		int sent = send(m_hCommAcceptSocket, (const char*)&data, 1, 0);
+		EnterCriticalSection(&m_TcpCriticalSection);	// CommTcpThread may close the socket
+		int sent = (m_hCommAcceptSocket != INVALID_SOCKET) ? send(m_hCommAcceptSocket, (const char*)&data, 1, 0) : 0;
+		LeaveCriticalSection(&m_TcpCriticalSection);
 		_ASSERT(sent == 1);
 		if (sent == 1)
 		{
 			m_vbTxEmpty = false;
-			// Assume that send() completes immediately
-			TransmitDone();
+
+			if (m_bCfgTcpSerialTurbo)
+			{
+				// Assume that send() completes immediately
+				TransmitDone();
+			}
+			else
+			{
+				// Transmit is done one character-time from now
+				// . if the 6502 wrote again before the last byte was done (overrun), then just restart the character-time
+				// . NB. This adjustment gets subtracted when this current opcode completes (see Mockingboard's SetTimerSyncEvent())
+				const UINT opcodeCycleAdjust = GetOpcodeCyclesForWrite(uAddr & 0xf);
+
+				if (m_syncEventTx.m_active)
+					g_SynchronousEventMgr.Remove(m_syncEventTx.m_id);
+				m_syncEventTx.SetCycles(GetCyclesPerChar() + opcodeCycleAdjust);
+				g_SynchronousEventMgr.Insert(&m_syncEventTx);
+			}
 		}
 	}
 	else if (m_hCommHandle != INVALID_HANDLE_VALUE)
@@ -795,7 +1013,7 @@ enum {	ST_IRQ			= 1<<7,
 		ST_PARITY_ERR	= 1<<0,
 };
 
-BYTE __stdcall CSuperSerialCard::CommStatus(WORD, WORD, BYTE, BYTE, ULONG)
+BYTE __stdcall CSuperSerialCard::CommStatus(WORD, WORD, BYTE, BYTE, ULONG nExecutedCycles)
 {
 	if (!CheckComm())
 		return ST_DSR | ST_DCD | ST_TX_EMPTY;
@@ -847,7 +1065,7 @@ BYTE __stdcall CSuperSerialCard::CommStatus(WORD, WORD, BYTE, BYTE, ULONG)
 	//
 
 	BYTE TX_EMPTY = m_vbTxEmpty ? ST_TX_EMPTY : 0;
-	BYTE RX_FULL  = (!bComSerialBufferEmpty || !m_qTcpSerialBuffer.empty()) ? ST_RX_FULL : 0;
+	BYTE RX_FULL  = (!bComSerialBufferEmpty || IsTcpSerialRxReady(nExecutedCycles)) ? ST_RX_FULL : 0;
 
 	//
 
@@ -1496,6 +1714,14 @@ bool CSuperSerialCard::LoadSnapshot(YamlLoadHelper& yamlLoadHelper, UINT slot, U
 	if (m_vbTxIrqPending || m_vbRxIrqPending)	// GH#677
 		CpuIrqAssert(IS_SSC);
 
+	if (!m_vbTxEmpty)	// Transmit was in progress: the host connection isn't restored, so just complete it
+	{
+		if (m_syncEventTx.m_active)
+			g_SynchronousEventMgr.Remove(m_syncEventTx.m_id);
+		m_syncEventTx.SetCycles(GetCyclesPerChar());
+		g_SynchronousEventMgr.Insert(&m_syncEventTx);
+	}
+
 	std::string serialPortName = yamlLoadHelper.LoadString(SS_YAML_KEY_SERIALPORTNAME);
 	SetSerialPortName(serialPortName.c_str());
 
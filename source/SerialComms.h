@@ -1,6 +1,9 @@
 #pragma once
 
+#include <atomic>
+
 #include "Card.h"
+#include "SynchronousEventManager.h"
 
 enum {COMMEVT_WAIT=0, COMMEVT_ACK, COMMEVT_TERM, COMMEVT_MAX};
 enum eFWMODE {FWMODE_CIC=0, FWMODE_SIC_P8, FWMODE_PPC, FWMODE_SIC_P8A};	// NB. CIC = SSC
@@ -45,11 +48,7 @@ public:
 	void	SetSerialPortName(const char* pSerialPortName);
 	bool	IsActive() { return (m_hCommHandle != INVALID_HANDLE_VALUE) || (m_hCommListenSocket != INVALID_SOCKET); }
 	void	SupportDCD(bool bEnable) { m_bCfgSupportDCD = bEnable; }	// Status
-
-	void	CommTcpSerialAccept();
-	void	CommTcpSerialReceive();
-	void	CommTcpSerialClose();
-	void	CommTcpSerialCleanup();
+	void	SetTcpSerialTurbo(bool bEnable) { m_bCfgTcpSerialTurbo = bEnable; }
 
 	static BYTE __stdcall SSC_IORead(WORD PC, WORD uAddr, BYTE bWrite, BYTE uValue, ULONG nExecutedCycles);
 	static BYTE __stdcall SSC_IOWrite(WORD PC, WORD uAddr, BYTE bWrite, BYTE uValue, ULONG nExecutedCycles);
@@ -70,12 +69,25 @@ private:
 	void	GetDIPSW();
 	void	SetDIPSWDefaults();
 	UINT	BaudRateToIndex(UINT uBaudRate);
+	UINT	GetCyclesPerChar(void);
 	void	UpdateCommState();
 	void	TransmitDone(void);
 	bool	CheckComm();
 	void	CloseComm();
 	void	CheckCommEvent(DWORD dwEvtMask);
 	static DWORD WINAPI	CommThread(LPVOID lpParameter);
+
+	void	CommTcpSerialAccept();
+	void	CommTcpSerialReceive();
+	void	CommTcpSerialClose();
+	void	CommTcpSerialCleanup();
+	bool	CommTcpThInit();
+	void	CommTcpThUninit();
+	static DWORD WINAPI	CommTcpThread(LPVOID lpParameter);
+	bool	IsTcpSerialRxEmpty(void);
+	bool	IsTcpSerialRxReady(ULONG nExecutedCycles);
+	static int	SyncEventCallbackRx(int id, int cycles, ULONG uExecutedCycles);
+	static int	SyncEventCallbackTx(int id, int cycles, ULONG uExecutedCycles);
 	bool	CommThInit();
 	void	CommThUninit();
 	UINT	GetNumSerialPortChoices() { return m_vecSerialPortsItems.size(); }
@@ -114,14 +126,27 @@ private:
 
 	HANDLE m_hCommHandle;
 	SOCKET m_hCommListenSocket;
-	SOCKET m_hCommAcceptSocket;
+	volatile SOCKET m_hCommAcceptSocket;	// Accepted & closed by CommTcpThread
 
 	//
 
 	CRITICAL_SECTION	m_CriticalSection;	// To guard /m_vuRxCurrBuffer/ and /m_vbTxEmpty/
 	std::deque<BYTE>	m_qComSerialBuffer[2];
 	volatile UINT		m_vuRxCurrBuffer;	// Written to on COM recv. SSC reads from other one
-	std::deque<BYTE>	m_qTcpSerialBuffer;
+
+	// TCP Rx: CommTcpThread writes to the ring & CommReceive() reads from it (single producer, single consumer, so lock-free)
+	static const UINT	kTcpSerialRxRingSize = 0x10000;	// Must be a power of 2
+	BYTE				m_aTcpSerialRxRing[kTcpSerialRxRingSize];
+	std::atomic<UINT>	m_uTcpSerialRxHead;	// Only written by CommTcpThread
+	std::atomic<UINT>	m_uTcpSerialRxTail;	// Only written by emulation thread
+	CRITICAL_SECTION	m_TcpCriticalSection;	// To guard m_hCommAcceptSocket's send() w.r.t. CommTcpThread closing it
+	HANDLE				m_hCommTcpThread;
+	volatile bool		m_vbCommTcpThreadQuit;
+
+	bool				m_bCfgTcpSerialTurbo;		// Rx & Tx bytes complete as fast as the 6502 reads/writes them, ignoring the baud rate
+	unsigned __int64	m_uTcpSerialRxReadyCycle;	// Otherwise: the next Rx byte is available at this cycle
+	SyncEvent			m_syncEventRx;				// Rx IRQ for the next byte (when not turbo)
+	SyncEvent			m_syncEventTx;				// TransmitDone() one character-time after CommTransmit() (when not turbo)
 
 	//
 
@@ -0,0 +1,218 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2020, Tom Charlesworth, Michael Pohoreski, Nick Westgate
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Uthernet host network backends: Linux TAP & in-process loopback
+ *
+ * (The pcap backend lives in tfearch.cpp, next to the dynamically loaded WinPcap/Npcap entry points.)
+ *
+ * Author: Various
+ *
+ */
+
+#include <StdAfx.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <linux/if_tun.h>
+#endif
+
+#include "NetworkBackend.h"
+#include "../Log.h"
+
+//===========================================================================
+
+#ifdef __linux__
+
+class TapBackend : public NetworkBackend
+{
+public:
+	TapBackend(void) : m_fd(-1) {}
+	virtual ~TapBackend(void) { Close(); }
+
+	virtual bool Open(const std::string& interfaceName)
+	{
+		const std::string name = interfaceName.substr(strlen(NETWORK_INTERFACE_TAP_PREFIX));
+
+		m_fd = open("/dev/net/tun", O_RDWR);
+		if (m_fd < 0)
+		{
+			LogFileOutput("TAP: failed to open /dev/net/tun\n");
+			return false;
+		}
+
+		struct ifreq ifr;
+		memset(&ifr, 0, sizeof(ifr));
+		ifr.ifr_flags = IFF_TAP | IFF_NO_PI;	// raw ethernet frames, no packet info header
+		strncpy(ifr.ifr_name, name.c_str(), IFNAMSIZ - 1);
+
+		if (ioctl(m_fd, TUNSETIFF, &ifr) < 0)
+		{
+			LogFileOutput("TAP: failed to attach to '%s'\n", name.c_str());
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	virtual void Close(void)
+	{
+		if (m_fd >= 0)
+		{
+			close(m_fd);
+			m_fd = -1;
+		}
+	}
+
+	virtual bool Transmit(const BYTE* pFrame, UINT uLength)
+	{
+		return write(m_fd, pFrame, uLength) == (ssize_t)uLength;
+	}
+
+	virtual int Receive(BYTE* pBuffer, UINT uMaxLength)
+	{
+		struct pollfd pfd = { m_fd, POLLIN, 0 };
+		const int res = poll(&pfd, 1, NETWORK_RECEIVE_TIMEOUT_MS);
+		if (res <= 0)
+			return res;	// nothing (or error)
+
+		const ssize_t len = read(m_fd, pBuffer, uMaxLength);
+		return len < 0 ? -1 : (int)len;
+	}
+
+private:
+	int m_fd;
+};
+
+NetworkBackend* NetworkBackendCreateTap(void)
+{
+	return new TapBackend;
+}
+
+#else
+
+NetworkBackend* NetworkBackendCreateTap(void)
+{
+	return NULL;
+}
+
+#endif
+
+//===========================================================================
+
+// In-process loopback: frames transmitted by the card are received back by the card (like a loopback plug)
+// . lets guest network stacks be exercised & throughput-tested without privileges or a real network
+
+namespace
+{
+	const UINT kLoopbackQueueSize = 256;	// in frames (further frames are dropped, like a full NIC buffer)
+
+	typedef std::vector<BYTE> Frame;
+
+	class LoopbackQueue
+	{
+	public:
+		bool Push(const BYTE* pFrame, UINT uLength)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_frames.size() >= kLoopbackQueueSize)
+					return false;
+				m_frames.push_back(Frame(pFrame, pFrame + uLength));
+			}
+			m_cond.notify_one();
+			return true;
+		}
+
+		int Pop(BYTE* pBuffer, UINT uMaxLength, UINT uTimeoutMS)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (!m_cond.wait_for(lock, std::chrono::milliseconds(uTimeoutMS), [this] { return !m_frames.empty(); }))
+				return 0;
+
+			const Frame& frame = m_frames.front();
+			const UINT uLength = (UINT)frame.size() < uMaxLength ? (UINT)frame.size() : uMaxLength;
+			if (uLength)
+				memcpy(pBuffer, &frame[0], uLength);
+			m_frames.pop_front();
+			return (int)uLength;
+		}
+
+		void Clear(void)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_frames.clear();
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_cond;
+		std::deque<Frame> m_frames;
+	};
+}
+
+class LoopbackBackend : public NetworkBackend
+{
+public:
+	virtual ~LoopbackBackend(void) { Close(); }
+
+	virtual bool Open(const std::string& interfaceName)
+	{
+		m_frames.Clear();
+		return true;
+	}
+
+	virtual void Close(void)
+	{
+		m_frames.Clear();
+	}
+
+	virtual bool Transmit(const BYTE* pFrame, UINT uLength)
+	{
+		return m_frames.Push(pFrame, uLength);
+	}
+
+	virtual int Receive(BYTE* pBuffer, UINT uMaxLength)
+	{
+		return m_frames.Pop(pBuffer, uMaxLength, NETWORK_RECEIVE_TIMEOUT_MS);
+	}
+
+private:
+	LoopbackQueue m_frames;
+};
+
+NetworkBackend* NetworkBackendCreateLoopback(void)
+{
+	return new LoopbackBackend;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+
+// Host side of the Uthernet (CS8900A) emulation, see tfearch.cpp
+// . tfe_arch_activate() picks the backend from the configured interface name:
+//   "tap:<name>" : Linux TAP device, eg. "tap:tap0" (create it beforehand with "ip tuntap add tap0 mode tap user <user>" to avoid needing root)
+//   "loopback"   : in-process loopback, the card receives the frames it transmits
+//   otherwise    : pcap adapter name (WinPcap/Npcap or libpcap)
+
+#define NETWORK_INTERFACE_TAP_PREFIX	"tap:"
+#define NETWORK_INTERFACE_LOOPBACK		"loopback"
+
+class NetworkBackend
+{
+public:
+	virtual ~NetworkBackend(void) {}
+
+	virtual bool Open(const std::string& interfaceName) = 0;
+	virtual void Close(void) = 0;
+
+	// Send a frame to the host network
+	virtual bool Transmit(const BYTE* pFrame, UINT uLength) = 0;
+
+	// Wait (for up to NETWORK_RECEIVE_TIMEOUT_MS) for a frame from the host network
+	// . copies at most uMaxLength bytes to pBuffer
+	// . returns the number of bytes copied, or 0 if no frame arrived, or -1 if the backend has failed
+	// NB. Only called from the receive thread
+	virtual int Receive(BYTE* pBuffer, UINT uMaxLength) = 0;
+};
+
+#define NETWORK_RECEIVE_TIMEOUT_MS 20
+
+NetworkBackend* NetworkBackendCreateTap(void);		// NULL if TAP isn't supported on this host
+NetworkBackend* NetworkBackendCreateLoopback(void);
@@ -34,10 +34,14 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+#include <thread>
+
 #include <StdAfx.h> // this is necessary in linux, but in MSVC windows.h MUST come after winsock2.h (from pcap.h above)
 #include "tfe.h"
 #include "tfearch.h"
 #include "tfesupp.h"
+#include "NetworkBackend.h"
 #include "../Log.h"
 
 
@@ -178,6 +182,38 @@ static pcap_t *TfePcapFP = NULL;
 
 static char TfePcapErrbuf[PCAP_ERRBUF_SIZE];
 
+/* AppleWin: the host network is accessed through a NetworkBackend (pcap, TAP
+ * or loopback, see NetworkBackend.h), chosen by the interface name.
+ *
+ * Received frames are read from the backend by a separate thread, which
+ * passes the frames that pass the receive filter to the emulation thread
+ * through a single-producer/single-consumer queue. So tfe_arch_receive(),
+ * which is called whenever the guest polls RxEvent, is just a queue peek.
+ */
+
+static NetworkBackend *TfeBackend = NULL;
+
+#define TFE_RX_QUEUE_SIZE 64   /* in frames, must be a power of 2 */
+#define TFE_RX_FRAME_SIZE 1700 /* same as the snaplen passed to pcap_open_live() */
+
+typedef struct TFE_RX_FRAME_tag {
+
+    int  len;
+    int  hashed;
+    int  hash_index;
+    int  correct_mac;
+    int  broadcast;
+    BYTE buffer[TFE_RX_FRAME_SIZE];
+
+} TFE_RX_FRAME;
+
+static TFE_RX_FRAME TfeRxQueue[TFE_RX_QUEUE_SIZE];
+static std::atomic<unsigned int> TfeRxHead(0);  /* only written by the receive thread */
+static std::atomic<unsigned int> TfeRxTail(0);  /* only written by the emulation thread */
+static std::atomic<bool> TfeRxThreadQuit(false);
+static std::thread TfeRxThread;
+static unsigned int TfeRxDropped = 0;           /* frames dropped because the queue was full */
+
 #ifdef TFE_DEBUG_PKTDUMP
 
 static
@@ -323,9 +359,10 @@ BOOL TfePcapOpenAdapter(const std::string & interface_name)
         return FALSE;
     }
 
-    if ((*p_pcap_setnonblock)(TfePcapFP, 1, TfePcapErrbuf)<0)
+    /* the receive thread waits in pcap_dispatch() for up to the read timeout (20ms) */
+    if ((*p_pcap_setnonblock)(TfePcapFP, 0, TfePcapErrbuf)<0)
     {
-        if(g_fh) fprintf(g_fh, "WARNING: Setting PCAP to non-blocking failed: '%s'\n", TfePcapErrbuf);
+        if(g_fh) fprintf(g_fh, "WARNING: Setting PCAP to blocking failed: '%s'\n", TfePcapErrbuf);
     }
 
 	/* Check the link layer. We support only Ethernet for simplicity. */
@@ -343,6 +380,149 @@ BOOL TfePcapOpenAdapter(const std::string & interface_name)
 }
 
 
+typedef struct TFE_PCAP_INTERNAL_tag {
+
+    unsigned int len;
+    BYTE *buffer;
+
+} TFE_PCAP_INTERNAL;
+
+/* Callback function invoked by libpcap for every incoming packet */
+static
+void TfePcapPacketHandler(u_char *param, const struct pcap_pkthdr *header, const u_char *pkt_data)
+{
+	/* RGJ changed from void to TFE_PCAP_INTERNAL for AppleWin */
+	TFE_PCAP_INTERNAL *pinternal = (TFE_PCAP_INTERNAL *)param;
+
+    /* determine the count of bytes which has been returned, 
+     * but make sure not to overrun the buffer 
+     */
+    if (header->caplen < pinternal->len)
+        pinternal->len = header->caplen;
+
+    memcpy(pinternal->buffer, pkt_data, pinternal->len);
+}
+
+/* AppleWin: WinPcap/Npcap or libpcap */
+class PcapBackend : public NetworkBackend
+{
+public:
+    virtual ~PcapBackend(void) { Close(); }
+
+    virtual bool Open(const std::string & interface_name)
+    {
+        return TfePcapOpenAdapter(interface_name) ? true : false;
+    }
+
+    virtual void Close(void)
+    {
+        if (TfePcapFP) {
+            (*p_pcap_close)(TfePcapFP);
+            TfePcapFP = NULL;
+        }
+    }
+
+    virtual bool Transmit(const BYTE *pFrame, UINT uLength)
+    {
+        return (*p_pcap_sendpacket)(TfePcapFP, (u_char *)pFrame, uLength) != -1;
+    }
+
+    virtual int Receive(BYTE *pBuffer, UINT uMaxLength)
+    {
+        TFE_PCAP_INTERNAL internal = { uMaxLength, pBuffer };
+
+        /* blocks until a frame arrives or the read timeout expires */
+        /* RGJ changed from void to u_char for AppleWin */
+        const int ret = (*p_pcap_dispatch)(TfePcapFP, 1, TfePcapPacketHandler, (u_char *)&internal);
+        if (ret <= 0)
+            return ret;
+
+        return internal.len;
+    }
+};
+
+static
+NetworkBackend *TfeBackendCreate(const std::string & interface_name)
+{
+    if (interface_name == NETWORK_INTERFACE_LOOPBACK)
+        return NetworkBackendCreateLoopback();
+
+    if (interface_name.compare(0, strlen(NETWORK_INTERFACE_TAP_PREFIX), NETWORK_INTERFACE_TAP_PREFIX) == 0)
+        return NetworkBackendCreateTap();
+
+    return new PcapBackend;
+}
+
+/* the receive thread */
+static
+void TfeRxThreadProc(NetworkBackend *backend)
+{
+    static BYTE discard[TFE_RX_FRAME_SIZE];
+
+    while (!TfeRxThreadQuit.load(std::memory_order_relaxed)) {
+        const unsigned int head = TfeRxHead.load(std::memory_order_relaxed);
+        const bool full = (head - TfeRxTail.load(std::memory_order_acquire) == TFE_RX_QUEUE_SIZE);
+        TFE_RX_FRAME *frame = &TfeRxQueue[head & (TFE_RX_QUEUE_SIZE-1)];
+        int len;
+        int multicast;
+
+        len = backend->Receive(full ? discard : frame->buffer, TFE_RX_FRAME_SIZE);
+        if (len < 0) {
+            if(g_fh) fprintf(g_fh, "WARNING: receiving from the network failed, TFE receive thread stopped.\n");
+            break;
+        }
+
+        if (len == 0)
+            continue;
+
+        if (full) {
+            /* queue full: drop the frame, as the CS8900A would on a receive overrun */
+            TfeRxDropped++;
+            continue;
+        }
+
+        if (len > TFE_RX_FRAME_SIZE)
+            len = TFE_RX_FRAME_SIZE;
+
+        /* Apply the receive filter here, so the emulation thread never sees frames
+         * that would be rejected. (The filter settings are written by the emulation
+         * thread; a frame racing with a change is filtered with either setting.)
+         * A multicast frame comes back with hashed/correct_mac/broadcast all clear,
+         * so tfe_receive() calls tfe_should_accept() again to get the multicast bit.
+         */
+        if (len < 6 || !tfe_should_accept(frame->buffer, len, &frame->hashed, &frame->hash_index,
+                                          &frame->correct_mac, &frame->broadcast, &multicast))
+            continue;
+
+        frame->len = len;
+
+        TfeRxHead.store(head + 1, std::memory_order_release);
+    }
+}
+
+static
+void TfeRxThreadStart(void)
+{
+    TfeRxHead.store(0);
+    TfeRxTail.store(0);
+    TfeRxDropped = 0;
+    TfeRxThreadQuit.store(false);
+    TfeRxThread = std::thread(TfeRxThreadProc, TfeBackend);
+}
+
+static
+void TfeRxThreadStop(void)
+{
+    if (TfeRxThread.joinable()) {
+        TfeRxThreadQuit.store(true);
+        TfeRxThread.join();
+#ifdef TFE_DEBUG_ARCH
+        if(g_fh) fprintf( g_fh, "TFE receive thread stopped, %u frames dropped.\n", TfeRxDropped );
+#endif
+    }
+}
+
+
 /* ------------------------------------------------------------------------- */
 /*    the architecture-dependend functions                                   */
 
@@ -351,9 +531,8 @@ int tfe_arch_init(void)
 {
  //   g_fh = log_open("TFEARCH");
 
-    if (!TfePcapLoadLibrary()) {
-        return 0;
-    }
+    /* AppleWin: WinPcap/Npcap is only loaded when the pcap backend is opened (see TfePcapOpenAdapter()),
+       so the TAP & loopback backends don't need it */
 
     return 1;
 }
@@ -377,9 +556,17 @@ int tfe_arch_activate(const std::string & interface_name)
 #ifdef TFE_DEBUG_ARCH
     if(g_fh) fprintf( g_fh, "tfe_arch_activate().\n" );
 #endif
-    if (!TfePcapOpenAdapter(interface_name)) {
+    TfeBackend = TfeBackendCreate(interface_name);
+    if (!TfeBackend) {
+        if(g_fh) fprintf(g_fh, "ERROR: network interface '%s' isn't supported on this host.\n", interface_name.c_str());
+        return 0;
+    }
+    if (!TfeBackend->Open(interface_name)) {
+        delete TfeBackend;
+        TfeBackend = NULL;
         return 0;
     }
+    TfeRxThreadStart();
     return 1;
 }
 
@@ -388,9 +575,10 @@ void tfe_arch_deactivate( void )
 #ifdef TFE_DEBUG_ARCH
     if(g_fh) fprintf( g_fh, "tfe_arch_deactivate().\n" );
 #endif
-    if (TfePcapFP) {
-        (*p_pcap_close)(TfePcapFP);
-        TfePcapFP = NULL;
+    if (TfeBackend) {
+        TfeRxThreadStop();
+        delete TfeBackend;  /* closes it */
+        TfeBackend = NULL;
     }
 }
 
@@ -455,58 +643,6 @@ void tfe_arch_line_ctl(int bEnableTransmitter, int bEnableReceiver )
 }
 
 
-typedef struct TFE_PCAP_INTERNAL_tag {
-
-    unsigned int len;
-    BYTE *buffer;
-
-} TFE_PCAP_INTERNAL;
-
-/* Callback function invoked by libpcap for every incoming packet */
-static
-void TfePcapPacketHandler(u_char *param, const struct pcap_pkthdr *header, const u_char *pkt_data)
-{
-	/* RGJ changed from void to TFE_PCAP_INTERNAL for AppleWin */
-	TFE_PCAP_INTERNAL *pinternal = (TFE_PCAP_INTERNAL *)param;
-
-    /* determine the count of bytes which has been returned, 
-     * but make sure not to overrun the buffer 
-     */
-    if (header->caplen < pinternal->len)
-        pinternal->len = header->caplen;
-
-    memcpy(pinternal->buffer, pkt_data, pinternal->len);
-}
-
-/* the following function receives a frame.
-
-   If there's none, it returns a -1.
-   If there is one, it returns the length of the frame in bytes.
-
-   It copies the frame to *buffer and returns the number of copied 
-   bytes as return value.
-
-   At most 'len' bytes are copied.
-*/
-static 
-int tfe_arch_receive_frame(TFE_PCAP_INTERNAL *pinternal)
-{
-    int ret = -1;
-
-    /* check if there is something to receive */
-	/* RGJ changed from void to u_char for AppleWin */
-	if ((*p_pcap_dispatch)(TfePcapFP, 1, TfePcapPacketHandler, (u_char *)pinternal)!=0) {
-        /* Something has been received */
-        ret = pinternal->len;
-    }
-
-#ifdef TFE_DEBUG_ARCH
-    if(g_fh) fprintf( g_fh, "tfe_arch_receive_frame() called, returns %d.\n", ret );
-#endif
-
-    return ret;
-}
-
 void tfe_arch_transmit(int force,       /* FORCE: Delete waiting frames in transmit buffer */
                        int onecoll,     /* ONECOLL: Terminate after just one collision */
                        int inhibit_crc, /* INHIBITCRC: Do not append CRC to the transmission */
@@ -530,7 +666,7 @@ void tfe_arch_transmit(int force,       /* FORCE: Delete waiting frames in trans
     debug_output( "Transmit frame: ", txframe, txlength);
 #endif // #ifdef TFE_DEBUG_PKTDUMP
 
-    if ((*p_pcap_sendpacket)(TfePcapFP, txframe, txlength) == -1) {
+    if (!TfeBackend || !TfeBackend->Transmit(txframe, txlength)) {
         if(g_fh) fprintf(g_fh, "WARNING! Could not send packet!\n");
     }
 }
@@ -573,47 +709,47 @@ int tfe_arch_receive(BYTE *pbuffer  ,    /* where to store a frame */
                      int  *pcrc_error    /* set if received frame had a CRC error */
                     )
 {
+    const unsigned int tail = TfeRxTail.load(std::memory_order_relaxed);
+    const TFE_RX_FRAME *frame;
     int len;
 
-    TFE_PCAP_INTERNAL internal = { static_cast<unsigned int>(*plen), pbuffer };
-
-
 #ifdef TFE_DEBUG_ARCH
     if(g_fh) fprintf( g_fh, "tfe_arch_receive() called, with *plen=%u.\n", *plen );
 #endif
 
     assert((*plen&1)==0);
 
-    len = tfe_arch_receive_frame(&internal);
+    if (tail == TfeRxHead.load(std::memory_order_acquire))
+        return 0;
+
+    frame = &TfeRxQueue[tail & (TFE_RX_QUEUE_SIZE-1)];
 
-    if (len!=-1) {
+    /* make sure not to overrun the buffer */
+    len = frame->len < *plen ? frame->len : *plen;
+    memcpy(pbuffer, frame->buffer, len);
 
 #ifdef TFE_DEBUG_PKTDUMP
-        debug_output( "Received frame: ", internal.buffer, internal.len );
+    debug_output( "Received frame: ", pbuffer, len );
 #endif // #ifdef TFE_DEBUG_PKTDUMP
 
-        if (len&1)
-            ++len;
+    if (len&1)
+        ++len;
 
-        *plen = len;
+    *plen = len;
 
-        /* we don't decide if this frame fits the needs;
-         * by setting all zero, we let tfe.c do the work
-         * for us
-         */
-        *phashed =
-        *phash_index =
-        *pbroadcast = 
-        *pcorrect_mac =
-        *pcrc_error = 0;
+    /* the receive thread has already checked the frame against the filter */
+    *phashed      = frame->hashed;
+    *phash_index  = frame->hash_index;
+    *pcorrect_mac = frame->correct_mac;
+    *pbroadcast   = frame->broadcast;
+    *pcrc_error   = 0;
 
-        /* this frame has been received correctly */
-        *prx_ok = 1;
+    /* this frame has been received correctly */
+    *prx_ok = 1;
 
-        return 1;
-    }
+    TfeRxTail.store(tail + 1, std::memory_order_release);
 
-    return 0;
+    return 1;
 }
 
 //#endif /* #ifdef HAVE_TFE */
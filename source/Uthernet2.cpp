@@ -0,0 +1,853 @@
+/*
+AppleWin : An Apple //e emulator for Windows
+
+Copyright (C) 1994-1996, Michael O'Brien
+Copyright (C) 1999-2001, Oliver Schmidt
+Copyright (C) 2002-2005, Tom Charlesworth
+Copyright (C) 2006-2020, Tom Charlesworth, Michael Pohoreski, Nick Westgate
+
+AppleWin is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+AppleWin is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AppleWin; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/* Description: Uthernet II card (WIZnet W5100)
+ *
+ * The W5100's 32K address space (registers, TX & RX memory) is accessed via the indirect bus I/F at $C0n4-$C0n7.
+ * TCP & UDP sockets are mapped onto non-blocking host sockets:
+ * . socket commands (Sn_CR) are carried out immediately, so Sn_CR always reads back as 0
+ * . the host sockets are polled when the guest polls Sn_SR, Sn_IR, Sn_RX_RSR, Sn_TX_FSR or IR
+ * . the source IP/MAC, gateway & subnet registers are kept for the guest to read back, but the host's settings are used
+ * . IPRAW, MACRAW & PPPoE aren't supported: OPEN leaves the socket closed
+ * . the card's INT line isn't connected (as per the real card's default jumper setting), so IR/Sn_IR must be polled
+ *
+ * Author: Various
+ *
+ */
+
+#include "StdAfx.h"
+
+#include "Uthernet2.h"
+#include "Log.h"
+#include "Memory.h"
+#include "YamlHelper.h"
+
+// I/O registers ($C0n0 + ...)
+#define U2_C0X_MODE_REGISTER	0x04
+#define U2_C0X_ADDRESS_HIGH		0x05
+#define U2_C0X_ADDRESS_LOW		0x06
+#define U2_C0X_DATA_PORT		0x07
+
+//===========================================================================
+
+Uthernet2::Uthernet2(UINT slot) :
+	Card(CT_Uthernet2),
+	m_uSlot(slot)
+{
+	for (UINT n = 0; n < W5100_NUM_SOCKETS; n++)
+		m_socket[n].hSocket = INVALID_SOCKET;
+
+	WSADATA wsaData;
+	m_bWinsockStarted = WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+	if (!m_bWinsockStarted)
+		LogFileOutput("Uthernet II: WSAStartup() failed\n");
+
+	SoftReset();
+}
+
+Uthernet2::~Uthernet2(void)
+{
+	for (UINT n = 0; n < W5100_NUM_SOCKETS; n++)
+		CloseHostSocket(n);
+
+	if (m_bWinsockStarted)
+		WSACleanup();
+}
+
+void Uthernet2::Reset(const bool powerCycle)
+{
+	// Only a power-cycle resets the W5100 (drivers do a S/W reset via MR anyway)
+	if (powerCycle)
+		SoftReset();
+}
+
+void Uthernet2::InitializeIO(LPBYTE pCxRomPeripheral)
+{
+	RegisterIoHandler(m_uSlot, &Uthernet2::IORead, &Uthernet2::IOWrite, NULL, NULL, this, NULL);
+}
+
+void Uthernet2::SoftReset(void)
+{
+	for (UINT n = 0; n < W5100_NUM_SOCKETS; n++)
+	{
+		CloseHostSocket(n);
+		m_socket[n].rxWritePtr = 0;
+		m_socket[n].bSendPending = false;
+	}
+
+	memset(m_memory, 0, sizeof(m_memory));
+	m_dataAddress = 0;
+
+	// Non-zero reset values
+	Write16(W5100_RTR0, 0x07D0);	// 200ms
+	m_memory[W5100_RCR] = 0x08;
+	m_memory[W5100_RMSR] = 0x55;	// 2K per socket
+	m_memory[W5100_TMSR] = 0x55;
+
+	for (UINT n = 0; n < W5100_NUM_SOCKETS; n++)
+	{
+		memset(&m_memory[SocketReg(n, W5100_Sn_DHAR0)], 0xFF, 6);
+		m_memory[SocketReg(n, W5100_Sn_TTL)] = 0x80;
+	}
+
+	ResizeBuffers();
+}
+
+// Share out the 8K TX & RX memory as per TMSR & RMSR (2 bits per socket: 1K, 2K, 4K or 8K)
+// . memory is allocated to the sockets in order, and a socket that doesn't fit gets none
+void Uthernet2::ResizeBuffers(void)
+{
+	WORD txBase = W5100_TX_BASE;
+	WORD rxBase = W5100_RX_BASE;
+
+	for (UINT n = 0; n < W5100_NUM_SOCKETS; n++)
+	{
+		Socket& socket = m_socket[n];
+
+		const WORD txSize = 0x0400 << ((m_memory[W5100_TMSR] >> (n * 2)) & 3);
+		socket.txBase = txBase;
+		socket.txSize = (txBase + txSize <= W5100_TX_BASE + W5100_BUFFER_SIZE) ? txSize : 0;
+		txBase += socket.txSize;
+
+		const WORD rxSize = 0x0400 << ((m_memory[W5100_RMSR] >> (n * 2)) & 3);
+		socket.rxBase = rxBase;
+		socket.rxSize = (rxBase + rxSize <= W5100_RX_BASE + W5100_BUFFER_SIZE) ? rxSize : 0;
+		rxBase += socket.rxSize;
+
+		UpdateSizes(n);
+	}
+}
+
+//===========================================================================
+
+BYTE __stdcall Uthernet2::IORead(WORD PC, WORD uAddr, BYTE bWrite, BYTE uValue, ULONG nExecutedCycles)
+{
+	UINT uSlot = ((uAddr & 0xff) >> 4) - 8;
+	Uthernet2* pCard = (Uthernet2*) MemGetSlotParameters(uSlot);
+
+	switch (uAddr & 0x0f)
+	{
+	case U2_C0X_MODE_REGISTER:
+		return pCard->m_memory[W5100_MR];
+	case U2_C0X_ADDRESS_HIGH:
+		return pCard->m_dataAddress >> 8;
+	case U2_C0X_ADDRESS_LOW:
+		return pCard->m_dataAddress & 0xff;
+	case U2_C0X_DATA_PORT:
+		{
+			const BYTE value = pCard->ReadValue(pCard->m_dataAddress);
+			pCard->AutoIncrement();
+			return value;
+		}
+	}
+
+	return IO_Null(PC, uAddr, bWrite, uValue, nExecutedCycles);
+}
+
+BYTE __stdcall Uthernet2::IOWrite(WORD PC, WORD uAddr, BYTE bWrite, BYTE uValue, ULONG nExecutedCycles)
+{
+	UINT uSlot = ((uAddr & 0xff) >> 4) - 8;
+	Uthernet2* pCard = (Uthernet2*) MemGetSlotParameters(uSlot);
+
+	switch (uAddr & 0x0f)
+	{
+	case U2_C0X_MODE_REGISTER:
+		pCard->WriteValue(W5100_MR, uValue);
+		break;
+	case U2_C0X_ADDRESS_HIGH:
+		pCard->m_dataAddress = (uValue << 8) | (pCard->m_dataAddress & 0x00ff);
+		break;
+	case U2_C0X_ADDRESS_LOW:
+		pCard->m_dataAddress = (pCard->m_dataAddress & 0xff00) | uValue;
+		break;
+	case U2_C0X_DATA_PORT:
+		pCard->WriteValue(pCard->m_dataAddress, uValue);
+		pCard->AutoIncrement();
+		break;
+	default:
+		return IO_Null(PC, uAddr, bWrite, uValue, nExecutedCycles);
+	}
+
+	return 0;
+}
+
+// In auto-increment mode, the address wraps within the TX memory and within the RX memory (Uthernet II manual)
+// . so a socket's ring buffer can be read/written in one pass when the socket is at the top of the memory
+void Uthernet2::AutoIncrement(void)
+{
+	if (!(m_memory[W5100_MR] & W5100_MR_AI))
+		return;
+
+	m_dataAddress++;
+	if (m_dataAddress == W5100_RX_BASE || m_dataAddress == W5100_MEM_SIZE)
+		m_dataAddress -= W5100_BUFFER_SIZE;
+}
+
+//===========================================================================
+
+BYTE Uthernet2::ReadValue(WORD addr)
+{
+	if (addr >= W5100_MEM_SIZE)
+		return 0;
+
+	if (addr >= W5100_S0_BASE && addr < W5100_S0_BASE + W5100_NUM_SOCKETS * W5100_SOCKET_REG_SIZE)
+	{
+		const UINT n = (addr - W5100_S0_BASE) / W5100_SOCKET_REG_SIZE;
+
+		switch (addr & (W5100_SOCKET_REG_SIZE - 1))
+		{
+		case W5100_Sn_IR:
+		case W5100_Sn_SR:
+		case W5100_Sn_TX_FSR0:
+		case W5100_Sn_RX_RSR0:
+			ProcessSocket(n);
+			UpdateSizes(n);
+			break;
+		}
+	}
+	else if (addr == W5100_IR)
+	{
+		for (UINT n = 0; n < W5100_NUM_SOCKETS; n++)
+			ProcessSocket(n);
+	}
+
+	return m_memory[addr];
+}
+
+void Uthernet2::WriteValue(WORD addr, BYTE value)
+{
+	if (addr >= W5100_MEM_SIZE)
+		return;
+
+	if (addr >= W5100_TX_BASE)
+	{
+		m_memory[addr] = value;
+		return;
+	}
+
+	if (addr >= W5100_S0_BASE && addr < W5100_S0_BASE + W5100_NUM_SOCKETS * W5100_SOCKET_REG_SIZE)
+	{
+		const UINT n = (addr - W5100_S0_BASE) / W5100_SOCKET_REG_SIZE;
+
+		switch (addr & (W5100_SOCKET_REG_SIZE - 1))
+		{
+		case W5100_Sn_CR:
+			ExecuteCommand(n, value);	// NB. not stored, so reads as 0 (ie. command done)
+			break;
+		case W5100_Sn_IR:
+			m_memory[addr] &= ~value;	// write 1 to clear
+			UpdateInterruptRegister();
+			break;
+		case W5100_Sn_SR:
+		case W5100_Sn_TX_FSR0:
+		case W5100_Sn_TX_FSR0 + 1:
+		case W5100_Sn_TX_RD0:
+		case W5100_Sn_TX_RD0 + 1:
+		case W5100_Sn_RX_RSR0:
+		case W5100_Sn_RX_RSR0 + 1:
+			break;	// read-only
+		default:
+			m_memory[addr] = value;
+			break;
+		}
+		return;
+	}
+
+	switch (addr)
+	{
+	case W5100_MR:
+		if (value & W5100_MR_RST)
+			SoftReset();
+		else
+			m_memory[W5100_MR] = value;
+		break;
+	case W5100_IR:
+		m_memory[W5100_IR] &= ~(value & (W5100_IR_CONFLICT | W5100_IR_UNREACH | W5100_IR_PPPOE));	// write 1 to clear
+		break;
+	case W5100_RMSR:
+	case W5100_TMSR:
+		m_memory[addr] = value;
+		ResizeBuffers();
+		break;
+	default:
+		m_memory[addr] = value;
+		break;
+	}
+}
+
+//===========================================================================
+
+void Uthernet2::SetStatus(UINT n, BYTE status)
+{
+	m_memory[SocketReg(n, W5100_Sn_SR)] = status;
+}
+
+void Uthernet2::SetInterrupt(UINT n, BYTE flags)
+{
+	m_memory[SocketReg(n, W5100_Sn_IR)] |= flags;
+	UpdateInterruptRegister();
+}
+
+void Uthernet2::UpdateInterruptRegister(void)
+{
+	BYTE ir = m_memory[W5100_IR] & ~W5100_IR_SOCKETS;
+
+	for (UINT n = 0; n < W5100_NUM_SOCKETS; n++)
+	{
+		if (m_memory[SocketReg(n, W5100_Sn_IR)])
+			ir |= 1 << n;
+	}
+
+	m_memory[W5100_IR] = ir;
+}
+
+void Uthernet2::UpdateSizes(UINT n)
+{
+	const Socket& socket = m_socket[n];
+
+	const WORD txUsed = Read16(SocketReg(n, W5100_Sn_TX_WR0)) - Read16(SocketReg(n, W5100_Sn_TX_RD0));
+	Write16(SocketReg(n, W5100_Sn_TX_FSR0), txUsed <= socket.txSize ? socket.txSize - txUsed : 0);
+
+	const WORD rxUsed = socket.rxWritePtr - Read16(SocketReg(n, W5100_Sn_RX_RD0));
+	Write16(SocketReg(n, W5100_Sn_RX_RSR0), rxUsed <= socket.rxSize ? rxUsed : socket.rxSize);
+}
+
+//===========================================================================
+
+void Uthernet2::ExecuteCommand(UINT n, BYTE command)
+{
+	const BYTE status = m_memory[SocketReg(n, W5100_Sn_SR)];
+
+	switch (command)
+	{
+	case W5100_Sn_CR_OPEN:
+		OpenSocket(n);
+		break;
+	case W5100_Sn_CR_LISTEN:
+		if (status == W5100_SOCK_INIT)
+			Listen(n);
+		break;
+	case W5100_Sn_CR_CONNECT:
+		if (status == W5100_SOCK_INIT)
+			Connect(n);
+		break;
+	case W5100_Sn_CR_DISCON:
+		if (status == W5100_SOCK_ESTABLISHED || status == W5100_SOCK_CLOSE_WAIT)
+		{
+			CloseSocket(n);	// host does the FIN handshake
+			SetInterrupt(n, W5100_Sn_IR_DISCON);
+		}
+		break;
+	case W5100_Sn_CR_CLOSE:
+		CloseSocket(n);
+		break;
+	case W5100_Sn_CR_SEND:
+	case W5100_Sn_CR_SEND_MAC:	// host does ARP, so same as SEND
+		Send(n);
+		break;
+	case W5100_Sn_CR_SEND_KEEP:
+		break;	// host does TCP keep-alive
+	case W5100_Sn_CR_RECV:
+		UpdateSizes(n);	// Sn_RX_RD has moved on, so there may be room for more
+		ProcessSocket(n);
+		break;
+	default:
+		LogFileOutput("Uthernet II: socket %u: unknown command 0x%02X\n", n, command);
+		break;
+	}
+}
+
+void Uthernet2::OpenSocket(UINT n)
+{
+	CloseHostSocket(n);
+
+	Socket& socket = m_socket[n];
+	socket.rxWritePtr = 0;
+	socket.bSendPending = false;
+	Write16(SocketReg(n, W5100_Sn_TX_RD0), 0);
+	Write16(SocketReg(n, W5100_Sn_TX_WR0), 0);
+	Write16(SocketReg(n, W5100_Sn_RX_RD0), 0);
+	UpdateSizes(n);
+
+	const BYTE protocol = m_memory[SocketReg(n, W5100_Sn_MR)] & W5100_Sn_MR_PROTO_MASK;
+
+	switch (protocol)
+	{
+	case W5100_Sn_MR_TCP:
+		SetStatus(n, W5100_SOCK_INIT);	// host socket is created by LISTEN or CONNECT
+		break;
+	case W5100_Sn_MR_UDP:
+		if (CreateHostSocket(n, SOCK_DGRAM) && BindHostSocket(n))
+		{
+			SetStatus(n, W5100_SOCK_UDP);
+		}
+		else
+		{
+			CloseHostSocket(n);
+			SetStatus(n, W5100_SOCK_CLOSED);
+		}
+		break;
+	default:
+		LogFileOutput("Uthernet II: socket %u: unsupported mode 0x%02X\n", n, protocol);
+		SetStatus(n, W5100_SOCK_CLOSED);
+		break;
+	}
+}
+
+void Uthernet2::Listen(UINT n)
+{
+	if (CreateHostSocket(n, SOCK_STREAM))
+	{
+		const int reuse = 1;
+		setsockopt(m_socket[n].hSocket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+		if (BindHostSocket(n) && listen(m_socket[n].hSocket, 1) == 0)
+		{
+			SetStatus(n, W5100_SOCK_LISTEN);
+			return;
+		}
+
+		LogFileOutput("Uthernet II: socket %u: listen failed (%d)\n", n, WSAGetLastError());
+	}
+
+	CloseSocket(n);
+}
+
+void Uthernet2::Connect(UINT n)
+{
+	if (!CreateHostSocket(n, SOCK_STREAM))
+	{
+		CloseSocket(n);
+		SetInterrupt(n, W5100_Sn_IR_TIMEOUT);
+		return;
+	}
+
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	memcpy(&addr.sin_addr, &m_memory[SocketReg(n, W5100_Sn_DIPR0)], 4);	// already in network order
+	addr.sin_port = htons(Read16(SocketReg(n, W5100_Sn_DPORT0)));
+
+	if (connect(m_socket[n].hSocket, (const sockaddr*)&addr, sizeof(addr)) == 0)
+	{
+		SetStatus(n, W5100_SOCK_ESTABLISHED);
+		SetInterrupt(n, W5100_Sn_IR_CON);
+	}
+	else if (WSAGetLastError() == WSAEWOULDBLOCK)
+	{
+		SetStatus(n, W5100_SOCK_SYNSENT);	// see ProcessConnecting()
+	}
+	else
+	{
+		CloseSocket(n);
+		SetInterrupt(n, W5100_Sn_IR_TIMEOUT);
+	}
+}
+
+void Uthernet2::Send(UINT n)
+{
+	const BYTE status = m_memory[SocketReg(n, W5100_Sn_SR)];
+
+	if (status == W5100_SOCK_ESTABLISHED || status == W5100_SOCK_CLOSE_WAIT)
+	{
+		SendTCP(n);
+		return;
+	}
+
+	if (status != W5100_SOCK_UDP)
+		return;
+
+	// UDP: [Sn_TX_RD, Sn_TX_WR) is one datagram
+	const Socket& socket = m_socket[n];
+	const WORD txRd = Read16(SocketReg(n, W5100_Sn_TX_RD0));
+	const WORD txWr = Read16(SocketReg(n, W5100_Sn_TX_WR0));
+	UINT uLength = (WORD)(txWr - txRd);
+	if (uLength > socket.txSize)
+		uLength = socket.txSize;
+
+	BYTE buffer[W5100_BUFFER_SIZE];
+	for (UINT i = 0; i < uLength; i++)
+		buffer[i] = m_memory[socket.txBase + ((txRd + i) & (socket.txSize - 1))];
+
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	memcpy(&addr.sin_addr, &m_memory[SocketReg(n, W5100_Sn_DIPR0)], 4);
+	addr.sin_port = htons(Read16(SocketReg(n, W5100_Sn_DPORT0)));
+
+	if (sendto(socket.hSocket, (const char*)buffer, uLength, 0, (const sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR)
+		LogFileOutput("Uthernet II: socket %u: sendto failed (%d)\n", n, WSAGetLastError());	// UDP is unreliable anyway
+
+	Write16(SocketReg(n, W5100_Sn_TX_RD0), txWr);
+	UpdateSizes(n);
+	SetInterrupt(n, W5100_Sn_IR_SEND_OK);
+}
+
+// Send as much of [Sn_TX_RD, Sn_TX_WR) as the host will take
+// . if it won't take it all, then the rest is sent by ProcessTCP(), and SEND_OK is deferred until then
+void Uthernet2::SendTCP(UINT n)
+{
+	Socket& socket = m_socket[n];
+	if (socket.txSize == 0)
+		return;
+
+	WORD txRd = Read16(SocketReg(n, W5100_Sn_TX_RD0));
+	const WORD txWr = Read16(SocketReg(n, W5100_Sn_TX_WR0));
+	UINT uLength = (WORD)(txWr - txRd);
+	if (uLength > socket.txSize)
+		uLength = socket.txSize;
+
+	BYTE buffer[W5100_BUFFER_SIZE];
+	for (UINT i = 0; i < uLength; i++)
+		buffer[i] = m_memory[socket.txBase + ((txRd + i) & (socket.txSize - 1))];
+
+	const int sent = uLength ? send(socket.hSocket, (const char*)buffer, uLength, 0) : 0;
+	if (sent == SOCKET_ERROR)
+	{
+		if (WSAGetLastError() == WSAEWOULDBLOCK)
+		{
+			socket.bSendPending = true;
+		}
+		else
+		{
+			CloseSocket(n);
+			SetInterrupt(n, W5100_Sn_IR_DISCON);
+		}
+		return;
+	}
+
+	txRd += (WORD)sent;
+	Write16(SocketReg(n, W5100_Sn_TX_RD0), txRd);
+	UpdateSizes(n);
+
+	socket.bSendPending = (UINT)sent < uLength;
+	if (!socket.bSendPending)
+		SetInterrupt(n, W5100_Sn_IR_SEND_OK);
+}
+
+void Uthernet2::CloseSocket(UINT n)
+{
+	CloseHostSocket(n);
+	m_socket[n].bSendPending = false;
+	SetStatus(n, W5100_SOCK_CLOSED);
+}
+
+//===========================================================================
+
+// Poll the host socket & update the socket's registers
+void Uthernet2::ProcessSocket(UINT n)
+{
+	if (m_socket[n].hSocket == INVALID_SOCKET)
+		return;
+
+	switch (m_memory[SocketReg(n, W5100_Sn_SR)])
+	{
+	case W5100_SOCK_SYNSENT:
+		ProcessConnecting(n);
+		break;
+	case W5100_SOCK_LISTEN:
+		ProcessListening(n);
+		break;
+	case W5100_SOCK_ESTABLISHED:
+	case W5100_SOCK_CLOSE_WAIT:
+		ProcessTCP(n);
+		break;
+	case W5100_SOCK_UDP:
+		ProcessUDP(n);
+		break;
+	}
+}
+
+void Uthernet2::ProcessConnecting(UINT n)
+{
+	const SOCKET hSocket = m_socket[n].hSocket;
+
+	fd_set writeSet, exceptSet;
+	FD_ZERO(&writeSet);
+	FD_ZERO(&exceptSet);
+	FD_SET(hSocket, &writeSet);
+	FD_SET(hSocket, &exceptSet);
+	timeval timeout = { 0, 0 };
+
+	if (select((int)hSocket + 1, NULL, &writeSet, &exceptSet, &timeout) <= 0)
+		return;	// still connecting
+
+	// Windows flags a failed connect via exceptSet, others via SO_ERROR
+	int error = 0;
+	int errorLen = sizeof(error);
+	getsockopt(hSocket, SOL_SOCKET, SO_ERROR, (char*)&error, &errorLen);
+
+	if (FD_ISSET(hSocket, &exceptSet) || error)
+	{
+		CloseSocket(n);
+		SetInterrupt(n, W5100_Sn_IR_TIMEOUT);
+		return;
+	}
+
+	SetStatus(n, W5100_SOCK_ESTABLISHED);
+	SetInterrupt(n, W5100_Sn_IR_CON);
+}
+
+void Uthernet2::ProcessListening(UINT n)
+{
+	sockaddr_in addr;
+	int addrLen = sizeof(addr);
+	const SOCKET hClient = accept(m_socket[n].hSocket, (sockaddr*)&addr, &addrLen);
+	if (hClient == INVALID_SOCKET)
+		return;	// no-one yet
+
+	// Like the W5100, the listening socket becomes the connection (so no more connections are accepted)
+	closesocket(m_socket[n].hSocket);
+	m_socket[n].hSocket = hClient;
+
+	u_long nonBlocking = 1;
+	ioctlsocket(hClient, FIONBIO, &nonBlocking);
+
+	memcpy(&m_memory[SocketReg(n, W5100_Sn_DIPR0)], &addr.sin_addr, 4);
+	Write16(SocketReg(n, W5100_Sn_DPORT0), ntohs(addr.sin_port));
+
+	SetStatus(n, W5100_SOCK_ESTABLISHED);
+	SetInterrupt(n, W5100_Sn_IR_CON);
+}
+
+void Uthernet2::ProcessTCP(UINT n)
+{
+	Socket& socket = m_socket[n];
+
+	if (socket.bSendPending)
+	{
+		SendTCP(n);
+		if (socket.hSocket == INVALID_SOCKET)
+			return;
+	}
+
+	if (m_memory[SocketReg(n, W5100_Sn_SR)] != W5100_SOCK_ESTABLISHED)
+		return;	// CLOSE_WAIT: peer has nothing more to send
+
+	const WORD rxUsed = socket.rxWritePtr - Read16(SocketReg(n, W5100_Sn_RX_RD0));
+	if (rxUsed >= socket.rxSize)
+		return;	// RX buffer full: leave the data in the host socket
+
+	BYTE buffer[W5100_BUFFER_SIZE];
+	const int len = recv(socket.hSocket, (char*)buffer, socket.rxSize - rxUsed, 0);
+
+	if (len > 0)
+	{
+		WriteRx(n, buffer, len);
+		SetInterrupt(n, W5100_Sn_IR_RECV);
+	}
+	else if (len == 0)
+	{
+		SetStatus(n, W5100_SOCK_CLOSE_WAIT);	// peer has closed
+		SetInterrupt(n, W5100_Sn_IR_DISCON);
+	}
+	else if (WSAGetLastError() != WSAEWOULDBLOCK)
+	{
+		CloseSocket(n);
+		SetInterrupt(n, W5100_Sn_IR_DISCON);
+	}
+}
+
+// Each received datagram is written to the RX buffer with an 8-byte header: peer IP, peer port, data size
+void Uthernet2::ProcessUDP(UINT n)
+{
+	const Socket& socket = m_socket[n];
+	if (socket.rxSize <= W5100_UDP_HEADER_SIZE)
+		return;
+
+	// Only receive when a max-size datagram will fit, otherwise leave it in the host socket
+	const UINT uMaxData = min((UINT)W5100_UDP_MAX_DATA, (UINT)socket.rxSize - W5100_UDP_HEADER_SIZE);
+	const WORD rxUsed = socket.rxWritePtr - Read16(SocketReg(n, W5100_Sn_RX_RD0));
+	if (rxUsed > socket.rxSize || socket.rxSize - rxUsed < W5100_UDP_HEADER_SIZE + uMaxData)
+		return;
+
+	BYTE buffer[W5100_UDP_HEADER_SIZE + W5100_UDP_MAX_DATA];
+	sockaddr_in addr;
+	int addrLen = sizeof(addr);
+	int len = recvfrom(socket.hSocket, (char*)buffer + W5100_UDP_HEADER_SIZE, uMaxData, 0, (sockaddr*)&addr, &addrLen);
+
+	if (len == SOCKET_ERROR)
+	{
+		if (WSAGetLastError() != WSAEMSGSIZE)
+			return;	// nothing received
+		len = uMaxData;	// truncated
+	}
+
+	memcpy(buffer, &addr.sin_addr, 4);
+	const WORD port = ntohs(addr.sin_port);
+	buffer[4] = port >> 8;
+	buffer[5] = port & 0xff;
+	buffer[6] = len >> 8;
+	buffer[7] = len & 0xff;
+
+	WriteRx(n, buffer, W5100_UDP_HEADER_SIZE + len);
+	SetInterrupt(n, W5100_Sn_IR_RECV);
+}
+
+//===========================================================================
+
+bool Uthernet2::CreateHostSocket(UINT n, int type)
+{
+	CloseHostSocket(n);
+
+	const SOCKET hSocket = socket(AF_INET, type, type == SOCK_STREAM ? IPPROTO_TCP : IPPROTO_UDP);
+	if (hSocket == INVALID_SOCKET)
+	{
+		LogFileOutput("Uthernet II: socket %u: socket() failed (%d)\n", n, WSAGetLastError());
+		return false;
+	}
+
+	u_long nonBlocking = 1;
+	ioctlsocket(hSocket, FIONBIO, &nonBlocking);
+
+	m_socket[n].hSocket = hSocket;
+	return true;
+}
+
+void Uthernet2::CloseHostSocket(UINT n)
+{
+	if (m_socket[n].hSocket != INVALID_SOCKET)
+	{
+		closesocket(m_socket[n].hSocket);
+		m_socket[n].hSocket = INVALID_SOCKET;
+	}
+}
+
+// Bind to Sn_PORT on all host interfaces (port 0: host picks one)
+bool Uthernet2::BindHostSocket(UINT n)
+{
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(Read16(SocketReg(n, W5100_Sn_PORT0)));
+
+	if (bind(m_socket[n].hSocket, (const sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR)
+	{
+		LogFileOutput("Uthernet II: socket %u: bind to port %u failed (%d)\n", n, ntohs(addr.sin_port), WSAGetLastError());
+		return false;
+	}
+
+	return true;
+}
+
+void Uthernet2::WriteRx(UINT n, const BYTE* pData, UINT uLength)
+{
+	Socket& socket = m_socket[n];
+
+	for (UINT i = 0; i < uLength; i++)
+		m_memory[socket.rxBase + ((socket.rxWritePtr + i) & (socket.rxSize - 1))] = pData[i];
+
+	socket.rxWritePtr += uLength;
+	UpdateSizes(n);
+}
+
+//===========================================================================
+
+#define SS_YAML_VALUE_CARD_UTHERNET2 "Uthernet II"
+
+#define SS_YAML_KEY_DATA_ADDRESS "Data Address"
+#define SS_YAML_KEY_SOCKET "Socket"
+#define SS_YAML_KEY_RX_WRITE_PTR "RX Write Pointer"
+#define SS_YAML_KEY_W5100_MEMORY "W5100 Memory"
+
+std::string Uthernet2::GetSnapshotCardName(void)
+{
+	static const std::string name(SS_YAML_VALUE_CARD_UTHERNET2);
+	return name;
+}
+
+void Uthernet2::SaveSnapshot(YamlSaveHelper& yamlSaveHelper)
+{
+	YamlSaveHelper::Slot slot(yamlSaveHelper, GetSnapshotCardName(), m_uSlot, 1);
+
+	YamlSaveHelper::Label state(yamlSaveHelper, "%s:\n", SS_YAML_KEY_STATE);
+	yamlSaveHelper.SaveHexUint16(SS_YAML_KEY_DATA_ADDRESS, m_dataAddress);
+
+	for (UINT n = 0; n < W5100_NUM_SOCKETS; n++)
+	{
+		YamlSaveHelper::Label socket(yamlSaveHelper, "%s%u:\n", SS_YAML_KEY_SOCKET, n);
+		yamlSaveHelper.SaveHexUint16(SS_YAML_KEY_RX_WRITE_PTR, m_socket[n].rxWritePtr);
+	}
+
+	// New label
+	{
+		YamlSaveHelper::Label memory(yamlSaveHelper, "%s:\n", SS_YAML_KEY_W5100_MEMORY);
+		yamlSaveHelper.SaveMemory(m_memory, W5100_MEM_SIZE);
+	}
+}
+
+bool Uthernet2::LoadSnapshot(YamlLoadHelper& yamlLoadHelper, UINT slot, UINT version)
+{
+	if (slot != m_uSlot)
+		throw std::string("Card: wrong slot");
+
+	if (version != 1)
+		throw std::string("Card: wrong version");
+
+	for (UINT n = 0; n < W5100_NUM_SOCKETS; n++)
+		CloseSocket(n);
+
+	m_dataAddress = yamlLoadHelper.LoadUint(SS_YAML_KEY_DATA_ADDRESS);
+
+	for (UINT n = 0; n < W5100_NUM_SOCKETS; n++)
+	{
+		char key[sizeof(SS_YAML_KEY_SOCKET) + 1];
+		sprintf_s(key, sizeof(key), "%s%u", SS_YAML_KEY_SOCKET, n);
+
+		if (!yamlLoadHelper.GetSubMap(key))
+			throw std::string("Card: Expected key: ") + key;
+		m_socket[n].rxWritePtr = yamlLoadHelper.LoadUint(SS_YAML_KEY_RX_WRITE_PTR);
+		yamlLoadHelper.PopMap();
+	}
+
+	if (!yamlLoadHelper.GetSubMap(SS_YAML_KEY_W5100_MEMORY))
+		throw std::string("Card: Expected key: " SS_YAML_KEY_W5100_MEMORY);
+	yamlLoadHelper.LoadMemory(m_memory, W5100_MEM_SIZE);
+	yamlLoadHelper.PopMap();
+
+	ResizeBuffers();
+
+	// Host connections can't be restored: TCP connections are dropped (as if the peer had gone), and UDP & listening sockets are re-opened
+	for (UINT n = 0; n < W5100_NUM_SOCKETS; n++)
+	{
+		switch (m_memory[SocketReg(n, W5100_Sn_SR)])
+		{
+		case W5100_SOCK_UDP:
+			if (!CreateHostSocket(n, SOCK_DGRAM) || !BindHostSocket(n))
+				CloseSocket(n);
+			break;
+		case W5100_SOCK_LISTEN:
+			Listen(n);
+			break;
+		case W5100_SOCK_SYNSENT:
+		case W5100_SOCK_ESTABLISHED:
+		case W5100_SOCK_CLOSE_WAIT:
+			CloseSocket(n);
+			SetInterrupt(n, W5100_Sn_IR_DISCON);
+			break;
+		}
+	}
+
+	return true;
+}
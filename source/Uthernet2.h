@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Card.h"
+#include "W5100.h"
+
+// Uthernet II: WIZnet W5100 with hardware TCP/IP
+// . The guest's TCP & UDP sockets are mapped onto host sockets, so the 6502 doesn't run an IP stack
+// . I/O at $C0n4-$C0n7 (indirect bus I/F: mode, address hi, address lo, data), no ROM
+
+class Uthernet2 : public Card
+{
+public:
+	Uthernet2(UINT slot);
+	virtual ~Uthernet2(void);
+
+	virtual void Init(void) {};
+	virtual void Reset(const bool powerCycle);
+
+	void InitializeIO(LPBYTE pCxRomPeripheral);
+	UINT GetSlot(void) { return m_uSlot; }
+
+	static BYTE __stdcall IORead(WORD PC, WORD uAddr, BYTE bWrite, BYTE uValue, ULONG nExecutedCycles);
+	static BYTE __stdcall IOWrite(WORD PC, WORD uAddr, BYTE bWrite, BYTE uValue, ULONG nExecutedCycles);
+
+	static std::string GetSnapshotCardName(void);
+	void SaveSnapshot(class YamlSaveHelper& yamlSaveHelper);
+	bool LoadSnapshot(class YamlLoadHelper& yamlLoadHelper, UINT slot, UINT version);
+
+private:
+	struct Socket
+	{
+		SOCKET hSocket;
+		WORD txBase;		// in m_memory
+		WORD txSize;
+		WORD rxBase;
+		WORD rxSize;
+		WORD rxWritePtr;	// where the next received byte goes (Sn_RX_RSR = rxWritePtr - Sn_RX_RD)
+		bool bSendPending;	// TCP: the host's send buffer was full, so [Sn_TX_RD, Sn_TX_WR) isn't all sent yet
+	};
+
+	void SoftReset(void);
+	void ResizeBuffers(void);
+
+	BYTE ReadValue(WORD addr);
+	void WriteValue(WORD addr, BYTE value);
+	void AutoIncrement(void);
+
+	WORD SocketReg(UINT n, WORD reg) { return W5100_S0_BASE + n * W5100_SOCKET_REG_SIZE + reg; }
+	WORD Read16(WORD addr) { return (m_memory[addr] << 8) | m_memory[addr + 1]; }
+	void Write16(WORD addr, WORD value) { m_memory[addr] = value >> 8; m_memory[addr + 1] = value & 0xFF; }
+
+	void SetStatus(UINT n, BYTE status);
+	void SetInterrupt(UINT n, BYTE flags);
+	void UpdateInterruptRegister(void);
+	void UpdateSizes(UINT n);
+
+	void ExecuteCommand(UINT n, BYTE command);
+	void OpenSocket(UINT n);
+	void Listen(UINT n);
+	void Connect(UINT n);
+	void Send(UINT n);
+	void SendTCP(UINT n);
+	void CloseSocket(UINT n);
+
+	void ProcessSocket(UINT n);
+	void ProcessConnecting(UINT n);
+	void ProcessListening(UINT n);
+	void ProcessTCP(UINT n);
+	void ProcessUDP(UINT n);
+
+	bool CreateHostSocket(UINT n, int type);
+	void CloseHostSocket(UINT n);
+	bool BindHostSocket(UINT n);
+	void WriteRx(UINT n, const BYTE* pData, UINT uLength);
+
+	BYTE m_memory[W5100_MEM_SIZE];
+	WORD m_dataAddress;
+	Socket m_socket[W5100_NUM_SOCKETS];
+	bool m_bWinsockStarted;
+	UINT m_uSlot;
+};
@@ -542,6 +542,11 @@ void ResetMachineState()
 	SpkrReset();
 	if (GetCardMgr().IsMouseCardInstalled())
 		GetCardMgr().GetMouseCard()->Reset();
+	for (UINT slot = SLOT1; slot < NUM_SLOTS; slot++)
+	{
+		if (GetCardMgr().QuerySlot(slot) == CT_Uthernet2)
+			GetCardMgr().GetRef(slot).Reset(true);
+	}
 	SetActiveCpu(GetMainCpu());
 #ifdef USE_SPEECH_API
 	g_Speech.Reset();
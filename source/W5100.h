@@ -0,0 +1,98 @@
+#pragma once
+
+// WIZnet W5100 (as used by the Uthernet II)
+// Ref: W5100 Datasheet v1.2.x
+
+#define W5100_MEM_SIZE			0x8000	// registers, TX & RX memory
+
+// Common registers
+
+#define W5100_MR				0x0000	// Mode
+#define W5100_GAR0				0x0001	// Gateway Address (4)
+#define W5100_SUBR0				0x0005	// Subnet mask Address (4)
+#define W5100_SHAR0				0x0009	// Source Hardware Address (6)
+#define W5100_SIPR0				0x000F	// Source IP Address (4)
+#define W5100_IR				0x0015	// Interrupt
+#define W5100_IMR				0x0016	// Interrupt Mask
+#define W5100_RTR0				0x0017	// Retry Time (2)
+#define W5100_RCR				0x0019	// Retry Count
+#define W5100_RMSR				0x001A	// RX Memory Size
+#define W5100_TMSR				0x001B	// TX Memory Size
+
+#define W5100_MR_RST			0x80	// S/W reset (self-clearing)
+#define W5100_MR_PB				0x10	// Ping block
+#define W5100_MR_PPPOE			0x08
+#define W5100_MR_AI				0x02	// Address auto-increment (indirect bus I/F mode)
+#define W5100_MR_IND			0x01	// Indirect bus I/F mode
+
+#define W5100_IR_CONFLICT		0x80
+#define W5100_IR_UNREACH		0x40
+#define W5100_IR_PPPOE			0x20
+#define W5100_IR_SOCKETS		0x0F	// bit n = Sn_IR != 0
+
+// Socket registers
+
+#define W5100_NUM_SOCKETS		4
+#define W5100_S0_BASE			0x0400
+#define W5100_SOCKET_REG_SIZE	0x0100	// Sn registers are at W5100_S0_BASE + n * W5100_SOCKET_REG_SIZE
+
+#define W5100_Sn_MR				0x00	// Mode
+#define W5100_Sn_CR				0x01	// Command
+#define W5100_Sn_IR				0x02	// Interrupt
+#define W5100_Sn_SR				0x03	// Status
+#define W5100_Sn_PORT0			0x04	// Source Port (2)
+#define W5100_Sn_DHAR0			0x06	// Destination Hardware Address (6)
+#define W5100_Sn_DIPR0			0x0C	// Destination IP Address (4)
+#define W5100_Sn_DPORT0			0x10	// Destination Port (2)
+#define W5100_Sn_MSSR0			0x12	// Maximum Segment Size (2)
+#define W5100_Sn_PROTO			0x14	// Protocol in IP Raw mode
+#define W5100_Sn_TOS			0x15
+#define W5100_Sn_TTL			0x16
+#define W5100_Sn_TX_FSR0		0x20	// TX Free Size (2)
+#define W5100_Sn_TX_RD0			0x22	// TX Read Pointer (2)
+#define W5100_Sn_TX_WR0			0x24	// TX Write Pointer (2)
+#define W5100_Sn_RX_RSR0		0x26	// RX Received Size (2)
+#define W5100_Sn_RX_RD0			0x28	// RX Read Pointer (2)
+
+#define W5100_Sn_MR_PROTO_MASK	0x0F
+#define W5100_Sn_MR_CLOSED		0x00
+#define W5100_Sn_MR_TCP			0x01
+#define W5100_Sn_MR_UDP			0x02
+#define W5100_Sn_MR_IPRAW		0x03
+#define W5100_Sn_MR_MACRAW		0x04	// S0 only
+#define W5100_Sn_MR_PPPOE		0x05	// S0 only
+
+#define W5100_Sn_CR_OPEN		0x01
+#define W5100_Sn_CR_LISTEN		0x02
+#define W5100_Sn_CR_CONNECT		0x04
+#define W5100_Sn_CR_DISCON		0x08
+#define W5100_Sn_CR_CLOSE		0x10
+#define W5100_Sn_CR_SEND		0x20
+#define W5100_Sn_CR_SEND_MAC	0x21
+#define W5100_Sn_CR_SEND_KEEP	0x22
+#define W5100_Sn_CR_RECV		0x40
+
+#define W5100_Sn_IR_SEND_OK		0x10
+#define W5100_Sn_IR_TIMEOUT		0x08
+#define W5100_Sn_IR_RECV		0x04
+#define W5100_Sn_IR_DISCON		0x02
+#define W5100_Sn_IR_CON			0x01
+
+#define W5100_SOCK_CLOSED		0x00
+#define W5100_SOCK_INIT			0x13
+#define W5100_SOCK_LISTEN		0x14
+#define W5100_SOCK_SYNSENT		0x15
+#define W5100_SOCK_ESTABLISHED	0x17
+#define W5100_SOCK_CLOSE_WAIT	0x1C
+#define W5100_SOCK_UDP			0x22
+#define W5100_SOCK_IPRAW		0x32
+#define W5100_SOCK_MACRAW		0x42
+
+// TX & RX memory (each 8K, shared between the sockets according to TMSR & RMSR)
+
+#define W5100_TX_BASE			0x4000
+#define W5100_RX_BASE			0x6000
+#define W5100_BUFFER_SIZE		0x2000
+
+#define W5100_UDP_HEADER_SIZE	8		// RX: peer IP (4), peer port (2), data size (2)
+#define W5100_UDP_MAX_DATA		1472	// MTU (1500) - IP & UDP headers
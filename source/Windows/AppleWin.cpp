@@ -210,8 +210,9 @@ static void ContinueExecution(void)
 	const UINT uCyclesToExecuteWithFeedback = (nCyclesWithFeedback >= 0) ? nCyclesWithFeedback
 																		 : 0;
 
-	const DWORD uCyclesToExecute = (g_nAppMode == MODE_RUNNING)		? uCyclesToExecuteWithFeedback
-												/* MODE_STEPPING */ : 0;
+	// MODE_STEPPING: if the debugger's breakpoint traps are armed, then the debug CPU core will stop on a breakpoint
+	const DWORD uCyclesToExecute = (g_nAppMode == MODE_RUNNING || IsDebugBreakpointTrapsArmed())	? uCyclesToExecuteWithFeedback
+																	/* MODE_STEPPING */ : 0;
 
 	const bool bVideoUpdate = !g_bFullSpeed;
 	const DWORD uActualCyclesExecuted = CpuExecute(uCyclesToExecute, bVideoUpdate);
@@ -767,6 +768,18 @@ static void RepeatInitialization(void)
 			GetCardMgr().Insert(SLOT5, g_cmdLine.slotInsert[SLOT5]);
 		}
 
+		// Uthernet II can go in any slot (NB. for slot-5 it's handled above)
+		for (UINT slot = SLOT1; slot < NUM_SLOTS; slot++)
+		{
+			if (slot == SLOT5 || g_cmdLine.slotInsert[slot] != CT_Uthernet2)
+				continue;
+
+			if (slot == SLOT4 && GetCardMgr().QuerySlot(SLOT4) == CT_MockingboardC)	// Currently MB occupies slot4+5 when enabled
+				GetCardMgr().Remove(SLOT5);
+
+			GetCardMgr().Insert(slot, CT_Uthernet2);
+		}
+
 		// Pre: may need g_hFrameWindow for MessageBox errors
 		// Post: may enable HDD, required for MemInitialize()->MemInitializeIO()
 		{
@@ -841,8 +854,12 @@ static void RepeatInitialization(void)
 			g_cmdLine.bShutdown = true;
 		}
 
-		tfe_init();
-		LogFileOutput("Main: tfe_init()\n");
+		// Uthernet (CS8900A) is hardwired to slot-3, so it's not enabled if there's an Uthernet II there
+		if (GetCardMgr().QuerySlot(SLOT3) != CT_Uthernet2)
+		{
+			tfe_init();
+			LogFileOutput("Main: tfe_init()\n");
+		}
 
 		if (g_cmdLine.szSnapshotName)
 		{
@@ -873,6 +890,18 @@ static void RepeatInitialization(void)
 			g_cmdLine.bShutdown = true;
 		}
 
+		if (g_cmdLine.uDebuggerServerPort && !g_cmdLine.bShutdown)
+		{
+			DebuggerServerStart(g_cmdLine.uDebuggerServerPort);	// Needs g_hFrameWindow for socket events
+			LogFileOutput("Main: DebuggerServerStart()\n");
+		}
+
+		if (g_cmdLine.uGdbStubPort && !g_cmdLine.bShutdown)
+		{
+			GdbStubStart(g_cmdLine.uGdbStubPort);	// Needs g_hFrameWindow for socket events
+			LogFileOutput("Main: GdbStubStart()\n");
+		}
+
 		if (g_cmdLine.bShutdown)
 		{
 			PostMessage(GetFrame().g_hFrameWindow, WM_DESTROY, 0, 0);	// Close everything down
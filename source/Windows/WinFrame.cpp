@@ -1718,47 +1718,66 @@ LRESULT Win32Frame::WndProc(
 		Snapshot_LoadState();
 		break;
 
-	case WM_USER_TCP_SERIAL:	// TCP serial events
+	case WM_USER_DEBUGGER_SERVER:	// Debugger server events
 	{
 		WORD error = WSAGETSELECTERROR(lparam);
 		if (error != 0)
 		{
-			LogOutput("TCP Serial Winsock error 0x%X (%d)\r", error, error);
-			switch (error)
+			LogOutput("Debugger Server Winsock error 0x%X (%d)\r", error, error);
+			DebuggerServerClose();
+		}
+		else
+		{
+			WORD wSelectEvent = WSAGETSELECTEVENT(lparam);
+			switch(wSelectEvent)
 			{
-			case WSAENETRESET:
-			case WSAECONNABORTED:
-			case WSAECONNRESET:
-			case WSAENOTCONN:
-			case WSAETIMEDOUT:
-				if (GetCardMgr().IsSSCInstalled())
-					GetCardMgr().GetSSC()->CommTcpSerialClose();
-				break;
+				case FD_ACCEPT:
+					DebuggerServerAccept();
+					break;
 
-			default:
-				if (GetCardMgr().IsSSCInstalled())
-					GetCardMgr().GetSSC()->CommTcpSerialCleanup();
-				break;
+				case FD_CLOSE:
+					DebuggerServerClose();
+					break;
+
+				case FD_READ:
+					DebuggerServerReceive();
+					break;
+
+				case FD_WRITE:
+					DebuggerServerSend();
+					break;
 			}
 		}
+		break;
+	}
+
+	case WM_USER_GDB_STUB:	// GDB remote stub events
+	{
+		WORD error = WSAGETSELECTERROR(lparam);
+		if (error != 0)
+		{
+			LogOutput("GDB Stub Winsock error 0x%X (%d)\r", error, error);
+			GdbStubClose();
+		}
 		else
 		{
 			WORD wSelectEvent = WSAGETSELECTEVENT(lparam);
 			switch(wSelectEvent)
 			{
 				case FD_ACCEPT:
-					if (GetCardMgr().IsSSCInstalled())
-						GetCardMgr().GetSSC()->CommTcpSerialAccept();
+					GdbStubAccept();
 					break;
 
 				case FD_CLOSE:
-					if (GetCardMgr().IsSSCInstalled())
-						GetCardMgr().GetSSC()->CommTcpSerialClose();
+					GdbStubClose();
 					break;
 
 				case FD_READ:
-					if (GetCardMgr().IsSSCInstalled())
-						GetCardMgr().GetSSC()->CommTcpSerialReceive();
+					GdbStubReceive();
+					break;
+
+				case FD_WRITE:
+					GdbStubSend();
 					break;
 			}
 		}
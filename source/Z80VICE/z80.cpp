@@ -26,6 +26,7 @@
 
 #include "../StdAfx.h"
 
+#include "../Core.h"
 #include "../CPU.h"
 #include "../Memory.h"
 #include "../YamlHelper.h"
@@ -56,6 +57,12 @@
 
 CLOCK maincpu_clk = 0;		// [AppleWin-TC]
 
+// [AppleWin-TC] T-states of the last 6502 cycle that weren't a whole 6502 cycle. Carried into the next burst, so the Z80 doesn't drift
+static CLOCK z80_tstates_carry = 0;
+
+// [AppleWin-TC] End of the current burst, in T-states. Zeroed to end the burst early, when the Z80 hands back to the 6502
+static CLOCK z80_clk_end = 0;
+
 static BYTE reg_a = 0;
 static BYTE reg_b = 0;
 static BYTE reg_c = 0;
@@ -108,6 +115,7 @@ void z80_reset(void)
     iff1 = 0;
     iff2 = 0;
     im_mode = 0;
+    z80_tstates_carry = 0;	// [AppleWin-TC]
 }
 
 /*inline*/ static BYTE *z80mem_read_base(int addr)	// [AppleWin-TC]
@@ -134,11 +142,51 @@ void z80_reset(void)
    } while (0)
 
 
+/****************************************************************************/
+/* SoftCard address translation                                             */
+/****************************************************************************/
+
+// [AppleWin-TC] Per Z80 page: the 6502 page it maps to, and how it's accessed
+//   Z80 $0000-$AFFF -> 6502 $1000-$BFFF
+//   Z80 $B000-$DFFF -> 6502 $D000-$FFFF ($F800-$FFFF via IO_F8xx(), for the No-Slot-Clock)
+//   Z80 $E000-$EFFF -> 6502 $C000-$CFFF (I/O & slot ROMs)
+//   Z80 $F000-$FFFF -> 6502 $0000-$0FFF
+enum { Z80_PAGE_MEM, Z80_PAGE_IO, Z80_PAGE_F8XX };
+
+static BYTE z80_page_6502[0x100];
+static BYTE z80_page_type[0x100];
+
+void z80_page_map_initialize(void)
+{
+	for (UINT page = 0; page < 0x100; page++)
+	{
+		BYTE page6502;
+		if (page < 0xB0)
+			page6502 = page + 0x10;
+		else if (page < 0xE0)
+			page6502 = page + 0x20;
+		else if (page < 0xF0)
+			page6502 = page - 0x20;
+		else
+			page6502 = page - 0xF0;
+
+		z80_page_6502[page] = page6502;
+
+		if ((page6502 & 0xF0) == 0xC0)
+			z80_page_type[page] = Z80_PAGE_IO;
+		else if (page6502 >= 0xF8)
+			z80_page_type[page] = Z80_PAGE_F8XX;
+		else
+			z80_page_type[page] = Z80_PAGE_MEM;
+	}
+}
+
+// [AppleWin-TC] Every page is z80_RDMEM()/z80_WRMEM() (see z80mem_initialize()), so call them directly
 #define LOAD(addr) \
-    (*_z80mem_read_tab_ptr[(addr) >> 8])((WORD)(addr))
+    z80_RDMEM((WORD)(addr))
 
 #define STORE(addr, value) \
-    (*_z80mem_write_tab_ptr[(addr) >> 8])((WORD)(addr), (BYTE)(value))
+    z80_WRMEM((WORD)(addr), (BYTE)(value))
 
 #define IN(addr) \
     (io_read_tab[(addr) >> 8])((WORD)(addr))
@@ -147,10 +195,27 @@ void z80_reset(void)
     (io_write_tab[(addr) >> 8])((WORD)(addr), (BYTE)(value))
 
 #define opcode_t DWORD
-#define FETCH_OPCODE(o) ((o) = (LOAD(z80_reg_pc)		\
-                               | (LOAD(z80_reg_pc + 1) << 8)	\
-                               | (LOAD(z80_reg_pc + 2) << 16)	\
-                               | (LOAD(z80_reg_pc + 3) << 24)))
+
+// [AppleWin-TC] The opcode and the 3 bytes after it, which the instruction's operands (if any) are taken from.
+// When these are all in the same RAM page, read them straight from mem[] with one address translation,
+// instead of 4 separate LOAD()s. Otherwise (eg. page crossing, I/O, or the debugger is active) use LOAD().
+static opcode_t z80_fetch_opcode(void)
+{
+	const WORD pc = (WORD)z80_reg_pc;
+
+	if ((pc & 0xFF) <= 0xFC && z80_page_type[pc >> 8] == Z80_PAGE_MEM && g_nAppMode == MODE_RUNNING)
+	{
+		const BYTE* p = mem + ((z80_page_6502[pc >> 8] << 8) | (pc & 0xFF));
+		return p[0] | (p[1] << 8) | (p[2] << 16) | ((opcode_t)p[3] << 24);
+	}
+
+	return LOAD(z80_reg_pc)
+		| (LOAD(z80_reg_pc + 1) << 8)
+		| (LOAD(z80_reg_pc + 2) << 16)
+		| ((opcode_t)LOAD(z80_reg_pc + 3) << 24);
+}
+
+#define FETCH_OPCODE(o) ((o) = z80_fetch_opcode())
 
 #define p0 (opcode & 0xff)
 #define p1 ((opcode >> 8) & 0xff)
@@ -5511,11 +5576,11 @@ static void opcode_fd(BYTE ip1, BYTE ip2, BYTE ip3, WORD ip12, WORD ip23)
 
 // The effective Z-80 clock rate is 2.041MHz
 // See: http://www.apple2info.net/hardware/softcard/SC-SWHW_a2in.pdf
-static const double uZ80ClockMultiplier = 2;
+static const UINT uZ80ClockMultiplier = 2;
 
 inline static ULONG ConvertZ80TStatesTo6502Cycles(UINT uTStates)
 {
-	return (uTStates < 0) ? 0 : (ULONG) ((double)uTStates / uZ80ClockMultiplier);
+	return uTStates / uZ80ClockMultiplier;
 }
 
 //void z80_mainloop(interrupt_cpu_status_t *cpu_int_status,
@@ -5531,9 +5596,10 @@ DWORD z80_mainloop(ULONG uTotalCycles, ULONG uExecutedCycles)
 
     //dma_request = 0;											// [AppleWin-TC] Not used
 
-	uTotalCycles    = (ULONG) ((double)uTotalCycles    * uZ80ClockMultiplier);
-	uExecutedCycles = (ULONG) ((double)uExecutedCycles * uZ80ClockMultiplier);
-	maincpu_clk = uExecutedCycles;	// Must be signed int, as cycles can go -ve
+	uTotalCycles    *= uZ80ClockMultiplier;
+	uExecutedCycles *= uZ80ClockMultiplier;
+	maincpu_clk = uExecutedCycles + z80_tstates_carry;	// Must be signed int, as cycles can go -ve
+	z80_clk_end = uTotalCycles;
 
     do {
 
@@ -6341,15 +6407,14 @@ DWORD z80_mainloop(ULONG uTotalCycles, ULONG uExecutedCycles)
 
         //cpu_int_status->num_dma_per_opcode = 0;	// [AppleWin-TC] Not used
 
-        if (GetActiveCpu() != CPU_Z80)				// [AppleWin-TC]
-            break;
-
     //} while (!dma_request);
-    } while (maincpu_clk < uTotalCycles);			// [AppleWin-TC]
+    } while (maincpu_clk < z80_clk_end);			// [AppleWin-TC]
 
     export_registers();
 
-	return ConvertZ80TStatesTo6502Cycles(maincpu_clk - uExecutedCycles);
+	const CLOCK uTStates = maincpu_clk - uExecutedCycles;
+	z80_tstates_carry = uTStates % uZ80ClockMultiplier;
+	return ConvertZ80TStatesTo6502Cycles(uTStates);
 }
 
 /****************************************************************************/
@@ -6357,50 +6422,17 @@ DWORD z80_mainloop(ULONG uTotalCycles, ULONG uExecutedCycles)
 /****************************************************************************/
 BYTE z80_RDMEM(WORD Addr)
 {
-	WORD addr;
+	const BYTE type = z80_page_type[Addr >> 8];
+	const WORD addr = (z80_page_6502[Addr >> 8] << 8) | (Addr & 0xFF);
 
-	switch (Addr / 0x1000)
-	{
-		case 0x0:
-		case 0x1:
-		case 0x2:
-		case 0x3:
-		case 0x4:
-		case 0x5:
-		case 0x6:
-		case 0x7:
-		case 0x8:
-		case 0x9:
-		case 0xA:
-			addr = (WORD)Addr + 0x1000;
-			return CpuRead( addr, ConvertZ80TStatesTo6502Cycles(maincpu_clk) );
-		break;
-
-		case 0xB:
-		case 0xC:
-		case 0xD:
-			addr = (WORD)Addr + 0x2000;
-			return CpuRead( addr, ConvertZ80TStatesTo6502Cycles(maincpu_clk) );
-		break;
-
-		case 0xE:
-			addr = (WORD)Addr - 0x2000;
-		    if ((addr & 0xF000) == 0xC000)
-			{
-				return IORead[(addr>>4) & 0xFF]( regs.pc, addr, 0, 0, ConvertZ80TStatesTo6502Cycles(maincpu_clk) );
-			}
-			else
-			{
-				return *(mem+addr);
-			}
-		break;
-
-		case 0xF:
-			addr = (WORD)Addr - 0xF000;
-			return CpuRead( addr, ConvertZ80TStatesTo6502Cycles(maincpu_clk) );
-		break;
-	}
-	return 255;
+	// Same as CpuRead(), without the debugger's heatmap
+	if (type == Z80_PAGE_MEM && g_nAppMode == MODE_RUNNING)
+		return *(mem+addr);
+
+	if (type == Z80_PAGE_IO)
+		return IORead[(addr>>4) & 0xFF]( regs.pc, addr, 0, 0, ConvertZ80TStatesTo6502Cycles(maincpu_clk) );
+
+	return CpuRead( addr, ConvertZ80TStatesTo6502Cycles(maincpu_clk) );
 }
 
 /****************************************************************************/
@@ -6408,30 +6440,24 @@ BYTE z80_RDMEM(WORD Addr)
 /****************************************************************************/
 void z80_WRMEM(WORD Addr, BYTE Value)
 {
-	unsigned int laddr;
-	WORD addr;
+	const BYTE type = z80_page_type[Addr >> 8];
+	const WORD addr = (z80_page_6502[Addr >> 8] << 8) | (Addr & 0xFF);
 
-	laddr = Addr & 0x0FFF;
-	switch (Addr & 0xF000)
+	// Same as CpuWrite(), without the debugger's heatmap. NB. ROM pages have no memwrite[] page
+	if (type == Z80_PAGE_MEM && g_nAppMode == MODE_RUNNING)
 	{
-		case 0x0000: addr = laddr+0x1000; break;
-		case 0x1000: addr = laddr+0x2000; break;
-		case 0x2000: addr = laddr+0x3000; break;
-		case 0x3000: addr = laddr+0x4000; break;
-		case 0x4000: addr = laddr+0x5000; break;
-		case 0x5000: addr = laddr+0x6000; break;
-		case 0x6000: addr = laddr+0x7000; break;
-		case 0x7000: addr = laddr+0x8000; break;
-		case 0x8000: addr = laddr+0x9000; break;
-		case 0x9000: addr = laddr+0xA000; break;
-		case 0xA000: addr = laddr+0xB000; break;
-		case 0xB000: addr = laddr+0xD000; break;
-		case 0xC000: addr = laddr+0xE000; break;
-		case 0xD000: addr = laddr+0xF000; break;
-		case 0xE000: addr = laddr+0xC000; break;
-		case 0xF000: addr = laddr+0x0000; break;
+		memdirty[addr >> 8] = 0xFF;
+		LPBYTE page = memwrite[addr >> 8];
+		if (page)
+			*(page+(addr & 0xFF)) = Value;
+		return;
 	}
+
 	CpuWrite( addr, Value, ConvertZ80TStatesTo6502Cycles(maincpu_clk) );
+
+	// Writing to the SoftCard's slot hands back to the 6502: end the burst after this opcode
+	if (GetActiveCpu() != CPU_Z80)
+		z80_clk_end = 0;
 }
 
 //===========================================================================
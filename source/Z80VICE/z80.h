@@ -40,6 +40,7 @@ extern void z80_reset(void);
 DWORD z80_mainloop(ULONG uTotalCycles, ULONG uExecutedCycles);
 //extern void z80_trigger_dma(void);
 
+void z80_page_map_initialize(void);
 BYTE z80_RDMEM(WORD Addr);
 void z80_WRMEM(WORD Addr, BYTE Value);
 
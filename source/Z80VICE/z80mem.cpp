@@ -161,6 +161,8 @@ void z80mem_initialize(void)
         }
 	}
 
+    z80_page_map_initialize();			// [AppleWin-TC]
+
     _z80mem_read_tab_ptr = mem_read_tab[0];
     _z80mem_write_tab_ptr = mem_write_tab[0];
     _z80mem_read_base_tab_ptr = mem_read_base_tab[0];
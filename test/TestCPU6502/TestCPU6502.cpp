@@ -19,6 +19,14 @@ iofunction		IOWrite[256] = {0};	// TODO: Init
 
 BYTE __stdcall IO_F8xx(WORD programcounter, WORD address, BYTE write, BYTE value, ULONG nCycles)
 {
+	// Same as Memory.cpp without a No-Slot-Clock
+	if (!write)
+		return *(mem+address);
+
+	memdirty[address >> 8] = 0xFF;
+	LPBYTE page = memwrite[address >> 8];
+	if (page)
+		*(page+(address & 0xFF)) = value;
 	return 0;
 }
 
@@ -72,8 +80,8 @@ static __forceinline void IRQ(ULONG& uExecutedCycles, BOOL& flagc, BOOL& flagn,
 {
 }
 
-// From z80.cpp
-DWORD z80_mainloop(ULONG uTotalCycles, ULONG uExecutedCycles)
+// From CPU.cpp
+static __forceinline UINT Z80ExecuteBurst(ULONG uTotalCycles, ULONG uExecutedCycles)
 {
 	return 0;
 }
@@ -91,6 +99,9 @@ void NTSC_VideoUpdateCycles( long cycles6502 )
 #define READ _READ_WITH_IO_F8xx
 #define WRITE(a) _WRITE_WITH_IO_F8xx(a)
 #define HEATMAP_X(pc)
+#define BREAKPOINT_TRAP_X(pc)
+#define TRACE_X(pc)
+#define CYCLE_AUDIT_X(cycles)
 
 #include "../../source/CPU/cpu6502.h"  // MOS 6502
 
@@ -107,6 +118,9 @@ void NTSC_VideoUpdateCycles( long cycles6502 )
 #undef READ
 #undef WRITE
 #undef HEATMAP_X
+#undef BREAKPOINT_TRAP_X
+#undef TRACE_X
+#undef CYCLE_AUDIT_X
 
 //-------------------------------------
 
@@ -119,6 +133,8 @@ void init(void)
 		memwrite[i] = mem+i*256;
 
 	memdirty = new BYTE[256];
+
+	CpuInitDecimalTables();
 }
 
 void reset(void)
@@ -1323,6 +1339,926 @@ int SyncEvents_test(void)
 	return 0;
 }
 
+//-------------------------------------
+// Differential fuzzing
+//
+// RefStep() is a plain, table driven model of the NMOS 6502 (incl. the undocumented opcodes) and of the 65C02 as fitted
+// to the enhanced //e (no Rockwell/WDC bit instructions: all undefined opcodes are NOPs).
+// It's written from the data sheets & 6502.org documents, not from cpu_instructions.inl.
+// Where AppleWin differs from the hardware the model follows AppleWin and says so in an "AppleWin:" comment,
+// so any change in behaviour from an optimisation of Cpu6502()/Cpu65C02() shows up as a mismatch.
+
+enum RefMode_e
+{
+	REF_IMP, REF_ACC, REF_IMM, REF_REL,
+	REF_ZPG, REF_ZPX, REF_ZPY,
+	REF_ABS, REF_ABX, REF_ABY,
+	REF_IND,	// JMP (abs)
+	REF_IAX,	// JMP (abs,X)
+	REF_IZX,	// (zp,X)
+	REF_IZY,	// (zp),Y
+	REF_IZP		// (zp)
+};
+
+// Undocumented NMOS opcodes use the common (VICE) names. AppleWin's names:
+// SLO=ASO, SRE=LSE, DCP=DCM, ISC=INS, SAX=AXS, SBX=SAX, LXA=OAL, ANE=XAA, SHA=AXA, SHX=XAS, SHY=SAY, JAM=HLT
+enum RefOp_e
+{
+	R_ADC, R_AND, R_ASL, R_BCC, R_BCS, R_BEQ, R_BIT, R_BMI, R_BNE, R_BPL, R_BRK, R_BVC, R_BVS, R_CLC,
+	R_CLD, R_CLI, R_CLV, R_CMP, R_CPX, R_CPY, R_DEC, R_DEX, R_DEY, R_EOR, R_INC, R_INX, R_INY, R_JMP,
+	R_JSR, R_LDA, R_LDX, R_LDY, R_LSR, R_NOP, R_ORA, R_PHA, R_PHP, R_PLA, R_PLP, R_ROL, R_ROR, R_RTI,
+	R_RTS, R_SBC, R_SEC, R_SED, R_SEI, R_STA, R_STX, R_STY, R_TAX, R_TAY, R_TSX, R_TXA, R_TXS, R_TYA,
+	// 65C02
+	R_BITI, R_BRA, R_PHX, R_PHY, R_PLX, R_PLY, R_STZ, R_TRB, R_TSB,
+	// NMOS undocumented
+	R_ALR, R_ANC, R_ANE, R_ARR, R_DCP, R_ISC, R_JAM, R_LAS, R_LAX, R_LXA, R_RLA, R_RRA, R_SAX, R_SBX,
+	R_SHA, R_SHX, R_SHY, R_SLO, R_SRE, R_TAS
+};
+
+struct RefOpcode_t
+{
+	BYTE op;
+	BYTE mode;
+	BYTE cycles;
+	BYTE pagecross;	// +1 cycle if indexing crosses a page
+};
+
+#define OP(op,mode,cyc) { R_##op, REF_##mode, cyc, 0 }
+#define PX(op,mode,cyc) { R_##op, REF_##mode, cyc, 1 }
+
+static const RefOpcode_t g_aRefOpcodes6502[256] =
+{
+	// AppleWin: $0C is NOP abs,X (+1 on page cross); the hardware has NOP abs (4 cycles)
+	OP(BRK,IMP,7), OP(ORA,IZX,6), OP(JAM,IMP,2), OP(SLO,IZX,8), OP(NOP,ZPG,3), OP(ORA,ZPG,3), OP(ASL,ZPG,5), OP(SLO,ZPG,5), OP(PHP,IMP,3), OP(ORA,IMM,2), OP(ASL,ACC,2), OP(ANC,IMM,2), PX(NOP,ABX,4), OP(ORA,ABS,4), OP(ASL,ABS,6), OP(SLO,ABS,6),
+	OP(BPL,REL,2), PX(ORA,IZY,5), OP(JAM,IMP,2), OP(SLO,IZY,8), OP(NOP,ZPX,4), OP(ORA,ZPX,4), OP(ASL,ZPX,6), OP(SLO,ZPX,6), OP(CLC,IMP,2), PX(ORA,ABY,4), OP(NOP,IMP,2), OP(SLO,ABY,7), PX(NOP,ABX,4), PX(ORA,ABX,4), OP(ASL,ABX,7), OP(SLO,ABX,7),
+	OP(JSR,ABS,6), OP(AND,IZX,6), OP(JAM,IMP,2), OP(RLA,IZX,8), OP(BIT,ZPG,3), OP(AND,ZPG,3), OP(ROL,ZPG,5), OP(RLA,ZPG,5), OP(PLP,IMP,4), OP(AND,IMM,2), OP(ROL,ACC,2), OP(ANC,IMM,2), OP(BIT,ABS,4), OP(AND,ABS,4), OP(ROL,ABS,6), OP(RLA,ABS,6),
+	OP(BMI,REL,2), PX(AND,IZY,5), OP(JAM,IMP,2), OP(RLA,IZY,8), OP(NOP,ZPX,4), OP(AND,ZPX,4), OP(ROL,ZPX,6), OP(RLA,ZPX,6), OP(SEC,IMP,2), PX(AND,ABY,4), OP(NOP,IMP,2), OP(RLA,ABY,7), PX(NOP,ABX,4), PX(AND,ABX,4), OP(ROL,ABX,7), OP(RLA,ABX,7),
+	OP(RTI,IMP,6), OP(EOR,IZX,6), OP(JAM,IMP,2), OP(SRE,IZX,8), OP(NOP,ZPG,3), OP(EOR,ZPG,3), OP(LSR,ZPG,5), OP(SRE,ZPG,5), OP(PHA,IMP,3), OP(EOR,IMM,2), OP(LSR,ACC,2), OP(ALR,IMM,2), OP(JMP,ABS,3), OP(EOR,ABS,4), OP(LSR,ABS,6), OP(SRE,ABS,6),
+	OP(BVC,REL,2), PX(EOR,IZY,5), OP(JAM,IMP,2), OP(SRE,IZY,8), OP(NOP,ZPX,4), OP(EOR,ZPX,4), OP(LSR,ZPX,6), OP(SRE,ZPX,6), OP(CLI,IMP,2), PX(EOR,ABY,4), OP(NOP,IMP,2), OP(SRE,ABY,7), PX(NOP,ABX,4), PX(EOR,ABX,4), OP(LSR,ABX,7), OP(SRE,ABX,7),
+	OP(RTS,IMP,6), OP(ADC,IZX,6), OP(JAM,IMP,2), OP(RRA,IZX,8), OP(NOP,ZPG,3), OP(ADC,ZPG,3), OP(ROR,ZPG,5), OP(RRA,ZPG,5), OP(PLA,IMP,4), OP(ADC,IMM,2), OP(ROR,ACC,2), OP(ARR,IMM,2), OP(JMP,IND,5), OP(ADC,ABS,4), OP(ROR,ABS,6), OP(RRA,ABS,6),
+	OP(BVS,REL,2), PX(ADC,IZY,5), OP(JAM,IMP,2), OP(RRA,IZY,8), OP(NOP,ZPX,4), OP(ADC,ZPX,4), OP(ROR,ZPX,6), OP(RRA,ZPX,6), OP(SEI,IMP,2), PX(ADC,ABY,4), OP(NOP,IMP,2), OP(RRA,ABY,7), PX(NOP,ABX,4), PX(ADC,ABX,4), OP(ROR,ABX,7), OP(RRA,ABX,7),
+	OP(NOP,IMM,2), OP(STA,IZX,6), OP(NOP,IMM,2), OP(SAX,IZX,6), OP(STY,ZPG,3), OP(STA,ZPG,3), OP(STX,ZPG,3), OP(SAX,ZPG,3), OP(DEY,IMP,2), OP(NOP,IMM,2), OP(TXA,IMP,2), OP(ANE,IMM,2), OP(STY,ABS,4), OP(STA,ABS,4), OP(STX,ABS,4), OP(SAX,ABS,4),
+	OP(BCC,REL,2), OP(STA,IZY,6), OP(JAM,IMP,2), OP(SHA,IZY,6), OP(STY,ZPX,4), OP(STA,ZPX,4), OP(STX,ZPY,4), OP(SAX,ZPY,4), OP(TYA,IMP,2), OP(STA,ABY,5), OP(TXS,IMP,2), OP(TAS,ABY,5), OP(SHY,ABX,5), OP(STA,ABX,5), OP(SHX,ABY,5), OP(SHA,ABY,5),
+	OP(LDY,IMM,2), OP(LDA,IZX,6), OP(LDX,IMM,2), OP(LAX,IZX,6), OP(LDY,ZPG,3), OP(LDA,ZPG,3), OP(LDX,ZPG,3), OP(LAX,ZPG,3), OP(TAY,IMP,2), OP(LDA,IMM,2), OP(TAX,IMP,2), OP(LXA,IMM,2), OP(LDY,ABS,4), OP(LDA,ABS,4), OP(LDX,ABS,4), OP(LAX,ABS,4),
+	OP(BCS,REL,2), PX(LDA,IZY,5), OP(JAM,IMP,2), PX(LAX,IZY,5), OP(LDY,ZPX,4), OP(LDA,ZPX,4), OP(LDX,ZPY,4), OP(LAX,ZPY,4), OP(CLV,IMP,2), PX(LDA,ABY,4), OP(TSX,IMP,2), PX(LAS,ABY,4), PX(LDY,ABX,4), PX(LDA,ABX,4), PX(LDX,ABY,4), PX(LAX,ABY,4),
+	OP(CPY,IMM,2), OP(CMP,IZX,6), OP(NOP,IMM,2), OP(DCP,IZX,8), OP(CPY,ZPG,3), OP(CMP,ZPG,3), OP(DEC,ZPG,5), OP(DCP,ZPG,5), OP(INY,IMP,2), OP(CMP,IMM,2), OP(DEX,IMP,2), OP(SBX,IMM,2), OP(CPY,ABS,4), OP(CMP,ABS,4), OP(DEC,ABS,6), OP(DCP,ABS,6),
+	OP(BNE,REL,2), PX(CMP,IZY,5), OP(JAM,IMP,2), OP(DCP,IZY,8), OP(NOP,ZPX,4), OP(CMP,ZPX,4), OP(DEC,ZPX,6), OP(DCP,ZPX,6), OP(CLD,IMP,2), PX(CMP,ABY,4), OP(NOP,IMP,2), OP(DCP,ABY,7), PX(NOP,ABX,4), PX(CMP,ABX,4), OP(DEC,ABX,7), OP(DCP,ABX,7),
+	OP(CPX,IMM,2), OP(SBC,IZX,6), OP(NOP,IMM,2), OP(ISC,IZX,8), OP(CPX,ZPG,3), OP(SBC,ZPG,3), OP(INC,ZPG,5), OP(ISC,ZPG,5), OP(INX,IMP,2), OP(SBC,IMM,2), OP(NOP,IMP,2), OP(SBC,IMM,2), OP(CPX,ABS,4), OP(SBC,ABS,4), OP(INC,ABS,6), OP(ISC,ABS,6),
+	OP(BEQ,REL,2), PX(SBC,IZY,5), OP(JAM,IMP,2), OP(ISC,IZY,8), OP(NOP,ZPX,4), OP(SBC,ZPX,4), OP(INC,ZPX,6), OP(ISC,ZPX,6), OP(SED,IMP,2), PX(SBC,ABY,4), OP(NOP,IMP,2), OP(ISC,ABY,7), PX(NOP,ABX,4), PX(SBC,ABX,4), OP(INC,ABX,7), OP(ISC,ABX,7),
+};
+
+#define N1 OP(NOP,IMP,1)
+
+static const RefOpcode_t g_aRefOpcodes65C02[256] =
+{
+	OP(BRK,IMP,7), OP(ORA,IZX,6), OP(NOP,IMM,2), N1, OP(TSB,ZPG,5), OP(ORA,ZPG,3), OP(ASL,ZPG,5), N1, OP(PHP,IMP,3), OP(ORA,IMM,2), OP(ASL,ACC,2), N1, OP(TSB,ABS,6), OP(ORA,ABS,4), OP(ASL,ABS,6), N1,
+	OP(BPL,REL,2), PX(ORA,IZY,5), OP(ORA,IZP,5), N1, OP(TRB,ZPG,5), OP(ORA,ZPX,4), OP(ASL,ZPX,6), N1, OP(CLC,IMP,2), PX(ORA,ABY,4), OP(INC,ACC,2), N1, OP(TRB,ABS,6), PX(ORA,ABX,4), PX(ASL,ABX,6), N1,
+	OP(JSR,ABS,6), OP(AND,IZX,6), OP(NOP,IMM,2), N1, OP(BIT,ZPG,3), OP(AND,ZPG,3), OP(ROL,ZPG,5), N1, OP(PLP,IMP,4), OP(AND,IMM,2), OP(ROL,ACC,2), N1, OP(BIT,ABS,4), OP(AND,ABS,4), OP(ROL,ABS,6), N1,
+	OP(BMI,REL,2), PX(AND,IZY,5), OP(AND,IZP,5), N1, OP(BIT,ZPX,4), OP(AND,ZPX,4), OP(ROL,ZPX,6), N1, OP(SEC,IMP,2), PX(AND,ABY,4), OP(DEC,ACC,2), N1, PX(BIT,ABX,4), PX(AND,ABX,4), PX(ROL,ABX,6), N1,
+	OP(RTI,IMP,6), OP(EOR,IZX,6), OP(NOP,IMM,2), N1, OP(NOP,ZPG,3), OP(EOR,ZPG,3), OP(LSR,ZPG,5), N1, OP(PHA,IMP,3), OP(EOR,IMM,2), OP(LSR,ACC,2), N1, OP(JMP,ABS,3), OP(EOR,ABS,4), OP(LSR,ABS,6), N1,
+	OP(BVC,REL,2), PX(EOR,IZY,5), OP(EOR,IZP,5), N1, OP(NOP,ZPX,4), OP(EOR,ZPX,4), OP(LSR,ZPX,6), N1, OP(CLI,IMP,2), PX(EOR,ABY,4), OP(PHY,IMP,3), N1, OP(NOP,ABS,8), PX(EOR,ABX,4), PX(LSR,ABX,6), N1,
+	OP(RTS,IMP,6), OP(ADC,IZX,6), OP(NOP,IMM,2), N1, OP(STZ,ZPG,3), OP(ADC,ZPG,3), OP(ROR,ZPG,5), N1, OP(PLA,IMP,4), OP(ADC,IMM,2), OP(ROR,ACC,2), N1, OP(JMP,IND,6), OP(ADC,ABS,4), OP(ROR,ABS,6), N1,
+	OP(BVS,REL,2), PX(ADC,IZY,5), OP(ADC,IZP,5), N1, OP(STZ,ZPX,4), OP(ADC,ZPX,4), OP(ROR,ZPX,6), N1, OP(SEI,IMP,2), PX(ADC,ABY,4), OP(PLY,IMP,4), N1, OP(JMP,IAX,6), PX(ADC,ABX,4), PX(ROR,ABX,6), N1,
+	OP(BRA,REL,2), OP(STA,IZX,6), OP(NOP,IMM,2), N1, OP(STY,ZPG,3), OP(STA,ZPG,3), OP(STX,ZPG,3), N1, OP(DEY,IMP,2), OP(BITI,IMM,2), OP(TXA,IMP,2), N1, OP(STY,ABS,4), OP(STA,ABS,4), OP(STX,ABS,4), N1,
+	OP(BCC,REL,2), OP(STA,IZY,6), OP(STA,IZP,5), N1, OP(STY,ZPX,4), OP(STA,ZPX,4), OP(STX,ZPY,4), N1, OP(TYA,IMP,2), OP(STA,ABY,5), OP(TXS,IMP,2), N1, OP(STZ,ABS,4), OP(STA,ABX,5), OP(STZ,ABX,5), N1,
+	OP(LDY,IMM,2), OP(LDA,IZX,6), OP(LDX,IMM,2), N1, OP(LDY,ZPG,3), OP(LDA,ZPG,3), OP(LDX,ZPG,3), N1, OP(TAY,IMP,2), OP(LDA,IMM,2), OP(TAX,IMP,2), N1, OP(LDY,ABS,4), OP(LDA,ABS,4), OP(LDX,ABS,4), N1,
+	OP(BCS,REL,2), PX(LDA,IZY,5), OP(LDA,IZP,5), N1, OP(LDY,ZPX,4), OP(LDA,ZPX,4), OP(LDX,ZPY,4), N1, OP(CLV,IMP,2), PX(LDA,ABY,4), OP(TSX,IMP,2), N1, PX(LDY,ABX,4), PX(LDA,ABX,4), PX(LDX,ABY,4), N1,
+	OP(CPY,IMM,2), OP(CMP,IZX,6), OP(NOP,IMM,2), N1, OP(CPY,ZPG,3), OP(CMP,ZPG,3), OP(DEC,ZPG,5), N1, OP(INY,IMP,2), OP(CMP,IMM,2), OP(DEX,IMP,2), N1, OP(CPY,ABS,4), OP(CMP,ABS,4), OP(DEC,ABS,6), N1,
+	OP(BNE,REL,2), PX(CMP,IZY,5), OP(CMP,IZP,5), N1, OP(NOP,ZPX,4), OP(CMP,ZPX,4), OP(DEC,ZPX,6), N1, OP(CLD,IMP,2), PX(CMP,ABY,4), OP(PHX,IMP,3), N1, OP(NOP,ABS,4), PX(CMP,ABX,4), OP(DEC,ABX,7), N1,
+	OP(CPX,IMM,2), OP(SBC,IZX,6), OP(NOP,IMM,2), N1, OP(CPX,ZPG,3), OP(SBC,ZPG,3), OP(INC,ZPG,5), N1, OP(INX,IMP,2), OP(SBC,IMM,2), OP(NOP,IMP,2), N1, OP(CPX,ABS,4), OP(SBC,ABS,4), OP(INC,ABS,6), N1,
+	OP(BEQ,REL,2), PX(SBC,IZY,5), OP(SBC,IZP,5), N1, OP(NOP,ZPX,4), OP(SBC,ZPX,4), OP(INC,ZPX,6), N1, OP(SED,IMP,2), PX(SBC,ABY,4), OP(PLX,IMP,4), N1, OP(NOP,ABS,4), PX(SBC,ABX,4), OP(INC,ABX,7), N1,
+};
+
+#undef N1
+#undef OP
+#undef PX
+
+struct RefCpu_t
+{
+	bool   bCMOS;
+	BYTE   a, x, y, s, p;
+	WORD   pc;
+	bool   bJammed;
+	UINT   uCycles;
+	LPBYTE pMem;			// own copy of the 64K
+	BYTE   aDirty[256];		// pages written
+};
+
+// What the fuzzer's I/O handlers return for a read of $C000..$CFFF
+static BYTE FuzzIOValue(WORD addr)
+{
+	return (BYTE)((addr * 0x9D) ^ (addr >> 8));
+}
+
+static BYTE RefRead(RefCpu_t& cpu, const WORD addr)
+{
+	if ((addr & 0xF000) == 0xC000)
+		return FuzzIOValue(addr);
+	return cpu.pMem[addr];
+}
+
+static void RefWrite(RefCpu_t& cpu, const WORD addr, const BYTE value)
+{
+	if ((addr & 0xF000) == 0xC000)	// I/O space has no memory behind it
+		return;
+	cpu.pMem[addr] = value;
+	cpu.aDirty[addr >> 8] = 1;
+}
+
+static WORD RefPeek16(RefCpu_t& cpu, const WORD addr)
+{
+	return cpu.pMem[addr] | (cpu.pMem[(WORD)(addr+1)] << 8);
+}
+
+static WORD RefPeek16ZP(RefCpu_t& cpu, const BYTE zp)
+{
+	return cpu.pMem[zp] | (cpu.pMem[(BYTE)(zp+1)] << 8);
+}
+
+static void RefPush(RefCpu_t& cpu, const BYTE value)
+{
+	cpu.pMem[0x100 | cpu.s--] = value;
+	cpu.aDirty[1] = 1;
+}
+
+static BYTE RefPop(RefCpu_t& cpu)
+{
+	return cpu.pMem[0x100 | ++cpu.s];
+}
+
+static void RefSetFlag(RefCpu_t& cpu, const BYTE flag, const bool bSet)
+{
+	cpu.p = bSet ? (cpu.p | flag) : (cpu.p & ~flag);
+}
+
+static void RefSetNZ(RefCpu_t& cpu, const BYTE value)
+{
+	RefSetFlag(cpu, AF_SIGN, (value & 0x80) != 0);
+	RefSetFlag(cpu, AF_ZERO, value == 0);
+}
+
+static void RefCompare(RefCpu_t& cpu, const BYTE reg, const BYTE value)
+{
+	RefSetFlag(cpu, AF_CARRY, reg >= value);
+	RefSetNZ(cpu, (BYTE)(reg - value));
+}
+
+// Decimal mode per Bruce Clark's "Decimal Mode" tutorial (6502.org), Appendix A:
+// . NMOS: A and C are the BCD result, Z is from the binary sum, N and V from the intermediate result (seq.2)
+// . 65C02: A and C as NMOS, N and Z are valid, V as NMOS, and it takes 1 extra cycle
+static void RefAdc(RefCpu_t& cpu, const BYTE value)
+{
+	const int a = cpu.a;
+	const int c = cpu.p & AF_CARRY;
+	const int sum = a + value + c;
+
+	if (!(cpu.p & AF_DECIMAL))
+	{
+		RefSetFlag(cpu, AF_CARRY, sum > 0xFF);
+		RefSetFlag(cpu, AF_OVERFLOW, (~(a ^ value) & (a ^ sum) & 0x80) != 0);
+		cpu.a = (BYTE)sum;
+		RefSetNZ(cpu, cpu.a);
+		return;
+	}
+
+	int lo = (a & 0x0F) + (value & 0x0F) + c;
+	if (lo >= 0x0A)
+		lo = ((lo + 0x06) & 0x0F) + 0x10;
+
+	int result = (a & 0xF0) + (value & 0xF0) + lo;
+	const int seq2 = (signed char)(a & 0xF0) + (signed char)(value & 0xF0) + lo;
+	if (result >= 0xA0)
+		result += 0x60;
+
+	cpu.a = (BYTE)result;
+	RefSetFlag(cpu, AF_CARRY, result >= 0x100);
+	RefSetFlag(cpu, AF_OVERFLOW, seq2 < -128 || seq2 > 127);
+
+	if (cpu.bCMOS)
+	{
+		RefSetNZ(cpu, cpu.a);
+		cpu.uCycles++;
+	}
+	else
+	{
+		RefSetFlag(cpu, AF_ZERO, (sum & 0xFF) == 0);
+		RefSetFlag(cpu, AF_SIGN, (seq2 & 0x80) != 0);
+	}
+}
+
+// . NMOS: only A is decimal, all flags are from the binary subtraction
+// . 65C02: N and Z are valid, and it takes 1 extra cycle
+static void RefSbc(RefCpu_t& cpu, const BYTE value)
+{
+	const int a = cpu.a;
+	const int c = cpu.p & AF_CARRY;
+	const int diff = a - value - (1 - c);
+
+	RefSetFlag(cpu, AF_CARRY, diff >= 0);
+	RefSetFlag(cpu, AF_OVERFLOW, ((a ^ value) & (a ^ diff) & 0x80) != 0);
+
+	if (!(cpu.p & AF_DECIMAL))
+	{
+		cpu.a = (BYTE)diff;
+		RefSetNZ(cpu, cpu.a);
+		return;
+	}
+
+	int lo = (a & 0x0F) - (value & 0x0F) + c - 1;
+
+	if (!cpu.bCMOS)
+	{
+		if (lo < 0)
+			lo = ((lo - 0x06) & 0x0F) - 0x10;
+		int result = (a & 0xF0) - (value & 0xF0) + lo;
+		if (result < 0)
+			result -= 0x60;
+		cpu.a = (BYTE)result;
+		RefSetNZ(cpu, (BYTE)diff);
+	}
+	else
+	{
+		int result = diff;
+		if (result < 0)
+			result -= 0x60;
+		if (lo < 0)
+			result -= 0x06;
+		cpu.a = (BYTE)result;
+		RefSetNZ(cpu, cpu.a);
+		cpu.uCycles++;
+	}
+}
+
+// NMOS ARR: AND, then ROR A with odd flags. In decimal mode the nibbles are then fixed up (see VICE)
+static void RefArr(RefCpu_t& cpu, const BYTE value)
+{
+	const BYTE t = cpu.a & value;
+	const BYTE carry = (cpu.p & AF_CARRY) ? 0x80 : 0x00;
+	BYTE result = (t >> 1) | carry;
+
+	if (!(cpu.p & AF_DECIMAL))
+	{
+		RefSetNZ(cpu, result);
+		RefSetFlag(cpu, AF_CARRY, (result & 0x40) != 0);
+		RefSetFlag(cpu, AF_OVERFLOW, ((result ^ (result << 1)) & 0x40) != 0);
+		cpu.a = result;
+		return;
+	}
+
+	RefSetFlag(cpu, AF_SIGN, carry != 0);
+	RefSetFlag(cpu, AF_ZERO, result == 0);
+	RefSetFlag(cpu, AF_OVERFLOW, ((t ^ result) & 0x40) != 0);
+	if ((t & 0x0F) + (t & 0x01) > 0x05)
+		result = (result & 0xF0) | ((result + 0x06) & 0x0F);
+	const bool bHighFix = (t & 0xF0) + (t & 0x10) > 0x50;
+	if (bHighFix)
+		result = (result & 0x0F) | ((result + 0x60) & 0xF0);
+	RefSetFlag(cpu, AF_CARRY, bHighFix);
+	cpu.a = result;
+}
+
+// Execute one instruction
+static void RefStep(RefCpu_t& cpu)
+{
+	const WORD pc = cpu.pc;
+	const BYTE opcode = cpu.pMem[cpu.pc++];
+	const RefOpcode_t& op = cpu.bCMOS ? g_aRefOpcodes65C02[opcode] : g_aRefOpcodes6502[opcode];
+
+	cpu.uCycles += op.cycles;
+	cpu.p |= AF_RESERVED | AF_BREAK;
+
+	// Effective address
+
+	WORD base = 0;
+	WORD addr = 0;
+
+	switch (op.mode)
+	{
+	case REF_IMP:
+	case REF_ACC:
+		break;
+	case REF_IMM:
+		addr = cpu.pc++;
+		break;
+	case REF_REL:
+		{
+			const signed char offset = (signed char) cpu.pMem[cpu.pc++];
+			addr = (WORD)(cpu.pc + offset);
+		}
+		break;
+	case REF_ZPG:
+		addr = cpu.pMem[cpu.pc++];
+		break;
+	case REF_ZPX:
+		addr = (BYTE)(cpu.pMem[cpu.pc++] + cpu.x);
+		break;
+	case REF_ZPY:
+		addr = (BYTE)(cpu.pMem[cpu.pc++] + cpu.y);
+		break;
+	case REF_ABS:
+		addr = RefPeek16(cpu, cpu.pc);
+		cpu.pc += 2;
+		break;
+	case REF_ABX:
+		base = RefPeek16(cpu, cpu.pc);
+		addr = base + cpu.x;
+		cpu.pc += 2;
+		break;
+	case REF_ABY:
+		base = RefPeek16(cpu, cpu.pc);
+		addr = base + cpu.y;
+		cpu.pc += 2;
+		break;
+	case REF_IND:
+		base = RefPeek16(cpu, cpu.pc);
+		cpu.pc += 2;
+		if (!cpu.bCMOS)
+		{
+			// NMOS: the pointer's high byte is fetched without a carry into the page
+			addr = cpu.pMem[base] | (cpu.pMem[(base & 0xFF00) | (BYTE)(base+1)] << 8);
+		}
+		else
+		{
+			addr = RefPeek16(cpu, base);
+			// AppleWin: +1 cycle if the pointer is at $xxFF; the hardware always takes 6
+			if ((base & 0xFF) == 0xFF)
+				cpu.uCycles++;
+		}
+		break;
+	case REF_IAX:
+		addr = RefPeek16(cpu, RefPeek16(cpu, cpu.pc) + cpu.x);
+		cpu.pc += 2;
+		break;
+	case REF_IZX:
+		addr = RefPeek16ZP(cpu, (BYTE)(cpu.pMem[cpu.pc++] + cpu.x));
+		break;
+	case REF_IZY:
+		base = RefPeek16ZP(cpu, cpu.pMem[cpu.pc++]);
+		addr = base + cpu.y;
+		break;
+	case REF_IZP:
+		addr = RefPeek16ZP(cpu, cpu.pMem[cpu.pc++]);
+		break;
+	}
+
+	const bool bPageCross = ((base ^ addr) & 0xFF00) && (op.mode == REF_ABX || op.mode == REF_ABY || op.mode == REF_IZY);
+	if (op.pagecross && bPageCross)
+		cpu.uCycles++;
+
+	bool bBranch = false;
+
+	switch (op.op)
+	{
+	// Loads, logic & arithmetic
+
+	case R_LDA: cpu.a = RefRead(cpu, addr); RefSetNZ(cpu, cpu.a); break;
+	case R_LDX: cpu.x = RefRead(cpu, addr); RefSetNZ(cpu, cpu.x); break;
+	case R_LDY: cpu.y = RefRead(cpu, addr); RefSetNZ(cpu, cpu.y); break;
+	case R_LAX: cpu.a = cpu.x = RefRead(cpu, addr); RefSetNZ(cpu, cpu.a); break;
+	case R_AND: cpu.a &= RefRead(cpu, addr); RefSetNZ(cpu, cpu.a); break;
+	case R_ORA: cpu.a |= RefRead(cpu, addr); RefSetNZ(cpu, cpu.a); break;
+	case R_EOR: cpu.a ^= RefRead(cpu, addr); RefSetNZ(cpu, cpu.a); break;
+	case R_ADC: RefAdc(cpu, RefRead(cpu, addr)); break;
+	case R_SBC: RefSbc(cpu, RefRead(cpu, addr)); break;
+	case R_CMP: RefCompare(cpu, cpu.a, RefRead(cpu, addr)); break;
+	case R_CPX: RefCompare(cpu, cpu.x, RefRead(cpu, addr)); break;
+	case R_CPY: RefCompare(cpu, cpu.y, RefRead(cpu, addr)); break;
+	case R_BIT:
+		{
+			const BYTE value = RefRead(cpu, addr);
+			RefSetFlag(cpu, AF_ZERO, !(cpu.a & value));
+			RefSetFlag(cpu, AF_SIGN, (value & 0x80) != 0);
+			RefSetFlag(cpu, AF_OVERFLOW, (value & 0x40) != 0);
+		}
+		break;
+	case R_BITI: RefSetFlag(cpu, AF_ZERO, !(cpu.a & RefRead(cpu, addr))); break;
+
+	// Stores
+
+	case R_STA: RefWrite(cpu, addr, cpu.a); break;
+	case R_STX: RefWrite(cpu, addr, cpu.x); break;
+	case R_STY: RefWrite(cpu, addr, cpu.y); break;
+	case R_STZ: RefWrite(cpu, addr, 0); break;
+	case R_SAX: RefWrite(cpu, addr, cpu.a & cpu.x); break;
+
+	// Read-modify-write
+
+	case R_ASL: case R_LSR: case R_ROL: case R_ROR: case R_INC: case R_DEC: case R_TSB: case R_TRB:
+	case R_SLO: case R_SRE: case R_RLA: case R_RRA: case R_DCP: case R_ISC:
+		{
+			BYTE value = (op.mode == REF_ACC) ? cpu.a : RefRead(cpu, addr);
+			const BYTE carry = (cpu.p & AF_CARRY);
+
+			switch (op.op)
+			{
+			case R_ASL: case R_SLO: RefSetFlag(cpu, AF_CARRY, (value & 0x80) != 0); value <<= 1; break;
+			case R_LSR: case R_SRE: RefSetFlag(cpu, AF_CARRY, (value & 0x01) != 0); value >>= 1; break;
+			case R_ROL: case R_RLA: RefSetFlag(cpu, AF_CARRY, (value & 0x80) != 0); value = (value << 1) | carry; break;
+			case R_ROR: case R_RRA: RefSetFlag(cpu, AF_CARRY, (value & 0x01) != 0); value = (value >> 1) | (carry << 7); break;
+			case R_INC: case R_ISC: value++; break;
+			case R_DEC: case R_DCP: value--; break;
+			case R_TSB: RefSetFlag(cpu, AF_ZERO, !(cpu.a & value)); value |= cpu.a; break;
+			case R_TRB: RefSetFlag(cpu, AF_ZERO, !(cpu.a & value)); value &= ~cpu.a; break;
+			}
+
+			if (op.mode == REF_ACC)
+				cpu.a = value;
+			else
+				RefWrite(cpu, addr, value);
+
+			switch (op.op)
+			{
+			case R_ASL: case R_LSR: case R_ROL: case R_ROR: case R_INC: case R_DEC: RefSetNZ(cpu, value); break;
+			case R_SLO: cpu.a |= value; RefSetNZ(cpu, cpu.a); break;
+			case R_SRE: cpu.a ^= value; RefSetNZ(cpu, cpu.a); break;
+			case R_RLA: cpu.a &= value; RefSetNZ(cpu, cpu.a); break;
+			case R_RRA: RefAdc(cpu, value); break;
+			case R_DCP: RefCompare(cpu, cpu.a, value); break;
+			case R_ISC: RefSbc(cpu, value); break;
+			}
+		}
+		break;
+
+	// Branches & jumps
+
+	case R_BPL: bBranch = !(cpu.p & AF_SIGN); break;
+	case R_BMI: bBranch = (cpu.p & AF_SIGN) != 0; break;
+	case R_BVC: bBranch = !(cpu.p & AF_OVERFLOW); break;
+	case R_BVS: bBranch = (cpu.p & AF_OVERFLOW) != 0; break;
+	case R_BCC: bBranch = !(cpu.p & AF_CARRY); break;
+	case R_BCS: bBranch = (cpu.p & AF_CARRY) != 0; break;
+	case R_BNE: bBranch = !(cpu.p & AF_ZERO); break;
+	case R_BEQ: bBranch = (cpu.p & AF_ZERO) != 0; break;
+	case R_BRA: bBranch = true; break;
+
+	case R_JMP: cpu.pc = addr; break;
+	case R_JSR:
+		RefPush(cpu, (cpu.pc - 1) >> 8);
+		RefPush(cpu, (cpu.pc - 1) & 0xFF);
+		cpu.pc = addr;
+		break;
+	case R_RTS:
+		cpu.pc = RefPop(cpu);
+		cpu.pc |= RefPop(cpu) << 8;
+		cpu.pc++;
+		break;
+	case R_RTI:
+		cpu.p = RefPop(cpu) | AF_RESERVED | AF_BREAK;
+		cpu.pc = RefPop(cpu);
+		cpu.pc |= RefPop(cpu) << 8;
+		break;
+	case R_BRK:
+		cpu.pc++;	// signature byte
+		RefPush(cpu, cpu.pc >> 8);
+		RefPush(cpu, cpu.pc & 0xFF);
+		RefPush(cpu, cpu.p);
+		cpu.p |= AF_INTERRUPT;	// AppleWin: the 65C02 doesn't clear D, the hardware does
+		cpu.pc = RefPeek16(cpu, 0xFFFE);
+		break;
+
+	// Stack, flags & registers
+
+	case R_PHA: RefPush(cpu, cpu.a); break;
+	case R_PHX: RefPush(cpu, cpu.x); break;
+	case R_PHY: RefPush(cpu, cpu.y); break;
+	case R_PHP: RefPush(cpu, cpu.p); break;
+	case R_PLA: cpu.a = RefPop(cpu); RefSetNZ(cpu, cpu.a); break;
+	case R_PLX: cpu.x = RefPop(cpu); RefSetNZ(cpu, cpu.x); break;
+	case R_PLY: cpu.y = RefPop(cpu); RefSetNZ(cpu, cpu.y); break;
+	case R_PLP: cpu.p = RefPop(cpu) | AF_RESERVED | AF_BREAK; break;
+
+	case R_CLC: cpu.p &= ~AF_CARRY; break;
+	case R_CLD: cpu.p &= ~AF_DECIMAL; break;
+	case R_CLI: cpu.p &= ~AF_INTERRUPT; break;
+	case R_CLV: cpu.p &= ~AF_OVERFLOW; break;
+	case R_SEC: cpu.p |= AF_CARRY; break;
+	case R_SED: cpu.p |= AF_DECIMAL; break;
+	case R_SEI: cpu.p |= AF_INTERRUPT; break;
+
+	case R_TAX: cpu.x = cpu.a; RefSetNZ(cpu, cpu.x); break;
+	case R_TAY: cpu.y = cpu.a; RefSetNZ(cpu, cpu.y); break;
+	case R_TXA: cpu.a = cpu.x; RefSetNZ(cpu, cpu.a); break;
+	case R_TYA: cpu.a = cpu.y; RefSetNZ(cpu, cpu.a); break;
+	case R_TSX: cpu.x = cpu.s; RefSetNZ(cpu, cpu.x); break;
+	case R_TXS: cpu.s = cpu.x; break;
+	case R_INX: cpu.x++; RefSetNZ(cpu, cpu.x); break;
+	case R_INY: cpu.y++; RefSetNZ(cpu, cpu.y); break;
+	case R_DEX: cpu.x--; RefSetNZ(cpu, cpu.x); break;
+	case R_DEY: cpu.y--; RefSetNZ(cpu, cpu.y); break;
+
+	case R_NOP: break;
+
+	// NMOS undocumented
+
+	case R_ANC:
+		cpu.a &= RefRead(cpu, addr);
+		RefSetNZ(cpu, cpu.a);
+		RefSetFlag(cpu, AF_CARRY, (cpu.a & 0x80) != 0);
+		break;
+	case R_ALR:
+		cpu.a &= RefRead(cpu, addr);
+		RefSetFlag(cpu, AF_CARRY, (cpu.a & 0x01) != 0);
+		cpu.a >>= 1;
+		RefSetNZ(cpu, cpu.a);
+		break;
+	case R_ARR:
+		RefArr(cpu, RefRead(cpu, addr));
+		break;
+	case R_ANE:	// A = (A | magic) & X & imm. AppleWin: magic = $FF
+		cpu.a = cpu.x & RefRead(cpu, addr);
+		RefSetNZ(cpu, cpu.a);
+		break;
+	case R_LXA:	// magic = $EE
+		cpu.a = cpu.x = (cpu.a | 0xEE) & RefRead(cpu, addr);
+		RefSetNZ(cpu, cpu.a);
+		break;
+	case R_SBX:
+		{
+			const BYTE value = RefRead(cpu, addr);
+			const BYTE t = cpu.a & cpu.x;
+			RefSetFlag(cpu, AF_CARRY, t >= value);
+			cpu.x = t - value;
+			RefSetNZ(cpu, cpu.x);
+		}
+		break;
+	case R_LAS:
+		cpu.a = cpu.x = cpu.s = RefRead(cpu, addr) & cpu.s;
+		RefSetNZ(cpu, cpu.a);
+		break;
+	case R_SHA: case R_SHX: case R_SHY: case R_TAS:
+		{
+			// Stored value is ANDed with the base address's high byte + 1; on a page cross that value also becomes the high byte
+			BYTE value = 0;
+			switch (op.op)
+			{
+			case R_SHA: value = cpu.a & cpu.x; break;
+			case R_SHX: value = cpu.x; break;
+			case R_SHY: value = cpu.y; break;
+			case R_TAS: value = cpu.s = cpu.a & cpu.x; break;
+			}
+			value &= (base >> 8) + 1;
+			if (bPageCross)
+				addr = (value << 8) | (addr & 0xFF);
+			RefWrite(cpu, addr, value);
+		}
+		break;
+	case R_JAM:	// AppleWin: takes 2 cycles and stays on the opcode
+		cpu.bJammed = true;
+		cpu.pc = pc;
+		break;
+	}
+
+	if (bBranch)
+	{
+		cpu.uCycles += ((cpu.pc ^ addr) & 0xFF00) ? 2 : 1;
+		cpu.pc = addr;
+	}
+}
+
+//-------------------------------------
+
+static UINT g_uFuzzSeed = 0x6502;
+
+static UINT FuzzRand(void)
+{
+	// xorshift32: same sequence on every platform
+	g_uFuzzSeed ^= g_uFuzzSeed << 13;
+	g_uFuzzSeed ^= g_uFuzzSeed >> 17;
+	g_uFuzzSeed ^= g_uFuzzSeed << 5;
+	return g_uFuzzSeed;
+}
+
+static BYTE __stdcall FuzzIO(WORD programcounter, WORD address, BYTE write, BYTE value, ULONG nCycles)
+{
+	return write ? 0 : FuzzIOValue(address);
+}
+
+static DWORD TestCpu(const eCpuType cpu, DWORD uTotalCycles)
+{
+	return (cpu == CPU_6502) ? TestCpu6502(uTotalCycles) : TestCpu65C02(uTotalCycles);
+}
+
+static const char* CpuName(const eCpuType cpu)
+{
+	return (cpu == CPU_6502) ? "6502" : "65C02";
+}
+
+static void RefFromRegs(RefCpu_t& ref, const eCpuType cpu)
+{
+	ref.bCMOS   = (cpu != CPU_6502);
+	ref.a       = regs.a;
+	ref.x       = regs.x;
+	ref.y       = regs.y;
+	ref.s       = regs.sp & 0xFF;
+	ref.p       = regs.ps;
+	ref.pc      = regs.pc;
+	ref.bJammed = regs.bJammed != 0;
+	ref.uCycles = 0;
+}
+
+// Decimal mode ADC # and SBC #, for every A, operand and carry, are compared with the reference model
+int Decimal_test(const eCpuType cpu)
+{
+	const BYTE opcodes[] = {0x69, 0xE9};	// ADC #, SBC #
+	const BYTE flags = AF_SIGN | AF_OVERFLOW | AF_ZERO | AF_CARRY;
+
+	for (UINT i = 0; i<sizeof(opcodes); i++)
+	{
+		for (UINT carry = 0; carry < 2; carry++)
+		for (UINT a = 0; a < 0x100; a++)
+		for (UINT value = 0; value < 0x100; value++)
+		{
+			reset();
+			regs.a = a;
+			regs.ps = AF_DECIMAL | (carry ? AF_CARRY : 0);
+			mem[regs.pc+0] = opcodes[i];
+			mem[regs.pc+1] = value;
+
+			RefCpu_t ref;
+			RefFromRegs(ref, cpu);
+			if (opcodes[i] == 0x69)
+				RefAdc(ref, value);
+			else
+				RefSbc(ref, value);
+
+			TestCpu(cpu, 0);
+
+			if (regs.a != ref.a || (regs.ps & flags) != (ref.p & flags))
+			{
+				printf("Decimal %s: %s A=%02X #%02X C=%u: A=%02X P=%02X, expected A=%02X P=%02X\n",
+					CpuName(cpu), (opcodes[i] == 0x69) ? "ADC" : "SBC", a, value, carry,
+					regs.a, regs.ps & flags, ref.a, ref.p & flags);
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+// Each opcode is run uIterations times from random registers and memory (half in decimal mode),
+// then registers, flags, cycles and all written memory are compared with the reference model
+int CpuFuzz_test(const eCpuType cpu, const UINT uIterations)
+{
+	iofunction aIORead[256], aIOWrite[256];
+	memcpy(aIORead, IORead, sizeof(IORead));
+	memcpy(aIOWrite, IOWrite, sizeof(IOWrite));
+	for (UINT i=0; i<256; i++)
+	{
+		IORead[i] = FuzzIO;
+		IOWrite[i] = FuzzIO;
+	}
+	for (UINT i=0xC0; i<0xD0; i++)
+		memwrite[i] = NULL;		// write to $C000..$CFFF goes to IOWrite[]
+
+	for (UINT i=0; i<0x10000; i+=4)
+	{
+		const UINT r = FuzzRand();
+		memcpy(mem+i, &r, 4);
+	}
+
+	RefCpu_t ref;
+	ref.pMem = new BYTE[0x10000];
+	memcpy(ref.pMem, mem, 0x10000);
+
+	UINT uMismatches = 0;
+
+	for (UINT opcode=0; opcode<256; opcode++)
+	{
+		bool bReported = false;
+
+		for (UINT i=0; i<uIterations; i++)
+		{
+			// Zero page & stack hold the pointers and return addresses, so re-randomise them
+			for (UINT j=0; j<0x200; j+=4)
+			{
+				const UINT r = FuzzRand();
+				memcpy(mem+j, &r, 4);
+			}
+			memcpy(ref.pMem, mem, 0x200);
+
+			const UINT r = FuzzRand();
+			const WORD pc = 0x200 + (FuzzRand() % (0xC000-0x200-3));
+			mem[pc+0] = opcode;
+			mem[pc+1] = r & 0xFF;
+			mem[pc+2] = (r >> 8) & 0xFF;
+			if ((opcode == 0x6C || opcode == 0x7C) && mem[pc+2] == 0xFF)
+				mem[pc+2] = 0xFE;	// AppleWin: JMP (abs) and (abs,X) don't wrap the pointer at $FFFF
+			memcpy(ref.pMem+pc, mem+pc, 3);
+
+			const UINT r2 = FuzzRand();
+			regs.a  = (r >> 16) & 0xFF;
+			regs.x  = (r >> 24) & 0xFF;
+			regs.y  = r2 & 0xFF;
+			regs.sp = 0x100 | ((r2 >> 8) & 0xFF);
+			regs.ps = (((r2 >> 16) & 0xFF) & ~AF_DECIMAL) | ((i & 1) ? AF_DECIMAL : 0);
+			regs.pc = pc;
+			regs.bJammed = 0;
+
+			RefFromRegs(ref, cpu);
+			const struct regsrec initial = regs;
+
+			memset(memdirty, 0, 256);
+			memset(ref.aDirty, 0, sizeof(ref.aDirty));
+			ref.aDirty[0] = ref.aDirty[1] = 1;
+
+			const DWORD cycles = TestCpu(cpu, 0);
+			RefStep(ref);
+
+			bool bMismatch = regs.a != ref.a || regs.x != ref.x || regs.y != ref.y || regs.ps != ref.p
+				|| regs.sp != (0x100 | ref.s) || regs.pc != ref.pc || (regs.bJammed != 0) != ref.bJammed
+				|| cycles != ref.uCycles;
+
+			int mismatchAddr = -1;
+			for (UINT page=0; page<256; page++)
+			{
+				if (!memdirty[page] && !ref.aDirty[page])
+					continue;
+				if (!bMismatch && memcmp(mem+page*256, ref.pMem+page*256, 256) != 0)
+				{
+					bMismatch = true;
+					for (mismatchAddr = page*256; mem[mismatchAddr] == ref.pMem[mismatchAddr]; mismatchAddr++)
+						;
+				}
+				memcpy(ref.pMem+page*256, mem+page*256, 256);	// resync
+			}
+
+			if (!bMismatch)
+				continue;
+
+			uMismatches++;
+			if (bReported)
+				continue;
+			bReported = true;
+
+			printf("Fuzz %s: mismatch for opcode $%02X %02X %02X (A=%02X X=%02X Y=%02X P=%02X S=%02X PC=%04X)\n",
+				CpuName(cpu), opcode, mem[pc+1], mem[pc+2], initial.a, initial.x, initial.y, initial.ps, initial.sp & 0xFF, initial.pc);
+			printf("  AppleWin : A=%02X X=%02X Y=%02X P=%02X S=%02X PC=%04X cycles=%u\n",
+				regs.a, regs.x, regs.y, regs.ps, regs.sp & 0xFF, regs.pc, (UINT)cycles);
+			printf("  Reference: A=%02X X=%02X Y=%02X P=%02X S=%02X PC=%04X cycles=%u\n",
+				ref.a, ref.x, ref.y, ref.p, ref.s, ref.pc, ref.uCycles);
+			if (mismatchAddr >= 0)
+				printf("  Memory differs at $%04X\n", mismatchAddr);
+		}
+	}
+
+	printf("Fuzz %s: %u opcodes x %u iterations, %u mismatches\n", CpuName(cpu), 256, uIterations, uMismatches);
+
+	delete [] ref.pMem;
+
+	memcpy(IORead, aIORead, sizeof(IORead));
+	memcpy(IOWrite, aIOWrite, sizeof(IOWrite));
+	for (UINT i=0xC0; i<0xD0; i++)
+		memwrite[i] = mem+i*256;
+
+	memset(mem, 0, 0x10000);
+	reset();
+
+	return uMismatches ? 1 : 0;
+}
+
+//-------------------------------------
+// Throughput
+
+// Loop of indexed loads/stores/RMW, (zp),Y, stack, JSR/RTS and branches
+static const BYTE g_aBenchmarkCode[] =
+{
+	0xA2, 0x00,			// 0300: LDX #$00
+	0xA0, 0x00,			// 0302: LDY #$00
+	0xBD, 0x00, 0x10,	// 0304: LDA $1000,X
+	0x7D, 0x00, 0x11,	// 0307: ADC $1100,X
+	0x9D, 0x00, 0x12,	// 030A: STA $1200,X
+	0x5E, 0x00, 0x13,	// 030D: LSR $1300,X
+	0xB1, 0x06,			// 0310: LDA ($06),Y
+	0x91, 0x08,			// 0312: STA ($08),Y
+	0x48,				// 0314: PHA
+	0x20, 0x20, 0x03,	// 0315: JSR $0320
+	0x68,				// 0318: PLA
+	0xC8,				// 0319: INY
+	0xE8,				// 031A: INX
+	0xD0, 0xE7,			// 031B: BNE $0304
+	0x4C, 0x00, 0x03,	// 031D: JMP $0300
+	0xE6, 0x0A,			// 0320: INC $0A
+	0x60,				// 0322: RTS
+};
+
+// Reports instructions/s and the emulated clock rate of Cpu6502()/Cpu65C02(), when run in slices like the emulator does
+void CpuBenchmark(const eCpuType cpu, const UINT uMegaCycles)
+{
+	memset(mem, 0, 0x10000);
+	memcpy(mem+0x300, g_aBenchmarkCode, sizeof(g_aBenchmarkCode));
+	mem[0x06] = 0x00; mem[0x07] = 0x14;
+	mem[0x08] = 0x00; mem[0x09] = 0x15;
+	reset();
+
+	// The instruction count comes from the reference model, run from the same state for the same number of cycles
+	RefCpu_t ref;
+	ref.pMem = new BYTE[0x10000];
+	memcpy(ref.pMem, mem, 0x10000);
+	RefFromRegs(ref, cpu);
+
+	const DWORD kSliceCycles = 1000;	// ~1ms of emulated time
+	const DWORD uTotalCycles = uMegaCycles * 1000000;
+	DWORD uCycles = 0;
+
+	LARGE_INTEGER freq, start, end;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&start);
+
+	while (uCycles < uTotalCycles)
+		uCycles += TestCpu(cpu, kSliceCycles);
+
+	QueryPerformanceCounter(&end);
+
+	unsigned __int64 nInstructions = 0;
+	while (ref.uCycles < uCycles)
+	{
+		RefStep(ref);
+		nInstructions++;
+	}
+	delete [] ref.pMem;
+
+	const double fSeconds = (double)(end.QuadPart - start.QuadPart) / (double)freq.QuadPart;
+	if (fSeconds > 0.0)
+	{
+		printf("Benchmark %s: %.1f M instructions/s, %.1f MHz (x%.0f Apple II)\n", CpuName(cpu),
+			nInstructions / fSeconds / 1e6, uCycles / fSeconds / 1e6, uCycles / fSeconds / 1020484.0);
+	}
+
+	memset(mem, 0, 0x10000);
+	reset();
+}
+
+//-------------------------------------
+// Functional test ROMs, eg. Klaus Dormann's 6502_functional_test.bin and 65C02_extended_opcodes_test.bin (not included)
+// The binary is a 64K image. It's run from the start address until it traps (branches or jumps to itself),
+// and passes if that's at the success address (which depends on how the test was assembled).
+
+static BYTE __stdcall FunctionalTestIO(WORD programcounter, WORD address, BYTE write, BYTE value, ULONG nCycles)
+{
+	if (write)
+		mem[address] = value;
+	return mem[address];
+}
+
+int CpuFunctional_test(const eCpuType cpu, const _TCHAR* pszFilename, const WORD successAddr, const WORD startAddr)
+{
+	FILE* hFile = _tfopen(pszFilename, _T("rb"));
+	if (!hFile)
+	{
+		printf("Functional test %s: can't open file\n", CpuName(cpu));
+		return 1;
+	}
+
+	memset(mem, 0, 0x10000);
+	fread(mem, 1, 0x10000, hFile);
+	fclose(hFile);
+
+	iofunction aIORead[256], aIOWrite[256];
+	memcpy(aIORead, IORead, sizeof(IORead));
+	memcpy(aIOWrite, IOWrite, sizeof(IOWrite));
+	for (UINT i=0; i<256; i++)
+	{
+		IORead[i] = FunctionalTestIO;
+		IOWrite[i] = FunctionalTestIO;
+	}
+
+	reset();
+	regs.pc = startAddr;
+
+	const unsigned __int64 kMaxInstructions = 0x100000000ULL;
+	unsigned __int64 nInstructions = 0;
+	unsigned __int64 nCycles = 0;
+
+	LARGE_INTEGER freq, start, end;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&start);
+
+	WORD pc;
+	do
+	{
+		pc = regs.pc;
+		nCycles += TestCpu(cpu, 0);
+		nInstructions++;
+	}
+	while (regs.pc != pc && nInstructions < kMaxInstructions);
+
+	QueryPerformanceCounter(&end);
+	const double fSeconds = (double)(end.QuadPart - start.QuadPart) / (double)freq.QuadPart;
+
+	const bool bPassed = (regs.pc == pc) && (pc == successAddr);
+	printf("Functional test %s: trapped at $%04X after %llu instructions, %llu cycles (%.1f M instructions/s): %s\n",
+		CpuName(cpu), regs.pc, (unsigned long long)nInstructions, (unsigned long long)nCycles,
+		fSeconds > 0.0 ? nInstructions / fSeconds / 1e6 : 0.0, bPassed ? "passed" : "FAILED");
+
+	memcpy(IORead, aIORead, sizeof(IORead));
+	memcpy(IOWrite, aIOWrite, sizeof(IOWrite));
+	memset(mem, 0, 0x10000);
+	reset();
+
+	return bPassed ? 0 : 1;
+}
+
 //-------------------------------------
 
 int _tmain(int argc, _TCHAR* argv[])
@@ -1352,5 +2288,51 @@ int _tmain(int argc, _TCHAR* argv[])
 	res = SyncEvents_test();
 	if (res) return res;
 
+	// TestCPU6502 [-seed <n>] [-fuzz <iterations>] [-benchmark <Mcycles>] [-functional-test <6502|65C02> <file> <success-addr> [<start-addr>]]
+	UINT uFuzzIterations = 1000;
+	UINT uBenchmarkMegaCycles = 0;		// Only on request, as it takes a while & its timings vary from run to run
+	eCpuType functionalTestCpu = CPU_UNKNOWN;
+	const _TCHAR* pszFunctionalTestFile = NULL;
+	WORD functionalTestSuccess = 0;
+	WORD functionalTestStart = 0x0400;
+
+	for (int i=1; i<argc; i++)
+	{
+		if (_tcscmp(argv[i], _T("-seed")) == 0 && i+1 < argc)
+			g_uFuzzSeed = _tcstoul(argv[++i], NULL, 0) | 1;
+		else if (_tcscmp(argv[i], _T("-fuzz")) == 0 && i+1 < argc)
+			uFuzzIterations = _tcstoul(argv[++i], NULL, 0);
+		else if (_tcscmp(argv[i], _T("-benchmark")) == 0 && i+1 < argc)
+			uBenchmarkMegaCycles = _tcstoul(argv[++i], NULL, 0);
+		else if (_tcscmp(argv[i], _T("-functional-test")) == 0 && i+3 < argc)
+		{
+			functionalTestCpu = (_tcscmp(argv[++i], _T("65C02")) == 0) ? CPU_65C02 : CPU_6502;
+			pszFunctionalTestFile = argv[++i];
+			functionalTestSuccess = (WORD)_tcstoul(argv[++i], NULL, 16);
+			if (i+1 < argc && argv[i+1][0] != '-')
+				functionalTestStart = (WORD)_tcstoul(argv[++i], NULL, 16);
+		}
+	}
+
+	res = Decimal_test(CPU_6502);
+	res |= Decimal_test(CPU_65C02);
+	if (res) return res;
+
+	res = CpuFuzz_test(CPU_6502, uFuzzIterations);
+	res |= CpuFuzz_test(CPU_65C02, uFuzzIterations);
+	if (res) return res;
+
+	if (uBenchmarkMegaCycles)
+	{
+		CpuBenchmark(CPU_6502, uBenchmarkMegaCycles);
+		CpuBenchmark(CPU_65C02, uBenchmarkMegaCycles);
+	}
+
+	if (pszFunctionalTestFile)
+	{
+		res = CpuFunctional_test(functionalTestCpu, pszFunctionalTestFile, functionalTestSuccess, functionalTestStart);
+		if (res) return res;
+	}
+
 	return 0;
 }